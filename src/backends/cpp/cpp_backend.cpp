@@ -9,6 +9,8 @@
 #include <utility>
 #include <vector>
 
+#include "sem/type_arena.h"
+
 namespace istudio::backends::cpp {
 namespace {
 
@@ -81,9 +83,12 @@ class CppEmitter {
   }
 
  private:
-  void collect_includes_for_type(const ir::IRType& type) {
+  void collect_includes_for_type(const ir::IRType& type) { collect_includes_for_type(type.id); }
+
+  void collect_includes_for_type(sem::TypeId type) {
     using istudio::ir::IRTypeKind;
-    switch (type.kind) {
+    const sem::TypeArena& types = module_.types();
+    switch (types.form(type)) {
       case IRTypeKind::I32:
       case IRTypeKind::I64:
         header_includes_.insert("<cstdint>");
@@ -91,6 +96,9 @@ class CppEmitter {
       case IRTypeKind::String:
         header_includes_.insert("<string>");
         break;
+      case IRTypeKind::Function:
+        header_includes_.insert("<functional>");
+        break;
       case IRTypeKind::Struct:
       case IRTypeKind::Generic:
         break;
@@ -98,10 +106,11 @@ class CppEmitter {
       case IRTypeKind::F64:
       case IRTypeKind::Bool:
       case IRTypeKind::Void:
+      case IRTypeKind::Unknown:
         break;
     }
-    for (const auto& arg : type.type_arguments) {
-      collect_includes_for_type(arg);
+    for (const sem::TypeId argument : types.arguments(type)) {
+      collect_includes_for_type(argument);
     }
   }
 
@@ -119,11 +128,15 @@ class CppEmitter {
     }
   }
 
-  std::string type_to_string(const ir::IRType& type) {
+  std::string type_to_string(const ir::IRType& type) { return type_to_string(type.id); }
+
+  std::string type_to_string(sem::TypeId type) {
     collect_includes_for_type(type);
     using istudio::ir::IRTypeKind;
-    switch (type.kind) {
+    const sem::TypeArena& types = module_.types();
+    switch (types.form(type)) {
       case IRTypeKind::Void:
+      case IRTypeKind::Unknown:
         return "void";
       case IRTypeKind::I32:
         return "std::int32_t";
@@ -138,17 +151,31 @@ class CppEmitter {
       case IRTypeKind::String:
         return "std::string";
       case IRTypeKind::Generic:
-        return type.name;
+        return std::string(types.name(type));
+      case IRTypeKind::Function: {
+        const auto arguments = types.arguments(type);
+        std::ostringstream oss;
+        oss << "std::function<" << type_to_string(arguments.front()) << '(';
+        for (std::size_t i = 1; i < arguments.size(); ++i) {
+          if (i != 1) {
+            oss << ", ";
+          }
+          oss << type_to_string(arguments[i]);
+        }
+        oss << ")>";
+        return oss.str();
+      }
       case IRTypeKind::Struct: {
+        const auto arguments = types.arguments(type);
         std::ostringstream oss;
-        oss << type.name;
-        if (!type.type_arguments.empty()) {
+        oss << types.name(type);
+        if (!arguments.empty()) {
           oss << '<';
-          for (std::size_t i = 0; i < type.type_arguments.size(); ++i) {
+          for (std::size_t i = 0; i < arguments.size(); ++i) {
             if (i != 0) {
               oss << ", ";
             }
-            oss << type_to_string(type.type_arguments[i]);
+            oss << type_to_string(arguments[i]);
           }
           oss << '>';
         }
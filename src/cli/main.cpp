@@ -1,7 +1,14 @@
+#include <exception>
 #include <iostream>
+#include <memory>
 #include <string_view>
 
+#include "front/ast_dump.h"
+#include "front/lexer.h"
+#include "front/parser.h"
 #include "lsp/server.h"
+#include "support/diagnostics.h"
+#include "support/source_manager.h"
 #include "support/version.h"
 
 namespace {
@@ -12,9 +19,70 @@ Usage:
   istudio --version            Print the compiler version
   istudio --help               Print this message
   istudio lsp                  Start the language server on stdio
+  istudio parse [--json] [--memory-stats] <file>
+                               Print the AST of a file, or the memory it takes
   istudio <command> [args...]  Placeholder for future commands
 )";
 
+// Syntax errors go to stderr and fail the command; the AST is printed regardless.
+int parse_command(int argc, char* argv[]) {
+  bool json = false;
+  bool memory_stats = false;
+  const char* path = nullptr;
+  for (int i = 2; i < argc; ++i) {
+    const std::string_view arg{argv[i]};
+    if (arg == "--json") {
+      json = true;
+    } else if (arg == "--memory-stats") {
+      memory_stats = true;
+    } else if (path == nullptr && !arg.starts_with("--")) {
+      path = argv[i];
+    } else {
+      std::cerr << "Unexpected argument '" << arg << "'\n\n" << usage;
+      return 1;
+    }
+  }
+  if (path == nullptr) {
+    std::cerr << "Missing file to parse\n\n" << usage;
+    return 1;
+  }
+
+  try {
+    istudio::support::SourceManager sources{};
+    const auto file = sources.load_file(path);
+    const auto interner = std::make_shared<istudio::support::StringInterner>();
+    istudio::front::LexerConfig config{};
+    config.capture_comments = false;
+    config.interner = interner.get();
+    istudio::front::Lexer lexer{sources.text(file), config};
+    istudio::front::AstContext context{interner};
+    istudio::support::DiagnosticReporter reporter{file};
+    const auto root = istudio::front::parse_module(lexer, context, reporter);
+
+    for (const auto& diagnostic : reporter.diagnostics()) {
+      std::cerr << istudio::support::format_diagnostic(diagnostic, sources);
+    }
+    if (memory_stats) {
+      const auto stats = context.memory_stats();
+      std::cout << (json ? istudio::front::dump_memory_stats_json(stats)
+                         : istudio::front::dump_memory_stats_text(stats));
+    } else {
+      istudio::front::AstDumpOptions options{};
+      options.sources = &sources;
+      options.file = file;
+      if (json) {
+        istudio::front::write_ast_json(context, root, std::cout, options);
+      } else {
+        istudio::front::write_ast_text(context, root, std::cout, options);
+      }
+    }
+    return reporter.diagnostics().empty() ? 0 : 1;
+  } catch (const std::exception& error) {
+    std::cerr << "error: " << error.what() << '\n';
+    return 1;
+  }
+}
+
 }  // namespace
 
 int main(int argc, char* argv[]) {
@@ -40,6 +108,10 @@ int main(int argc, char* argv[]) {
     return server.run(std::cin, std::cout);
   }
 
+  if (command == "parse") {
+    return parse_command(argc, argv);
+  }
+
   std::cout << "Unrecognized command '" << command << "'\n\n" << usage;
   return 1;
 }
@@ -1,28 +1,254 @@
 #include "front/ast.h"
 
+#include <algorithm>
+#include <bit>
+#include <cstring>
 #include <stdexcept>
 #include <utility>
 
+#include "front/ast_walk.h"
+
 namespace istudio::front {
+namespace {
+
+constexpr std::size_t kValueChunkSize = 16 * 1024;
+// 64 KiB of children per chunk: a mid-sized module fits in one.
+constexpr std::size_t kChildChunkSize = 8 * 1024;
+
+constexpr std::uint64_t kHashMultiplier = 0x9E3779B97F4A7C15;
+
+std::uint64_t mix(std::uint64_t hash, std::uint64_t value) noexcept {
+  return (std::rotl(hash, 23) ^ value) * kHashMultiplier;
+}
+
+// The MurmurHash3 finalizer, so every input bit reaches every bit of a subtree's hash.
+std::uint64_t finish(std::uint64_t hash) noexcept {
+  hash ^= hash >> 33;
+  hash *= 0xFF51AFD7ED558CCD;
+  hash ^= hash >> 33;
+  hash *= 0xC4CEB9FE1A85EC53;
+  return hash ^ (hash >> 33);
+}
+
+// Eight bytes at a time, assembled little-endian whatever the platform, so hashes are portable.
+std::uint64_t hash_text(std::string_view text) noexcept {
+  std::uint64_t hash = text.size();
+  std::uint64_t word = 0;
+  std::size_t filled = 0;
+  for (const char ch : text) {
+    word |= std::uint64_t{static_cast<unsigned char>(ch)} << (8 * filled);
+    if (++filled == 8) {
+      hash = mix(hash, word);
+      word = 0;
+      filled = 0;
+    }
+  }
+  return mix(hash, word);
+}
+
+}  // namespace
+
+AstNode& AstContext::create_node(AstKind kind, support::Span span, std::string_view value, support::Symbol symbol) {
+  const NodeId id = first_id_ + nodes_.size();
+  if (symbol != support::kNoSymbol && interner_ != nullptr) {
+    value = interner_->text(symbol);
+  } else {
+    symbol = support::kNoSymbol;
+    value = store_value(value);
+  }
+  nodes_.push_back(AstNode{.id = id, .kind = kind, .span = span, .symbol = symbol, .value = value, .children = {}});
+  return nodes_.back();
+}
 
-AstNode& AstContext::create_node(AstKind kind, support::Span span, std::string value) {
-  const NodeId id = nodes_.size();
-  nodes_.push_back(AstNode{.id = id, .kind = kind, .span = span, .value = std::move(value), .children = {}});
+AstNode& AstContext::adopt_node(AstKind kind, support::Span span, std::string_view value, support::Symbol symbol,
+                                std::span<const NodeId> children) {
+  const NodeId id = first_id_ + nodes_.size();
+  nodes_.push_back(AstNode{.id = id, .kind = kind, .span = span, .symbol = symbol, .value = value, .children = {}});
+  check_post_order(nodes_.back(), children);
+  nodes_.back().children = children;
   return nodes_.back();
 }
 
+void AstContext::set_children(NodeId parent, std::span<const NodeId> children) {
+  AstNode& node = this->node(parent);
+  check_post_order(node, children);
+  // The hashes of the node's ancestors change too, and nodes do not know their parents.
+  if (parent - first_id_ < hashes_.size()) {
+    hashes_.clear();
+  }
+  node.children = store_children(children);
+}
+
+void AstContext::reserve_for_tokens(std::size_t tokens) {
+  // Parsed modules hold about 0.78 nodes per token whatever their size (measured on the benchmark corpus from
+  // 64 KiB up); round that up to 0.8. Every node but the root is some node's child.
+  const std::size_t nodes = tokens - tokens / 5 + 1;
+  reserve(nodes);
+  if (child_capacity_ - child_used_ < nodes) {
+    child_capacity_ = std::max(kChildChunkSize, nodes);
+    child_chunks_.push_back(std::make_unique_for_overwrite<NodeId[]>(child_capacity_));
+    child_reserved_ += child_capacity_;
+    child_used_ = 0;
+  }
+}
+
+AstMemoryStats AstContext::memory_stats() const noexcept {
+  return AstMemoryStats{.node_count = nodes_.size(),
+                        .node_bytes = nodes_.size() * sizeof(AstNode),
+                        .node_reserved_bytes = nodes_.capacity() * sizeof(AstNode),
+                        .child_bytes = child_count_ * sizeof(NodeId),
+                        .child_reserved_bytes = (child_reserved_ + pending_children_.capacity()) * sizeof(NodeId),
+                        .value_bytes = value_bytes_,
+                        .value_reserved_bytes = value_reserved_};
+}
+
+void AstContext::compute_structural_hashes() {
+  hashes_.assign(nodes_.size(), 0);
+  const auto hash_node = [&](const AstNode& node) {
+    std::uint64_t hash = mix(mix(static_cast<std::uint64_t>(node.kind), hash_text(node.value)), node.children.size());
+    for (const NodeId child : node.children) {
+      hash = mix(hash, hashes_[child - first_id_]);
+    }
+    hashes_[node.id - first_id_] = finish(hash);
+  };
+  if (post_ordered_) {
+    for (const AstNode& node : nodes_) {
+      hash_node(node);
+    }
+    return;
+  }
+  // Children may follow their parents: hash each tree children first, from its root.
+  std::vector<bool> is_child(nodes_.size(), false);
+  for (const AstNode& node : nodes_) {
+    for (const NodeId child : node.children) {
+      is_child[child - first_id_] = true;
+    }
+  }
+  for (const AstNode& node : nodes_) {
+    if (!is_child[node.id - first_id_]) {
+      walk_ast(*this, node.id, [](const AstNode&) { return WalkAction::visit_children(); }, hash_node);
+    }
+  }
+}
+
+std::uint64_t AstContext::structural_hash(NodeId id) const {
+  if (id - first_id_ >= hashes_.size()) {
+    throw std::logic_error("AstNode has no current structural hash; call compute_structural_hashes() first");
+  }
+  return hashes_[id - first_id_];
+}
+
+bool structurally_equal(const AstContext& left, NodeId a, const AstContext& right, NodeId b) {
+  std::vector<std::pair<NodeId, NodeId>> pending{{a, b}};
+  while (!pending.empty()) {
+    const auto [left_id, right_id] = pending.back();
+    pending.pop_back();
+    const AstNode& left_node = left.node(left_id);
+    const AstNode& right_node = right.node(right_id);
+    if (left_node.kind != right_node.kind || left_node.value != right_node.value ||
+        left_node.children.size() != right_node.children.size()) {
+      return false;
+    }
+    for (std::size_t i = 0; i < left_node.children.size(); ++i) {
+      pending.emplace_back(left_node.children[i], right_node.children[i]);
+    }
+  }
+  return true;
+}
+
+NodeId AstContext::first_descendant(NodeId id) const {
+  const AstNode* current = &node(id);
+  while (!current->children.empty()) {
+    id = current->children.front();
+    current = &node(id);
+  }
+  return id;
+}
+
+// Children are checked from the last: each must end right before the next one's subtree begins, and the last
+// right before the parent, so every id looked at is below the parent and names an existing node. Only later
+// children are descended, never the first: a left-leaning chain costs O(1) per node, and in all the descents
+// walk each node at most once.
+void AstContext::check_post_order(const AstNode& parent, std::span<const NodeId> children) {
+  if (!post_ordered_) {
+    return;
+  }
+  if (!parent.children.empty()) {
+    post_ordered_ = false;
+    return;
+  }
+  NodeId next = parent.id;
+  for (std::size_t i = children.size(); i-- > 0;) {
+    if (children[i] + 1 != next) {
+      post_ordered_ = false;
+      return;
+    }
+    if (i > 0) {
+      next = first_descendant(children[i]);
+    }
+  }
+}
+
+void AstContext::set_children(NodeId parent, std::initializer_list<NodeId> children) {
+  set_children(parent, std::span<const NodeId>{children.begin(), children.size()});
+}
+
+void AstContext::finish_children(NodeId parent, ChildList list) {
+  if (list.start > pending_children_.size()) {
+    throw std::logic_error("child lists must be finished in reverse order of beginning");
+  }
+  const std::span<const NodeId> pending{pending_children_};
+  set_children(parent, pending.subspan(list.start));
+  pending_children_.resize(list.start);
+}
+
+// Ids of other shards wrap around to indices past the end.
 const AstNode& AstContext::node(NodeId id) const {
-  if (id >= nodes_.size()) {
+  if (id - first_id_ >= nodes_.size()) {
     throw std::out_of_range("invalid AstNode id");
   }
-  return nodes_[id];
+  return nodes_[id - first_id_];
 }
 
 AstNode& AstContext::node(NodeId id) {
-  if (id >= nodes_.size()) {
+  if (id - first_id_ >= nodes_.size()) {
     throw std::out_of_range("invalid AstNode id");
   }
-  return nodes_[id];
+  return nodes_[id - first_id_];
+}
+
+std::string_view AstContext::store_value(std::string_view value) {
+  if (value.empty()) {
+    return {};
+  }
+  if (chunk_capacity_ - chunk_used_ < value.size()) {
+    chunk_capacity_ = std::max(kValueChunkSize, value.size());
+    value_chunks_.push_back(std::make_unique_for_overwrite<char[]>(chunk_capacity_));
+    value_reserved_ += chunk_capacity_;
+    chunk_used_ = 0;
+  }
+  value_bytes_ += value.size();
+  char* slot = value_chunks_.back().get() + chunk_used_;
+  std::memcpy(slot, value.data(), value.size());
+  chunk_used_ += value.size();
+  return {slot, value.size()};
+}
+
+std::span<const NodeId> AstContext::store_children(std::span<const NodeId> children) {
+  if (children.empty()) {
+    return {};
+  }
+  if (child_capacity_ - child_used_ < children.size()) {
+    child_capacity_ = std::max(kChildChunkSize, children.size());
+    child_chunks_.push_back(std::make_unique_for_overwrite<NodeId[]>(child_capacity_));
+    child_reserved_ += child_capacity_;
+    child_used_ = 0;
+  }
+  child_count_ += children.size();
+  NodeId* slot = child_chunks_.back().get() + child_used_;
+  std::copy(children.begin(), children.end(), slot);
+  child_used_ += children.size();
+  return {slot, children.size()};
 }
 
 std::string_view to_string(AstKind kind) noexcept {
@@ -61,6 +287,8 @@ std::string_view to_string(AstKind kind) noexcept {
       return "ReturnStmt";
     case AstKind::ExpressionStmt:
       return "ExpressionStmt";
+    case AstKind::Error:
+      return "Error";
   }
 
   return "Unknown";
@@ -1,16 +1,30 @@
 #pragma once
 
 #include <cstddef>
-#include <string>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <span>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "support/span.h"
+#include "support/string_interner.h"
 
 namespace istudio::front {
 
 using NodeId = std::size_t;
 
+// A node id carries its context's shard number above kShardShift, so the ids of every shard of an AstForest
+// are distinct. Contexts default to shard 0, where ids are plain indices.
+inline constexpr unsigned kShardShift = 40;
+
+[[nodiscard]] constexpr std::uint32_t shard_of(NodeId id) noexcept {
+  return static_cast<std::uint32_t>(id >> kShardShift);
+}
+
+// AST images (ast_binary.h) store kinds by number: append new kinds, or bump kAstImageVersion.
 enum class AstKind {
   Unknown,
   Module,
@@ -29,29 +43,131 @@ enum class AstKind {
   LetStmt,
   ReturnStmt,
   ExpressionStmt,
+  // Stands in for input that failed to parse; a broken statement is kept as its only child.
+  Error,
 };
 
 struct AstNode {
   NodeId id{0};
   AstKind kind{AstKind::Unknown};
   support::Span span{};
-  std::string value{};
-  std::vector<NodeId> children{};
+  // Interned `value` for names, when the context has an interner. Sits in what would be padding.
+  support::Symbol symbol{support::kNoSymbol};
+  // Points into storage owned by the AstContext (or its interner), so it stays valid for the context's lifetime.
+  std::string_view value{};
+  // A contiguous range of the context's shared child buffer; set through AstContext, never resized in place.
+  std::span<const NodeId> children{};
+};
+
+// Bytes an AstContext holds, for budgeting memory per compile job: `*_bytes` is what its nodes use, `*_reserved_bytes`
+// what is allocated for them. Names viewing a (possibly shared) interner and storage handed to retain() are not
+// counted.
+struct AstMemoryStats {
+  std::size_t node_count{0};
+  std::size_t node_bytes{0};
+  std::size_t node_reserved_bytes{0};
+  std::size_t child_bytes{0};
+  // Includes the scratch space of child lists under construction.
+  std::size_t child_reserved_bytes{0};
+  std::size_t value_bytes{0};
+  std::size_t value_reserved_bytes{0};
+
+  [[nodiscard]] std::size_t used_bytes() const noexcept { return node_bytes + child_bytes + value_bytes; }
+  [[nodiscard]] std::size_t reserved_bytes() const noexcept {
+    return node_reserved_bytes + child_reserved_bytes + value_reserved_bytes;
+  }
+};
+
+// Handle for a child list under construction; see AstContext::begin_children.
+struct ChildList {
+  std::size_t start{0};
 };
 
 class AstContext {
  public:
   AstContext() = default;
+  // Names are interned in `interner`, which can be shared with the lexer and later phases.
+  explicit AstContext(std::shared_ptr<support::StringInterner> interner) : interner_(std::move(interner)) {}
+  AstContext(std::shared_ptr<support::StringInterner> interner, std::uint32_t shard)
+      : interner_(std::move(interner)), first_id_(NodeId{shard} << kShardShift) {}
+
+  // With an interner, a node given a `symbol` views the interned text instead of copying `value`.
+  [[nodiscard]] AstNode& create_node(AstKind kind, support::Span span, std::string_view value = {},
+                                     support::Symbol symbol = support::kNoSymbol);
+  // Gives `parent` exactly these children, replacing any it had.
+  void set_children(NodeId parent, std::span<const NodeId> children);
+  void set_children(NodeId parent, std::initializer_list<NodeId> children);
+  // Builds a child list one child at a time, for nodes whose arity is only known once parsed (modules,
+  // blocks, calls). Lists may nest, but must be finished in reverse order of beginning; add_child appends to
+  // the innermost unfinished list.
+  [[nodiscard]] ChildList begin_children() const noexcept { return ChildList{pending_children_.size()}; }
+  void add_child(NodeId child) { pending_children_.push_back(child); }
+  void finish_children(NodeId parent, ChildList list);
+  // Appends a node whose value and children view storage the context does not own, e.g. a loaded AstImage;
+  // that storage must be handed to retain(). Nothing is copied or interned.
+  [[nodiscard]] AstNode& adopt_node(AstKind kind, support::Span span, std::string_view value, support::Symbol symbol,
+                                    std::span<const NodeId> children);
+  // Keeps `storage` alive for the context's lifetime.
+  void retain(std::shared_ptr<const void> storage) { retained_.push_back(std::move(storage)); }
+  // Makes room for `nodes` more nodes.
+  void reserve(std::size_t nodes) { nodes_.reserve(nodes_.size() + nodes); }
+  // Makes room for the nodes and child lists of a module parsed from `tokens` tokens, so that large modules are
+  // not built through repeated reallocation.
+  void reserve_for_tokens(std::size_t tokens);
 
-  [[nodiscard]] AstNode& create_node(AstKind kind, support::Span span, std::string value = {});
   [[nodiscard]] const AstNode& node(NodeId id) const;
   [[nodiscard]] AstNode& node(NodeId id);
   [[nodiscard]] std::size_t size() const noexcept { return nodes_.size(); }
+  [[nodiscard]] std::uint32_t shard() const noexcept { return shard_of(first_id_); }
+  // True while every node was created after all of its descendants with no other node in between, as the
+  // parser creates them: the subtree of any node `n` is then exactly the ids [first_descendant(n), n], in
+  // post-order. Replacing a child list (as reparsing does) or building nodes in any other order clears it for good.
+  [[nodiscard]] bool is_post_ordered() const noexcept { return post_ordered_; }
+  // The first node of `id`'s subtree in post-order: `id` itself, or its first child's first descendant.
+  [[nodiscard]] NodeId first_descendant(NodeId id) const;
+  [[nodiscard]] const std::shared_ptr<support::StringInterner>& interner() const noexcept { return interner_; }
+  [[nodiscard]] AstMemoryStats memory_stats() const noexcept;
+
+  // Hashes every subtree in one bottom-up sweep, so later phases can memoize results per distinct subtree and
+  // caches can key on them. A hash covers the kinds, values and shape of a subtree, not its ids, spans or
+  // symbols: equal subtrees hash equally in every context, shard, process and platform. Hashes stay current until
+  // an already hashed node gets a new child list; nodes created after the sweep have none.
+  void compute_structural_hashes();
+  // Throws std::logic_error if `id` has no current hash.
+  [[nodiscard]] std::uint64_t structural_hash(NodeId id) const;
 
  private:
+  [[nodiscard]] std::string_view store_value(std::string_view value);
+  [[nodiscard]] std::span<const NodeId> store_children(std::span<const NodeId> children);
+  // Keeps post_ordered_ up to date as `parent` gets `children`.
+  void check_post_order(const AstNode& parent, std::span<const NodeId> children);
+
+  std::shared_ptr<support::StringInterner> interner_{};
+  NodeId first_id_{0};
+  bool post_ordered_{true};
   std::vector<AstNode> nodes_{};
+  std::vector<std::unique_ptr<char[]>> value_chunks_{};
+  std::size_t chunk_used_{0};
+  std::size_t chunk_capacity_{0};
+  // Totals over all chunks, for memory_stats().
+  std::size_t value_bytes_{0};
+  std::size_t value_reserved_{0};
+  // Children of all nodes, packed back to back in chunks that never move, so node spans stay valid.
+  std::vector<std::unique_ptr<NodeId[]>> child_chunks_{};
+  std::size_t child_used_{0};
+  std::size_t child_capacity_{0};
+  std::size_t child_count_{0};
+  std::size_t child_reserved_{0};
+  std::vector<NodeId> pending_children_{};
+  std::vector<std::shared_ptr<const void>> retained_{};
+  // Indexed like nodes_; empty when out of date.
+  std::vector<std::uint64_t> hashes_{};
 };
 
+// Whether the subtrees at `a` and `b` have the same kinds, values and shape; the check behind a structural hash
+// match. Ids, spans and symbols may differ.
+[[nodiscard]] bool structurally_equal(const AstContext& left, NodeId a, const AstContext& right, NodeId b);
+
 [[nodiscard]] std::string_view to_string(AstKind kind) noexcept;
 
 }  // namespace istudio::front
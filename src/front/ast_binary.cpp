@@ -0,0 +1,328 @@
+#include "front/ast_binary.h"
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace istudio::front {
+namespace {
+
+constexpr std::array<char, 8> kMagic = {'I', 'S', 'T', 'U', 'D', 'A', 'S', 'T'};
+// Written in native order; an image from a machine of the other byte order reads back swapped and is rejected.
+constexpr std::uint32_t kByteOrderMark = 0x01020304;
+
+struct Header {
+  std::array<char, 8> magic{};
+  std::uint32_t version{0};
+  std::uint32_t byte_order{0};
+  std::uint64_t node_count{0};
+  std::uint64_t child_count{0};
+  std::uint64_t name_count{0};
+  std::uint64_t text_size{0};
+  std::uint64_t root{0};
+};
+static_assert(sizeof(Header) == 56);
+
+// A node's children follow its predecessors' in the child lists, so only their count is stored.
+struct NodeRecord {
+  std::uint32_t span_start{0};
+  std::uint32_t span_end{0};
+  // An index into the name table when kNamed is set, otherwise an offset into the text section.
+  std::uint32_t value{0};
+  // Zero for names, whose length is in the name table.
+  std::uint32_t value_length{0};
+  std::uint16_t kind{0};
+  std::uint16_t flags{0};
+  std::uint32_t child_count{0};
+};
+static_assert(sizeof(NodeRecord) == 24);
+
+constexpr std::uint16_t kNamed = 1;
+
+struct NameRecord {
+  std::uint32_t offset{0};
+  std::uint32_t length{0};
+};
+static_assert(sizeof(NameRecord) == 8);
+
+template <typename T>
+void append(std::string& out, const T& value) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T read(std::string_view bytes, std::size_t index) {
+  T value{};
+  std::memcpy(&value, bytes.data() + index * sizeof(T), sizeof(T));
+  return value;
+}
+
+[[noreturn]] void invalid(const std::string& reason) {
+  throw std::runtime_error("invalid AST image: " + reason);
+}
+
+std::uint32_t text_offset(const std::string& text) {
+  if (text.size() > std::numeric_limits<std::uint32_t>::max()) {
+    throw std::length_error("AST image text exceeds the 4 GiB limit");
+  }
+  return static_cast<std::uint32_t>(text.size());
+}
+
+// Whether following child edges from some node leads back to it. Only needed for images that are not in
+// post-order, which an incremental reparse produces by giving a block children newer than itself.
+bool has_cycle(std::string_view records, std::string_view children, std::size_t node_count) {
+  std::vector<std::uint32_t> first_child(node_count);
+  std::uint32_t next = 0;
+  for (std::size_t i = 0; i < node_count; ++i) {
+    first_child[i] = next;
+    next += read<NodeRecord>(records, i).child_count;
+  }
+  // 0: not visited, 1: on the current path, 2: done.
+  std::vector<std::uint8_t> state(node_count, 0);
+  struct Frame {
+    std::uint32_t node{0};
+    std::uint32_t next_child{0};
+  };
+  std::vector<Frame> stack{};
+  for (std::size_t start = 0; start < node_count; ++start) {
+    if (state[start] != 0) {
+      continue;
+    }
+    state[start] = 1;
+    stack.push_back(Frame{.node = static_cast<std::uint32_t>(start), .next_child = 0});
+    while (!stack.empty()) {
+      Frame& top = stack.back();
+      if (top.next_child == read<NodeRecord>(records, top.node).child_count) {
+        state[top.node] = 2;
+        stack.pop_back();
+        continue;
+      }
+      const auto child = read<std::uint32_t>(children, first_child[top.node] + top.next_child++);
+      if (state[child] == 1) {
+        return true;
+      }
+      if (state[child] == 0) {
+        state[child] = 1;
+        stack.push_back(Frame{.node = child, .next_child = 0});
+      }
+    }
+  }
+  return false;
+}
+
+// Cuts `count` elements of `size` bytes off the front of `rest`.
+std::string_view take(std::string_view& rest, std::uint64_t count, std::size_t size, const char* section) {
+  if (count > rest.size() / size) {
+    invalid(std::string("truncated ") + section);
+  }
+  const std::string_view section_bytes = rest.substr(0, static_cast<std::size_t>(count) * size);
+  rest.remove_prefix(section_bytes.size());
+  return section_bytes;
+}
+
+}  // namespace
+
+void write_ast_binary(const AstContext& context, NodeId root, std::ostream& out) {
+  if (context.size() > std::numeric_limits<std::uint32_t>::max()) {
+    throw std::length_error("AST image has too many nodes");
+  }
+  const NodeId first = NodeId{context.shard()} << kShardShift;
+  const auto local = [&](NodeId id) {
+    if (id - first >= context.size()) {
+      throw std::invalid_argument("AST image node refers to a node outside its context");
+    }
+    return static_cast<std::uint32_t>(id - first);
+  };
+
+  std::string children{};
+  std::string records{};
+  std::string names{};
+  std::string text{};
+  std::unordered_map<support::Symbol, std::uint32_t> name_index{};
+  std::size_t child_count = 0;
+  records.reserve(context.size() * sizeof(NodeRecord));
+  for (std::size_t i = 0; i < context.size(); ++i) {
+    const AstNode& node = context.node(first + i);
+    NodeRecord record{.span_start = node.span.start,
+                      .span_end = node.span.end,
+                      .value = 0,
+                      .value_length = 0,
+                      .kind = static_cast<std::uint16_t>(node.kind),
+                      .flags = 0,
+                      .child_count = static_cast<std::uint32_t>(node.children.size())};
+    if (node.symbol != support::kNoSymbol) {
+      const auto next = static_cast<std::uint32_t>(name_index.size());
+      const auto [entry, inserted] = name_index.try_emplace(node.symbol, next);
+      if (inserted) {
+        const auto length = static_cast<std::uint32_t>(node.value.size());
+        append(names, NameRecord{.offset = text_offset(text), .length = length});
+        text += node.value;
+      }
+      record.value = entry->second;
+      record.flags = kNamed;
+    } else {
+      record.value = text_offset(text);
+      record.value_length = static_cast<std::uint32_t>(node.value.size());
+      text += node.value;
+    }
+    for (const NodeId child : node.children) {
+      append(children, local(child));
+    }
+    child_count += node.children.size();
+    if (child_count > std::numeric_limits<std::uint32_t>::max()) {
+      throw std::length_error("AST image has too many children");
+    }
+    append(records, record);
+  }
+
+  Header header{.magic = kMagic,
+                .version = kAstImageVersion,
+                .byte_order = kByteOrderMark,
+                .node_count = context.size(),
+                .child_count = child_count,
+                .name_count = name_index.size(),
+                .text_size = text.size(),
+                .root = local(root)};
+  std::string header_bytes{};
+  append(header_bytes, header);
+  out << header_bytes << children << records << names << text;
+}
+
+void save_ast_binary(const AstContext& context, NodeId root, const std::filesystem::path& path) {
+  std::ofstream out{path, std::ios::binary | std::ios::trunc};
+  if (!out) {
+    throw std::runtime_error("cannot open AST file '" + path.string() + "' for writing");
+  }
+  write_ast_binary(context, root, out);
+  out.flush();
+  if (!out) {
+    throw std::runtime_error("cannot write AST file '" + path.string() + "'");
+  }
+}
+
+AstImage::AstImage(support::FileBytes contents) : contents_(std::move(contents)) {
+  std::string_view rest = contents_.bytes;
+  const Header header = read<Header>(take(rest, 1, sizeof(Header), "header"), 0);
+  if (header.magic != kMagic) {
+    invalid("not an AST image");
+  }
+  if (header.byte_order != kByteOrderMark) {
+    invalid("written on a machine of another byte order");
+  }
+  if (header.version != kAstImageVersion) {
+    invalid("version " + std::to_string(header.version) + ", expected " + std::to_string(kAstImageVersion));
+  }
+
+  children_ = take(rest, header.child_count, sizeof(std::uint32_t), "child lists");
+  records_ = take(rest, header.node_count, sizeof(NodeRecord), "node records");
+  names_ = take(rest, header.name_count, sizeof(NameRecord), "name table");
+  text_ = take(rest, header.text_size, 1, "text");
+  if (!rest.empty()) {
+    invalid("trailing bytes");
+  }
+  node_count_ = static_cast<std::size_t>(header.node_count);
+  if (node_count_ == 0 || header.root >= node_count_) {
+    invalid("root out of range");
+  }
+  root_ = static_cast<NodeId>(header.root);
+
+  // Everything is checked here, so loading cannot fail halfway through filling a context, and walking the loaded
+  // tree cannot loop.
+  const auto in_text = [&](std::uint32_t offset, std::uint32_t length) {
+    return offset <= text_.size() && length <= text_.size() - offset;
+  };
+  for (std::size_t i = 0; i < header.name_count; ++i) {
+    const auto name = read<NameRecord>(names_, i);
+    if (!in_text(name.offset, name.length)) {
+      invalid("name " + std::to_string(i) + " out of range");
+    }
+  }
+  const std::uint64_t child_count = header.child_count;
+  std::uint64_t first_child = 0;
+  bool post_order = true;
+  for (std::size_t i = 0; i < node_count_; ++i) {
+    const auto record = read<NodeRecord>(records_, i);
+    const bool named = (record.flags & kNamed) != 0;
+    if (record.kind > static_cast<std::uint16_t>(AstKind::Error) || (record.flags & ~kNamed) != 0 ||
+        (named ? record.value >= header.name_count || record.value_length != 0
+               : !in_text(record.value, record.value_length)) ||
+        record.span_start > record.span_end || record.child_count > child_count - first_child) {
+      invalid("node " + std::to_string(i) + " out of range");
+    }
+    for (std::uint64_t j = first_child; j < first_child + record.child_count; ++j) {
+      const auto child = read<std::uint32_t>(children_, static_cast<std::size_t>(j));
+      if (child >= node_count_) {
+        invalid("child out of range");
+      }
+      post_order = post_order && child < i;
+    }
+    first_child += record.child_count;
+  }
+  if (first_child != child_count) {
+    invalid("child lists do not match the node records");
+  }
+  if (!post_order && has_cycle(records_, children_, node_count_)) {
+    invalid("cyclic child lists");
+  }
+}
+
+AstImage AstImage::open(const std::filesystem::path& path) {
+  return AstImage{support::read_file_bytes(path, "AST file")};
+}
+
+AstImage AstImage::from_bytes(std::string bytes) {
+  auto owned = std::make_shared<const std::string>(std::move(bytes));
+  const std::string_view view{*owned};
+  return AstImage{support::FileBytes{.bytes = view, .storage = std::move(owned)}};
+}
+
+NodeId load_ast_binary(const AstImage& image, AstContext& context) {
+  if (context.size() != 0) {
+    throw std::invalid_argument("AST images load into an empty context");
+  }
+  const NodeId first = NodeId{context.shard()} << kShardShift;
+
+  const std::size_t child_count = image.children_.size() / sizeof(std::uint32_t);
+  auto children = std::make_shared<std::vector<NodeId>>(child_count);
+  for (std::size_t i = 0; i < child_count; ++i) {
+    (*children)[i] = first + read<std::uint32_t>(image.children_, i);
+  }
+
+  const std::size_t name_count = image.names_.size() / sizeof(NameRecord);
+  std::vector<std::string_view> names(name_count);
+  std::vector<support::Symbol> symbols(name_count, support::kNoSymbol);
+  support::StringInterner* interner = context.interner().get();
+  for (std::size_t i = 0; i < name_count; ++i) {
+    const auto name = read<NameRecord>(image.names_, i);
+    names[i] = image.text_.substr(name.offset, name.length);
+    if (interner != nullptr) {
+      symbols[i] = interner->intern(names[i]);
+      names[i] = interner->text(symbols[i]);
+    }
+  }
+
+  context.reserve(image.node_count_);
+  const std::span<const NodeId> lists = *children;
+  std::size_t first_child = 0;
+  for (std::size_t i = 0; i < image.node_count_; ++i) {
+    const auto record = read<NodeRecord>(image.records_, i);
+    const bool named = (record.flags & kNamed) != 0;
+    const std::string_view value = named ? names[record.value] : image.text_.substr(record.value, record.value_length);
+    static_cast<void>(context.adopt_node(static_cast<AstKind>(record.kind),
+                                         support::Span{.start = record.span_start, .end = record.span_end}, value,
+                                         named ? symbols[record.value] : support::kNoSymbol,
+                                         lists.subspan(first_child, record.child_count)));
+    first_child += record.child_count;
+  }
+  context.retain(std::move(children));
+  context.retain(image.contents_.storage);
+  return first + image.root_;
+}
+
+}  // namespace istudio::front
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "front/ast.h"
+#include "support/file_bytes.h"
+
+namespace istudio::front {
+
+// Bumped whenever the layout or the numbering of AstKind changes; images of other versions are rejected.
+inline constexpr std::uint32_t kAstImageVersion = 2;
+
+// Writes every node of `context`, in id order, as an AST image: a header, then the child lists as 32-bit ids,
+// 24-byte node records, interned names and value text, in native byte order. Ids are stored relative to the
+// context's shard, so an image loads into any shard. Throws std::length_error past 2^32 nodes.
+void write_ast_binary(const AstContext& context, NodeId root, std::ostream& out);
+// Throws std::runtime_error if the file cannot be written.
+void save_ast_binary(const AstContext& context, NodeId root, const std::filesystem::path& path);
+
+// A serialized AST, validated once and then read in place: nothing is decoded until load_ast_binary.
+class AstImage {
+ public:
+  // Throws std::runtime_error unless `contents` is a well-formed image of kAstImageVersion: besides ranges, spans
+  // must not be inverted and child lists must not form a cycle.
+  explicit AstImage(support::FileBytes contents);
+
+  // Maps the file where the platform allows it.
+  [[nodiscard]] static AstImage open(const std::filesystem::path& path);
+  [[nodiscard]] static AstImage from_bytes(std::string bytes);
+
+  [[nodiscard]] std::size_t node_count() const noexcept { return node_count_; }
+  // Relative to the shard, like every id in the image.
+  [[nodiscard]] NodeId root() const noexcept { return root_; }
+  [[nodiscard]] std::size_t byte_size() const noexcept { return contents_.bytes.size(); }
+
+ private:
+  friend NodeId load_ast_binary(const AstImage& image, AstContext& context);
+
+  support::FileBytes contents_;
+  std::size_t node_count_{0};
+  NodeId root_{0};
+  std::string_view children_{};
+  std::string_view records_{};
+  std::string_view names_{};
+  std::string_view text_{};
+};
+
+// Fills the empty `context` with the image's nodes, ids rebased onto the context's shard, and returns the root.
+// Values view the image, which the context keeps alive; child lists are widened to NodeIds in one buffer, and
+// only names are interned, once each, when the context has an interner. The result compares equal to the context
+// the image was written from.
+NodeId load_ast_binary(const AstImage& image, AstContext& context);
+
+}  // namespace istudio::front
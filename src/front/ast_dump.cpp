@@ -1,183 +1,308 @@
 #include "front/ast_dump.h"
 
-#include <sstream>
+#include <charconv>
+#include <cstdint>
+#include <ostream>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 #include "front/ast.h"
+#include "front/ast_walk.h"
 
 namespace istudio::front {
 namespace {
 
-std::string escape_text(std::string_view value) {
-  std::string result{};
-  result.reserve(value.size());
-  for (char ch : value) {
-    if (ch == '"') {
-      result += "\\\"";
-    } else if (ch == '\\') {
-      result += "\\\\";
-    } else {
-      result.push_back(ch);
+// Output is handed to the stream once this much has been buffered, at the end of a node.
+constexpr std::size_t kFlushThreshold = 64 * 1024;
+
+// Appends a dump to one reusable buffer, escaping values as they are copied in. With a stream, the buffer is
+// written out whenever it fills, so a dump of any size needs no more than about kFlushThreshold bytes; without
+// one, the whole dump is collected for the string-returning functions.
+class DumpWriter {
+ public:
+  explicit DumpWriter(std::ostream* out) : out_(out) {
+    if (out_ != nullptr) {
+      buffer_.reserve(kFlushThreshold + kFlushThreshold / 4);
     }
   }
-  return result;
-}
 
-std::string escape_control_character(unsigned char ch) {
-  constexpr char hex[] = "0123456789ABCDEF";
-  std::string result = "\\u00";
-  result.push_back(hex[(ch >> 4) & 0x0F]);
-  result.push_back(hex[ch & 0x0F]);
-  return result;
-}
+  void put(char ch) { buffer_.push_back(ch); }
+  void put(std::string_view text) { buffer_.append(text); }
+  void put_spaces(std::size_t count) { buffer_.append(count, ' '); }
 
-std::string json_escape(std::string_view value) {
-  std::string result{};
-  result.reserve(value.size());
-  for (char raw : value) {
-    switch (raw) {
-      case '"':
-        result += "\\\"";
-        continue;
-      case '\\':
-        result += "\\\\";
-        continue;
-      case '\b':
-        result += "\\b";
-        continue;
-      case '\f':
-        result += "\\f";
-        continue;
-      case '\n':
-        result += "\\n";
-        continue;
-      case '\r':
-        result += "\\r";
-        continue;
-      case '\t':
-        result += "\\t";
+  void put_number(std::uint64_t value) {
+    char digits[20];
+    const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    buffer_.append(digits, result.ptr);
+  }
+
+  void put_position(const AstDumpOptions& options, std::size_t offset) {
+    const auto position = options.sources->line_column(options.file, offset);
+    put_number(position.line);
+    put(':');
+    put_number(position.column);
+  }
+
+  // Quotes and backslashes are escaped, everything else is copied as is.
+  void put_escaped_text(std::string_view value) {
+    for (const char ch : value) {
+      if (ch == '"' || ch == '\\') {
+        put('\\');
+      }
+      put(ch);
+    }
+  }
+
+  void put_escaped_json(std::string_view value) {
+    constexpr char hex[] = "0123456789ABCDEF";
+    for (const char raw : value) {
+      switch (raw) {
+        case '"':
+          put("\\\"");
+          continue;
+        case '\\':
+          put("\\\\");
+          continue;
+        case '\b':
+          put("\\b");
+          continue;
+        case '\f':
+          put("\\f");
+          continue;
+        case '\n':
+          put("\\n");
+          continue;
+        case '\r':
+          put("\\r");
+          continue;
+        case '\t':
+          put("\\t");
+          continue;
+        default:
+          break;
+      }
+
+      const unsigned char ch = static_cast<unsigned char>(raw);
+      if (ch < 0x20) {
+        put("\\u00");
+        put(hex[(ch >> 4) & 0x0F]);
+        put(hex[ch & 0x0F]);
         continue;
-      default:
-        break;
+      }
+
+      put(raw);
     }
+  }
 
-    const unsigned char ch = static_cast<unsigned char>(raw);
-    if (ch < 0x20) {
-      result += escape_control_character(ch);
-      continue;
+  // Called between nodes.
+  void flush_if_full() {
+    if (out_ != nullptr && buffer_.size() >= kFlushThreshold) {
+      flush();
     }
+  }
 
-    result.push_back(raw);
+  void flush() {
+    out_->write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    buffer_.clear();
   }
-  return result;
+
+  [[nodiscard]] std::string take() { return std::move(buffer_); }
+
+ private:
+  std::ostream* out_;
+  std::string buffer_{};
+};
+
+bool has_positions(const AstDumpOptions& options) {
+  return options.sources != nullptr && options.file != support::kInvalidFileId;
 }
 
-void dump_text_impl(const AstContext& context, NodeId id, const AstDumpOptions& options, std::string& out,
-                    std::size_t depth) {
-  const auto& node = context.node(id);
-  std::string indent(depth * 2, ' ');
-  out += indent;
-  out += to_string(node.kind);
+void write_text_node(const AstNode& node, const AstDumpOptions& options, DumpWriter& out, std::size_t depth) {
+  out.put_spaces(depth * 2);
+  out.put(to_string(node.kind));
 
   if (options.include_ids) {
-    out.push_back('#');
-    out += std::to_string(node.id);
+    out.put('#');
+    out.put_number(node.id);
   }
 
   if (!node.value.empty()) {
-    out += " value=\"";
-    out += escape_text(node.value);
-    out += '"';
+    out.put(" value=\"");
+    out.put_escaped_text(node.value);
+    out.put('"');
   }
 
   if (options.include_spans) {
-    std::ostringstream span_stream;
-    span_stream << node.span;
-    out += " span=";
-    out += span_stream.str();
+    out.put(" span=[");
+    out.put_number(node.span.start);
+    out.put(", ");
+    out.put_number(node.span.end);
+    out.put(')');
+    if (has_positions(options)) {
+      out.put(" at ");
+      out.put_position(options, node.span.start);
+      out.put('-');
+      out.put_position(options, node.span.end);
+    }
   }
 
-  out.push_back('\n');
-
-  for (NodeId child : node.children) {
-    dump_text_impl(context, child, options, out, depth + 1);
-  }
+  out.put('\n');
 }
 
-void dump_json_impl(const AstContext& context, NodeId id, const AstDumpOptions& options, std::string& out,
-                    std::size_t indent) {
-  const auto& node = context.node(id);
-  const std::string indent_str(indent, ' ');
-  out += indent_str;
-  out += "{\n";
-
-  const std::size_t inner_indent_value = indent + 2;
-  const std::string inner_indent(inner_indent_value, ' ');
-
-  std::size_t field_index = 0;
-  auto add_field = [&](const std::string& field) {
-    if (field_index > 0) {
-      out += ",\n";
-    }
-    out += inner_indent;
-    out += field;
-    ++field_index;
-  };
+// Everything up to and including the opening bracket of the children array.
+void open_json_node(const AstNode& node, const AstDumpOptions& options, DumpWriter& out, std::size_t indent) {
+  out.put_spaces(indent);
+  out.put("{\n");
 
+  const std::size_t inner_indent = indent + 2;
   if (options.include_ids) {
-    add_field("\"id\": " + std::to_string(node.id));
+    out.put_spaces(inner_indent);
+    out.put("\"id\": ");
+    out.put_number(node.id);
+    out.put(",\n");
   }
 
-  add_field(std::string("\"kind\": \"") + std::string(to_string(node.kind)) + "\"");
+  out.put_spaces(inner_indent);
+  out.put("\"kind\": \"");
+  out.put(to_string(node.kind));
+  out.put("\",\n");
 
   if (options.include_spans) {
-    add_field("\"span\": {\"start\": " + std::to_string(node.span.start) + ", \"end\": " +
-              std::to_string(node.span.end) + "}");
+    out.put_spaces(inner_indent);
+    out.put("\"span\": {\"start\": ");
+    out.put_number(node.span.start);
+    out.put(", \"end\": ");
+    out.put_number(node.span.end);
+    if (has_positions(options)) {
+      const auto start = options.sources->line_column(options.file, node.span.start);
+      const auto end = options.sources->line_column(options.file, node.span.end);
+      out.put(", \"start_line\": ");
+      out.put_number(start.line);
+      out.put(", \"start_column\": ");
+      out.put_number(start.column);
+      out.put(", \"end_line\": ");
+      out.put_number(end.line);
+      out.put(", \"end_column\": ");
+      out.put_number(end.column);
+    }
+    out.put("},\n");
   }
 
-  add_field(std::string("\"value\": \"") + json_escape(node.value) + "\"");
+  out.put_spaces(inner_indent);
+  out.put("\"value\": \"");
+  out.put_escaped_json(node.value);
+  out.put("\",\n");
 
-  if (field_index > 0) {
-    out += ",\n";
+  out.put_spaces(inner_indent);
+  out.put("\"children\": [");
+  if (!node.children.empty()) {
+    out.put('\n');
   }
+}
 
-  out += inner_indent;
-  out += "\"children\": [";
-
+void close_json_node(const AstNode& node, DumpWriter& out, std::size_t indent) {
   if (!node.children.empty()) {
-    out += "\n";
-    for (std::size_t i = 0; i < node.children.size(); ++i) {
-      dump_json_impl(context, node.children[i], options, out, inner_indent_value + 2);
-      if (i + 1 < node.children.size()) {
-        out += ",\n";
-      } else {
-        out += "\n";
-      }
-    }
-    out += inner_indent;
-    out += "]";
-  } else {
-    out += "]";
+    out.put('\n');
+    out.put_spaces(indent + 2);
   }
+  out.put("]\n");
+  out.put_spaces(indent);
+  out.put('}');
+}
+
+void write_text(const AstContext& context, NodeId root, const AstDumpOptions& options, DumpWriter& out) {
+  std::size_t depth = 0;
+  walk_ast(
+      context, root,
+      [&](const AstNode& node) {
+        write_text_node(node, options, out, depth++);
+        out.flush_if_full();
+        return WalkAction::visit_children();
+      },
+      [&](const AstNode&) { --depth; });
+}
+
+// Nodes at depth d are indented 4 * d: two for the object, two more for the children array holding it.
+void write_json(const AstContext& context, NodeId root, const AstDumpOptions& options, DumpWriter& out) {
+  // Children written so far by each node being dumped, to place the commas between siblings.
+  std::vector<std::size_t> written{};
+  walk_ast(
+      context, root,
+      [&](const AstNode& node) {
+        if (!written.empty() && written.back()++ > 0) {
+          out.put(",\n");
+        }
+        open_json_node(node, options, out, 4 * written.size());
+        written.push_back(0);
+        out.flush_if_full();
+        return WalkAction::visit_children();
+      },
+      [&](const AstNode& node) {
+        written.pop_back();
+        close_json_node(node, out, 4 * written.size());
+        out.flush_if_full();
+      });
+  out.put('\n');
+}
+
+// Label and used / reserved bytes of each line of a memory report.
+struct MemoryLine {
+  std::string_view label;
+  std::size_t used;
+  std::size_t reserved;
+};
 
-  out += "\n";
-  out += indent_str;
-  out += "}";
+std::vector<MemoryLine> memory_lines(const AstMemoryStats& stats) {
+  return {{"node", stats.node_bytes, stats.node_reserved_bytes},
+          {"child", stats.child_bytes, stats.child_reserved_bytes},
+          {"value", stats.value_bytes, stats.value_reserved_bytes},
+          {"total", stats.used_bytes(), stats.reserved_bytes()}};
 }
 
 }  // namespace
 
+void write_ast_text(const AstContext& context, NodeId root, std::ostream& out, const AstDumpOptions& options) {
+  DumpWriter writer{&out};
+  write_text(context, root, options, writer);
+  writer.flush();
+}
+
+void write_ast_json(const AstContext& context, NodeId root, std::ostream& out, const AstDumpOptions& options) {
+  DumpWriter writer{&out};
+  write_json(context, root, options, writer);
+  writer.flush();
+}
+
 std::string dump_ast_text(const AstContext& context, NodeId root, const AstDumpOptions& options) {
-  std::string output{};
-  dump_text_impl(context, root, options, output, 0);
-  return output;
+  DumpWriter writer{nullptr};
+  write_text(context, root, options, writer);
+  return writer.take();
 }
 
 std::string dump_ast_json(const AstContext& context, NodeId root, const AstDumpOptions& options) {
-  std::string output{};
-  dump_json_impl(context, root, options, output, 0);
-  output.push_back('\n');
+  DumpWriter writer{nullptr};
+  write_json(context, root, options, writer);
+  return writer.take();
+}
+
+std::string dump_memory_stats_text(const AstMemoryStats& stats) {
+  std::string output = "nodes: " + std::to_string(stats.node_count) + "\n";
+  for (const MemoryLine& line : memory_lines(stats)) {
+    output += std::string(line.label) + " bytes: used " + std::to_string(line.used) + ", reserved " +
+              std::to_string(line.reserved) + "\n";
+  }
+  return output;
+}
+
+std::string dump_memory_stats_json(const AstMemoryStats& stats) {
+  std::string output = "{\n  \"node_count\": " + std::to_string(stats.node_count);
+  for (const MemoryLine& line : memory_lines(stats)) {
+    output += ",\n  \"" + std::string(line.label) + "_bytes\": {\"used\": " + std::to_string(line.used) +
+              ", \"reserved\": " + std::to_string(line.reserved) + "}";
+  }
+  output += "\n}\n";
   return output;
 }
 
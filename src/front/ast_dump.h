@@ -1,18 +1,32 @@
 #pragma once
 
+#include <ostream>
 #include <string>
 
 #include "front/ast.h"
+#include "support/source_manager.h"
 
 namespace istudio::front {
 
 struct AstDumpOptions {
   bool include_ids{true};
   bool include_spans{true};
+  // When set, spans are also rendered as line:column positions within `file`.
+  const support::SourceManager* sources{nullptr};
+  support::FileId file{support::kInvalidFileId};
 };
 
+// Stream the dump to `out` through a small reusable buffer, so memory use does not grow with the size of the
+// dump. Stream errors are left in `out`'s state.
+void write_ast_text(const AstContext& context, NodeId root, std::ostream& out, const AstDumpOptions& options = {});
+void write_ast_json(const AstContext& context, NodeId root, std::ostream& out, const AstDumpOptions& options = {});
+// Collect the same dumps in a string.
 [[nodiscard]] std::string dump_ast_text(const AstContext& context, NodeId root, const AstDumpOptions& options = {});
 [[nodiscard]] std::string dump_ast_json(const AstContext& context, NodeId root, const AstDumpOptions& options = {});
 
+// One line per kind of storage (nodes, children, values, total) with bytes used and reserved.
+[[nodiscard]] std::string dump_memory_stats_text(const AstMemoryStats& stats);
+[[nodiscard]] std::string dump_memory_stats_json(const AstMemoryStats& stats);
+
 }  // namespace istudio::front
 
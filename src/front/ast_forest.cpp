@@ -0,0 +1,42 @@
+#include "front/ast_forest.h"
+
+#include <stdexcept>
+
+namespace istudio::front {
+
+AstContext& AstForest::add_shard(support::FileId file) {
+  const auto shard = static_cast<std::uint32_t>(trees_.size());
+  if (shard >= (std::uint32_t{1} << (64 - kShardShift))) {
+    throw std::length_error("too many AST shards");
+  }
+  trees_.push_back(Tree{.context = std::make_unique<AstContext>(interner_, shard), .file = file, .root = 0});
+  return *trees_.back().context;
+}
+
+void AstForest::set_root(std::uint32_t shard, NodeId root) {
+  trees_.at(shard).root = root;
+}
+
+const AstContext& AstForest::shard(std::uint32_t shard) const {
+  if (shard >= trees_.size()) {
+    throw std::out_of_range("invalid AST shard");
+  }
+  return *trees_[shard].context;
+}
+
+AstContext& AstForest::shard(std::uint32_t shard) {
+  if (shard >= trees_.size()) {
+    throw std::out_of_range("invalid AST shard");
+  }
+  return *trees_[shard].context;
+}
+
+std::size_t AstForest::size() const noexcept {
+  std::size_t nodes = 0;
+  for (const Tree& tree : trees_) {
+    nodes += tree.context->size();
+  }
+  return nodes;
+}
+
+}  // namespace istudio::front
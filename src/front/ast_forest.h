@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "front/ast.h"
+#include "support/source_manager.h"
+#include "support/string_interner.h"
+
+namespace istudio::front {
+
+// The ASTs of several files, one AstContext shard per file, read as one forest: any id from any shard
+// resolves through node(). Shards share the forest's interner, so equal names have equal symbols everywhere.
+class AstForest {
+ public:
+  explicit AstForest(std::shared_ptr<support::StringInterner> interner = std::make_shared<support::StringInterner>())
+      : interner_(std::move(interner)) {}
+
+  // Adds an empty shard for `file`; its number is the previous shard_count(). The context stays at the same
+  // address for the forest's lifetime, so shards can be filled concurrently once added.
+  AstContext& add_shard(support::FileId file);
+  void set_root(std::uint32_t shard, NodeId root);
+
+  [[nodiscard]] const AstNode& node(NodeId id) const { return shard(shard_of(id)).node(id); }
+  // Structural hashes do not depend on the shard, so equal subtrees of different files hash equally.
+  [[nodiscard]] std::uint64_t structural_hash(NodeId id) const { return shard(shard_of(id)).structural_hash(id); }
+  [[nodiscard]] const AstContext& shard(std::uint32_t shard) const;
+  [[nodiscard]] AstContext& shard(std::uint32_t shard);
+  [[nodiscard]] support::FileId file(std::uint32_t shard) const { return trees_.at(shard).file; }
+  [[nodiscard]] NodeId root(std::uint32_t shard) const { return trees_.at(shard).root; }
+  [[nodiscard]] std::uint32_t shard_count() const noexcept { return static_cast<std::uint32_t>(trees_.size()); }
+  // Nodes across all shards.
+  [[nodiscard]] std::size_t size() const noexcept;
+  [[nodiscard]] const std::shared_ptr<support::StringInterner>& interner() const noexcept { return interner_; }
+
+ private:
+  struct Tree {
+    std::unique_ptr<AstContext> context{};
+    support::FileId file{support::kInvalidFileId};
+    NodeId root{0};
+  };
+
+  std::shared_ptr<support::StringInterner> interner_;
+  std::vector<Tree> trees_{};
+};
+
+}  // namespace istudio::front
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "front/ast.h"
+#include "front/ast_forest.h"
+
+namespace istudio::front {
+
+// Returned by a walk's enter callback: visit the node's children from `first_child` on.
+struct WalkAction {
+  std::size_t first_child{0};
+
+  [[nodiscard]] static constexpr WalkAction visit_children() noexcept { return {0}; }
+  [[nodiscard]] static constexpr WalkAction visit_children_from(std::size_t index) noexcept { return {index}; }
+  [[nodiscard]] static constexpr WalkAction skip_children() noexcept {
+    return {std::numeric_limits<std::size_t>::max()};
+  }
+};
+
+// Depth-first walk of the subtree at `root` on an explicit stack, so nesting depth is bounded by memory, not by
+// the call stack. `enter(const AstNode&)` runs before a node's children and picks which of them to visit;
+// `leave(const AstNode&)` runs after them, skipped or not. `tree` is an AstContext or an AstForest. Frames hold
+// ids and look their node up at every step, so callbacks may create nodes, which can move the node a callback
+// was given, but must not change the child list of a node being walked.
+template <typename Tree, typename Enter, typename Leave>
+void walk_ast(const Tree& tree, NodeId root, Enter&& enter, Leave&& leave) {
+  struct Frame {
+    NodeId id;
+    std::size_t next_child;
+  };
+  std::vector<Frame> stack{};
+  // Walks are often of one statement or body; one allocation covers most.
+  stack.reserve(16);
+  stack.push_back(Frame{root, enter(tree.node(root)).first_child});
+  while (!stack.empty()) {
+    const Frame top = stack.back();
+    const auto& children = tree.node(top.id).children;
+    if (top.next_child < children.size()) {
+      const NodeId child = children[top.next_child];
+      ++stack.back().next_child;
+      stack.push_back(Frame{child, enter(tree.node(child)).first_child});
+    } else {
+      stack.pop_back();
+      leave(tree.node(top.id));
+    }
+  }
+}
+
+// Calls `visit(const AstNode&)` on every node of the subtree at `root` in post-order, children before parents.
+// A post-ordered context (AstContext::is_post_ordered) is read as one linear scan; others are walked.
+template <typename Visit>
+void walk_ast_post_order(const AstContext& context, NodeId root, Visit&& visit) {
+  if (context.is_post_ordered()) {
+    for (NodeId id = context.first_descendant(root); id <= root; ++id) {
+      visit(context.node(id));
+    }
+    return;
+  }
+  walk_ast(context, root, [](const AstNode&) { return WalkAction::visit_children(); }, visit);
+}
+
+// A subtree never spans shards, so it is scanned within the shard holding `root`.
+template <typename Visit>
+void walk_ast_post_order(const AstForest& forest, NodeId root, Visit&& visit) {
+  walk_ast_post_order(forest.shard(shard_of(root)), root, visit);
+}
+
+}  // namespace istudio::front
@@ -1,104 +1,118 @@
 #include "front/lexer.h"
 
-#include <array>
-#include <cctype>
-#include <utility>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+#include "front/lexer_tables.h"
+#include "front/scan.h"
 
 namespace istudio::front {
 namespace {
 
 bool is_identifier_start(char ch) {
-  return std::isalpha(static_cast<unsigned char>(ch)) || ch == '_';
-}
-
-bool is_identifier_continue(char ch) {
-  return is_identifier_start(ch) || std::isdigit(static_cast<unsigned char>(ch));
+  return has_char_class(ch, kCharIdentStart);
 }
 
 bool is_digit(char ch) {
-  return std::isdigit(static_cast<unsigned char>(ch));
+  return has_char_class(ch, kCharDigit);
 }
 
-bool is_keyword(std::string_view word) {
-  constexpr std::array<std::string_view, 9> keywords{
-      "module", "fn",   "pub",   "let", "mut", "struct", "enum", "ct", "return"};
-  for (auto kw : keywords) {
-    if (kw == word) {
-      return true;
-    }
+}  // namespace
+
+Lexer::Lexer(std::string_view source, LexerConfig config)
+    : source_(source), config_(config), scan_(&scan_kernels()) {
+  if (source_.size() > std::numeric_limits<std::uint32_t>::max()) {
+    throw std::length_error("source exceeds the 4 GiB token offset limit");
   }
-  return false;
 }
 
-bool is_compound_symbol(std::string_view symbol) {
-  constexpr std::array<std::string_view, 20> compound{
-      "==", "!=", "<=", ">=", "&&", "||", "::", "->", "=>", "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=", "<<",
-      ">>", ">>="};
-  for (auto sym : compound) {
-    if (sym == symbol) {
-      return true;
+TokenStream Lexer::lex() {
+  TokenStream stream{source_};
+  // Generated sources average roughly one token per six bytes.
+  stream.reserve((source_.size() - position_) / 6 + 1);
+  while (true) {
+    const Token token = next();
+    stream.push_back(token, pending_leading_);
+    if (token.kind == TokenKind::EndOfFile) {
+      return stream;
     }
   }
-  return false;
 }
 
-}  // namespace
-
-Lexer::Lexer(std::string_view source, LexerConfig config)
-    : source_(source), config_(config) {}
-
-TokenStream Lexer::lex() {
-  TokenStream stream{};
-  while (position_ < source_.size()) {
+Token Lexer::next() {
+  pending_leading_.clear();
+  while (true) {
     skip_whitespace();
     if (position_ >= source_.size()) {
-      break;
+      const auto eof = support::make_span(source_.size(), source_.size());
+      return Token{.kind = TokenKind::EndOfFile, .lexeme = {}, .span = eof};
     }
 
     if (source_[position_] == '/' && position_ + 1 < source_.size() && source_[position_ + 1] == '/') {
       const auto start = position_;
-      position_ += 2;
-      while (position_ < source_.size() && source_[position_] != '\n') {
-        ++position_;
-      }
+      position_ = scan_->find_newline(source_.data(), source_.size(), position_ + 2);
       capture_trivia(TriviaKind::Comment, start, position_, pending_leading_);
       continue;
     }
+    break;
+  }
 
-    Token token{};
-    if (is_identifier_start(source_[position_])) {
-      token = read_identifier();
-    } else if (is_digit(source_[position_])) {
-      token = read_number();
-    } else if (source_[position_] == '"') {
-      token = read_string();
-    } else {
-      token = read_symbol();
-    }
-    stream.tokens.push_back(std::move(token));
+  if (is_identifier_start(source_[position_])) {
+    return read_identifier();
+  }
+  if (is_digit(source_[position_])) {
+    return read_number();
+  }
+  if (source_[position_] == '"') {
+    return read_string();
   }
+  return read_symbol();
+}
+
+std::size_t Lexer::estimate_remaining_tokens() const {
+  constexpr std::size_t kSampleBytes = 64 * 1024;
+  const std::string_view rest = source_.substr(position_);
+  std::size_t sample_bytes = rest.size();
+  if (sample_bytes > kSampleBytes) {
+    // The sample ends at a line end, so it does not cut a token in two.
+    sample_bytes = std::min(rest.size(), scan_->find_newline(rest.data(), rest.size(), kSampleBytes) + 1);
+  }
+  LexerConfig plain{};
+  plain.capture_comments = false;
+  Lexer sample{rest.substr(0, sample_bytes), plain};
+  std::size_t tokens = 1;
+  while (sample.next().kind != TokenKind::EndOfFile) {
+    ++tokens;
+  }
+  if (sample_bytes == rest.size()) {
+    return tokens;
+  }
+  const std::size_t estimate = tokens * rest.size() / sample_bytes;
+  return estimate + estimate / 8;
+}
 
-  Token eof{};
-  eof.kind = TokenKind::EndOfFile;
-  eof.lexeme = "";
-  eof.span = {source_.size(), source_.size()};
-  eof.leading_trivia = std::exchange(pending_leading_, {});
-  stream.tokens.push_back(std::move(eof));
-  return stream;
+void Lexer::seek(std::size_t position) {
+  if (position > source_.size()) {
+    throw std::out_of_range("lexer seek position past end of source");
+  }
+  position_ = position;
+  pending_leading_.clear();
 }
 
 Token Lexer::read_identifier() {
   const auto start = position_;
-  ++position_;
-  while (position_ < source_.size() && is_identifier_continue(source_[position_])) {
-    ++position_;
-  }
+  position_ = scan_->skip_identifier(source_.data(), source_.size(), position_ + 1);
   const auto end = position_;
   Token token{};
-  token.leading_trivia = std::exchange(pending_leading_, {});
-  token.lexeme = std::string(source_.substr(start, end - start));
-  token.span = {start, end};
-  token.kind = is_keyword(token.lexeme) ? TokenKind::Keyword : TokenKind::Identifier;
+  token.lexeme = source_.substr(start, end - start);
+  token.span = support::make_span(start, end);
+  token.keyword = classify_keyword(token.lexeme);
+  token.kind = token.keyword == Keyword::None ? TokenKind::Identifier : TokenKind::Keyword;
+  if (token.kind == TokenKind::Identifier && config_.interner != nullptr) {
+    token.symbol = config_.interner->intern(token.lexeme);
+  }
   return token;
 }
 
@@ -116,9 +130,8 @@ Token Lexer::read_number() {
 
   const auto end = position_;
   Token token{};
-  token.leading_trivia = std::exchange(pending_leading_, {});
-  token.lexeme = std::string(source_.substr(start, end - start));
-  token.span = {start, end};
+  token.lexeme = source_.substr(start, end - start);
+  token.span = support::make_span(start, end);
   token.kind = TokenKind::Number;
   return token;
 }
@@ -140,34 +153,21 @@ Token Lexer::read_string() {
 
   const auto end = position_;
   Token token{};
-  token.leading_trivia = std::exchange(pending_leading_, {});
-  token.lexeme = std::string(source_.substr(start, end - start));
-  token.span = {start, end};
+  token.lexeme = source_.substr(start, end - start);
+  token.span = support::make_span(start, end);
   token.kind = TokenKind::StringLiteral;
   return token;
 }
 
 Token Lexer::read_symbol() {
   const auto start = position_;
-  std::string lexeme;
-  lexeme.push_back(source_[position_]);
-  ++position_;
-
-  while (position_ < source_.size()) {
-    std::string candidate = lexeme;
-    candidate.push_back(source_[position_]);
-    if (is_compound_symbol(candidate)) {
-      lexeme = std::move(candidate);
-      ++position_;
-      continue;
-    }
-    break;
-  }
+  const OperatorMatch match = match_operator(source_, position_);
+  position_ += match.length;
 
   Token token{};
-  token.leading_trivia = std::exchange(pending_leading_, {});
-  token.lexeme = std::move(lexeme);
-  token.span = {start, position_};
+  token.punct = match.punct;
+  token.lexeme = source_.substr(start, position_ - start);
+  token.span = support::make_span(start, position_);
   token.kind = TokenKind::Symbol;
   return token;
 }
@@ -175,20 +175,15 @@ Token Lexer::read_symbol() {
 Trivia Lexer::make_trivia(TriviaKind kind, std::size_t start, std::size_t end) const {
   Trivia trivia{};
   trivia.kind = kind;
-  trivia.text = std::string(source_.substr(start, end - start));
-  trivia.span = {start, end};
+  trivia.text = source_.substr(start, end - start);
+  trivia.span = support::make_span(start, end);
   return trivia;
 }
 
 void Lexer::skip_whitespace() {
-  bool consumed = false;
   const auto start = position_;
-  while (position_ < source_.size() &&
-         std::isspace(static_cast<unsigned char>(source_[position_])) != 0) {
-    ++position_;
-    consumed = true;
-  }
-  if (consumed && config_.capture_whitespace) {
+  position_ = scan_->skip_whitespace(source_.data(), source_.size(), position_);
+  if (position_ != start && config_.capture_whitespace) {
     pending_leading_.push_back(make_trivia(TriviaKind::Whitespace, start, position_));
   }
 }
@@ -206,4 +201,57 @@ TokenStream lex(std::string_view source, const LexerConfig& config) {
   return lexer.lex();
 }
 
+TokenStream relex(const TokenStream& previous, std::string_view source, const SourceEdit& edit,
+                  const LexerConfig& config) {
+  const std::string_view old_source = previous.source();
+  const std::size_t removed = edit.range.length();
+  if (edit.range.start > edit.range.end || edit.range.end > old_source.size() ||
+      source.size() != old_source.size() - removed + edit.text.size()) {
+    throw std::invalid_argument("edit does not turn the previous source into the new one");
+  }
+
+  // A token is unaffected if it ends strictly before the edit: lexing it never looks past the byte at its end.
+  std::size_t kept = 0;
+  std::size_t count = previous.size();
+  while (count > 0) {
+    const std::size_t half = count / 2;
+    if (previous[kept + half].span.end < edit.range.start) {
+      kept += half + 1;
+      count -= half + 1;
+    } else {
+      count = half;
+    }
+  }
+
+  TokenStream stream{source};
+  stream.reserve(previous.size() + edit.text.size() / 6 + 1);
+  stream.append_shifted(previous, 0, kept, 0);
+
+  Lexer lexer{source, config};
+  lexer.seek(kept == 0 ? 0 : previous[kept - 1].span.end);
+
+  // Past the inserted text, a new token starting where an old one did (after shifting) means the lexers
+  // have resynchronized: everything after it is lexed from identical bytes.
+  const std::size_t inserted_end = edit.range.start + edit.text.size();
+  const auto delta = static_cast<std::ptrdiff_t>(edit.text.size()) - static_cast<std::ptrdiff_t>(removed);
+  std::size_t candidate = kept;
+  while (true) {
+    const Token token = lexer.next();
+    stream.push_back(token, lexer.leading_trivia());
+    if (token.span.start >= inserted_end) {
+      const std::size_t old_start = token.span.start - edit.text.size() + removed;
+      while (candidate < previous.size() && previous[candidate].span.start < old_start) {
+        ++candidate;
+      }
+      if (candidate < previous.size() && previous[candidate].span.start == old_start) {
+        stream.append_shifted(previous, candidate + 1, previous.size(), delta);
+        return stream;
+      }
+    }
+    if (token.kind == TokenKind::EndOfFile) {
+      return stream;
+    }
+  }
+}
+
 }  // namespace istudio::front
@@ -1,17 +1,45 @@
 #pragma once
 
+#include <span>
 #include <string_view>
+#include <vector>
 
 #include "front/token.h"
+#include "support/span.h"
+
+namespace istudio::support {
+class ThreadPool;
+}  // namespace istudio::support
 
 namespace istudio::front {
 
+struct ScanKernels;
+
+// Replacement of the bytes `range` of the old source with `text`.
+struct SourceEdit {
+  support::Span range{};
+  std::string_view text{};
+};
+
 class Lexer {
  public:
   explicit Lexer(std::string_view source, LexerConfig config = {});
 
+  // Lexes the remaining input into a stream; a convenience wrapper over next().
   [[nodiscard]] TokenStream lex();
 
+  // Pull interface: returns the next token, then EndOfFile forever once the input is exhausted.
+  [[nodiscard]] Token next();
+  // Trivia captured ahead of the token most recently returned by next().
+  [[nodiscard]] std::span<const Trivia> leading_trivia() const noexcept { return pending_leading_; }
+  // Input not yet lexed.
+  [[nodiscard]] std::size_t remaining_bytes() const noexcept { return source_.size() - position_; }
+  // Tokens left in the input, extrapolated from lexing up to the first 64 KiB of it, with some headroom; exact
+  // for shorter input. For sizing buffers ahead of a streaming parse.
+  [[nodiscard]] std::size_t estimate_remaining_tokens() const;
+  // Resumes lexing at `position`, which must be a token boundary (or the end of a token).
+  void seek(std::size_t position);
+
  private:
   [[nodiscard]] Token read_identifier();
   [[nodiscard]] Token read_number();
@@ -23,10 +51,24 @@ class Lexer {
 
   std::string_view source_;
   LexerConfig config_{};
+  const ScanKernels* scan_{nullptr};
   std::size_t position_{0};
   std::vector<Trivia> pending_leading_{};
 };
 
 TokenStream lex(std::string_view source, const LexerConfig& config = {});
 
+// Lexes newline-aligned chunks of `source` concurrently on `pool` and stitches them into exactly the stream
+// lex() would produce. Chunks are about `chunk_bytes` long (0 picks a size from the pool); sources that
+// would form a single chunk are lexed sequentially.
+TokenStream lex_parallel(std::string_view source, support::ThreadPool& pool, const LexerConfig& config = {},
+                         std::size_t chunk_bytes = 0);
+
+// Incrementally re-lexes `source`, the result of applying `edit` to `previous.source()`. Tokens ending before
+// the edit are kept, lexing restarts at the last token boundary in front of it and stops as soon as a token
+// lines up with one from `previous`; the rest of `previous` is reused with shifted spans. `config` must be the
+// configuration `previous` was produced with.
+TokenStream relex(const TokenStream& previous, std::string_view source, const SourceEdit& edit,
+                  const LexerConfig& config = {});
+
 }  // namespace istudio::front
@@ -0,0 +1,92 @@
+#include "front/lexer_tables.h"
+
+namespace istudio::front {
+namespace {
+
+static_assert(classify_keyword("return") == Keyword::Return && classify_keyword("returns") == Keyword::None);
+
+struct OperatorEntry {
+  std::string_view text{};
+  Punct punct{Punct::None};
+};
+
+constexpr std::array<OperatorEntry, 47> kOperators{{
+    {"(", Punct::LParen},        {")", Punct::RParen},         {"{", Punct::LBrace},
+    {"}", Punct::RBrace},        {"[", Punct::LBracket},       {"]", Punct::RBracket},
+    {",", Punct::Comma},         {";", Punct::Semicolon},      {":", Punct::Colon},
+    {".", Punct::Dot},           {"?", Punct::Question},       {"@", Punct::At},
+    {"#", Punct::Hash},          {"$", Punct::Dollar},         {"~", Punct::Tilde},
+    {"+", Punct::Plus},          {"-", Punct::Minus},          {"*", Punct::Star},
+    {"/", Punct::Slash},         {"%", Punct::Percent},        {"&", Punct::Amp},
+    {"|", Punct::Pipe},          {"^", Punct::Caret},          {"!", Punct::Bang},
+    {"<", Punct::Less},          {">", Punct::Greater},        {"=", Punct::Assign},
+    {"==", Punct::EqualEqual},   {"!=", Punct::BangEqual},     {"<=", Punct::LessEqual},
+    {">=", Punct::GreaterEqual}, {"&&", Punct::AmpAmp},        {"||", Punct::PipePipe},
+    {"::", Punct::ColonColon},   {"->", Punct::Arrow},         {"=>", Punct::FatArrow},
+    {"+=", Punct::PlusAssign},   {"-=", Punct::MinusAssign},   {"*=", Punct::StarAssign},
+    {"/=", Punct::SlashAssign},  {"%=", Punct::PercentAssign}, {"&=", Punct::AmpAssign},
+    {"|=", Punct::PipeAssign},   {"^=", Punct::CaretAssign},   {"<<", Punct::ShiftLeft},
+    {">>", Punct::ShiftRight},   {">>=", Punct::ShiftRightAssign},
+}};
+
+// DFA whose states are the punctuators themselves: `start` maps the first byte to a state and `next`
+// extends a state by one ASCII byte, or yields Punct::None when the longer spelling is not an operator.
+struct OperatorDfa {
+  std::array<Punct, 256> start{};
+  std::array<std::array<Punct, 128>, kPunctCount> next{};
+  bool prefix_closed{true};
+};
+
+constexpr Punct find_operator(std::string_view text) {
+  for (const auto& entry : kOperators) {
+    if (entry.text == text) {
+      return entry.punct;
+    }
+  }
+  return Punct::None;
+}
+
+constexpr OperatorDfa build_operator_dfa() {
+  OperatorDfa dfa{};
+  dfa.start.fill(Punct::Other);
+  for (const auto& entry : kOperators) {
+    const auto last = static_cast<unsigned char>(entry.text.back());
+    if (entry.text.size() == 1) {
+      dfa.start[last] = entry.punct;
+      continue;
+    }
+    // Maximal munch only grows through operators, so every proper prefix must be an operator too.
+    const Punct prefix = find_operator(entry.text.substr(0, entry.text.size() - 1));
+    if (prefix == Punct::None || last >= 128) {
+      dfa.prefix_closed = false;
+      continue;
+    }
+    dfa.next[static_cast<std::size_t>(prefix)][last] = entry.punct;
+  }
+  return dfa;
+}
+
+constexpr OperatorDfa kOperatorDfa = build_operator_dfa();
+static_assert(kOperatorDfa.prefix_closed, "every compound operator must extend a shorter operator");
+
+}  // namespace
+
+OperatorMatch match_operator(std::string_view source, std::size_t pos) noexcept {
+  Punct state = kOperatorDfa.start[static_cast<unsigned char>(source[pos])];
+  std::size_t end = pos + 1;
+  while (end < source.size()) {
+    const auto byte = static_cast<unsigned char>(source[end]);
+    if (byte >= 128) {
+      break;
+    }
+    const Punct extended = kOperatorDfa.next[static_cast<std::size_t>(state)][byte];
+    if (extended == Punct::None) {
+      break;
+    }
+    state = extended;
+    ++end;
+  }
+  return OperatorMatch{.punct = state, .length = end - pos};
+}
+
+}  // namespace istudio::front
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "front/token.h"
+
+namespace istudio::front {
+
+inline constexpr std::uint8_t kCharSpace = 0x01;
+inline constexpr std::uint8_t kCharIdentStart = 0x02;
+inline constexpr std::uint8_t kCharIdentContinue = 0x04;
+inline constexpr std::uint8_t kCharDigit = 0x08;
+
+// ASCII character classes indexed by byte value; bytes >= 0x80 belong to no class.
+inline constexpr std::array<std::uint8_t, 256> kCharClassTable = [] {
+  std::array<std::uint8_t, 256> table{};
+  for (std::size_t ch = 0; ch < table.size(); ++ch) {
+    std::uint8_t bits = 0;
+    const bool alpha = (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z');
+    const bool digit = ch >= '0' && ch <= '9';
+    if (ch == ' ' || (ch >= '\t' && ch <= '\r')) {
+      bits |= kCharSpace;
+    }
+    if (alpha || ch == '_') {
+      bits |= kCharIdentStart | kCharIdentContinue;
+    }
+    if (digit) {
+      bits |= kCharDigit | kCharIdentContinue;
+    }
+    table[ch] = bits;
+  }
+  return table;
+}();
+
+[[nodiscard]] constexpr bool has_char_class(char ch, std::uint8_t classes) noexcept {
+  return (kCharClassTable[static_cast<unsigned char>(ch)] & classes) != 0;
+}
+
+namespace detail {
+
+struct KeywordEntry {
+  std::string_view text{};
+  Keyword keyword{Keyword::None};
+};
+
+inline constexpr std::array<KeywordEntry, 9> kKeywords{{
+    {"module", Keyword::Module},
+    {"fn", Keyword::Fn},
+    {"pub", Keyword::Pub},
+    {"let", Keyword::Let},
+    {"mut", Keyword::Mut},
+    {"struct", Keyword::Struct},
+    {"enum", Keyword::Enum},
+    {"ct", Keyword::Ct},
+    {"return", Keyword::Return},
+}};
+
+inline constexpr std::size_t kKeywordTableSize = 16;
+inline constexpr std::size_t kMinKeywordLength = 2;
+inline constexpr std::size_t kMaxKeywordLength = 6;
+
+constexpr std::size_t keyword_hash(std::string_view word) noexcept {
+  const auto first = static_cast<std::size_t>(static_cast<unsigned char>(word.front()));
+  const auto last = static_cast<std::size_t>(static_cast<unsigned char>(word.back()));
+  return (first * 3 + last * 5 + word.size()) & (kKeywordTableSize - 1);
+}
+
+struct KeywordTable {
+  std::array<KeywordEntry, kKeywordTableSize> slots{};
+  bool perfect{true};
+};
+
+constexpr KeywordTable build_keyword_table() {
+  KeywordTable table{};
+  for (const auto& entry : kKeywords) {
+    auto& slot = table.slots[keyword_hash(entry.text)];
+    if (slot.keyword != Keyword::None || entry.text.size() < kMinKeywordLength ||
+        entry.text.size() > kMaxKeywordLength) {
+      table.perfect = false;
+    }
+    slot = entry;
+  }
+  return table;
+}
+
+inline constexpr KeywordTable kKeywordTable = build_keyword_table();
+static_assert(kKeywordTable.perfect, "keyword_hash must map every keyword to its own slot");
+
+}  // namespace detail
+
+// Perfect-hash keyword lookup; Keyword::None for ordinary identifiers.
+[[nodiscard]] constexpr Keyword classify_keyword(std::string_view word) noexcept {
+  if (word.size() < detail::kMinKeywordLength || word.size() > detail::kMaxKeywordLength) {
+    return Keyword::None;
+  }
+  const auto& slot = detail::kKeywordTable.slots[detail::keyword_hash(word)];
+  return slot.text == word ? slot.keyword : Keyword::None;
+}
+
+struct OperatorMatch {
+  Punct punct{Punct::None};
+  std::size_t length{0};
+};
+
+// Longest punctuator starting at `pos` (maximal munch). Bytes outside the operator set match as a single
+// `Punct::Other`. Requires `pos < source.size()`.
+[[nodiscard]] OperatorMatch match_operator(std::string_view source, std::size_t pos) noexcept;
+
+}  // namespace istudio::front
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "front/ast.h"
+
+namespace istudio::front {
+
+// A fact per AST node, stored densely by the node's index within its shard, with a presence bitmap: set, find
+// and contains index two arrays and never hash. Meant for analyses that attach something to most nodes; a
+// table grows to cover whatever ids it is given, but reserving from AstContext::size() avoids regrowth.
+template <typename T>
+class NodeTable {
+ public:
+  // Makes room for the first `nodes` nodes of `shard`.
+  void reserve(std::uint32_t shard, std::size_t nodes) {
+    Shard& entries = shard_entries(shard);
+    if (entries.values.size() < nodes) {
+      entries.values.resize(nodes);
+      entries.present.resize((nodes + 63) / 64);
+    }
+  }
+
+  void set(NodeId id, T value) {
+    Shard& entries = shard_entries(shard_of(id));
+    const std::size_t index = index_of(id);
+    if (index >= entries.values.size()) {
+      // resize() alone would grow one id at a time for nodes set in increasing order.
+      const std::size_t nodes = std::max(index + 1, 2 * entries.values.size());
+      entries.values.resize(nodes);
+      entries.present.resize((nodes + 63) / 64);
+    }
+    entries.values[index] = std::move(value);
+    entries.present[index / 64] |= std::uint64_t{1} << (index % 64);
+  }
+
+  // For threads that set disjoint ids at once, in a table already reserved to cover them: ids sharing a word of
+  // the presence bitmap may be set from different threads, so bits are set, and by find_shared read, atomically.
+  // Values need no more, each id being set by one thread and read by others only after it is done.
+  void set_shared(NodeId id, T value) {
+    Shard& entries = shards_[shard_of(id)];
+    const std::size_t index = index_of(id);
+    entries.values[index] = std::move(value);
+    std::atomic_ref<std::uint64_t>{entries.present[index / 64]}.fetch_or(std::uint64_t{1} << (index % 64),
+                                                                         std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] const T* find_shared(NodeId id) const noexcept {
+    const std::uint32_t shard = shard_of(id);
+    const std::size_t index = index_of(id);
+    if (shard >= shards_.size() || index >= shards_[shard].values.size()) {
+      return nullptr;
+    }
+    // atomic_ref needs a mutable object; the word is only read.
+    auto& word = const_cast<std::uint64_t&>(shards_[shard].present[index / 64]);
+    const std::uint64_t bits = std::atomic_ref<std::uint64_t>{word}.load(std::memory_order_relaxed);
+    return ((bits >> (index % 64)) & 1) != 0 ? &shards_[shard].values[index] : nullptr;
+  }
+
+  // Null if nothing was set for `id`.
+  [[nodiscard]] const T* find(NodeId id) const noexcept {
+    return contains(id) ? &shards_[shard_of(id)].values[index_of(id)] : nullptr;
+  }
+
+  [[nodiscard]] bool contains(NodeId id) const noexcept {
+    const std::uint32_t shard = shard_of(id);
+    const std::size_t index = index_of(id);
+    return shard < shards_.size() && index < shards_[shard].values.size() &&
+           ((shards_[shard].present[index / 64] >> (index % 64)) & 1) != 0;
+  }
+
+  // Calls `visit(NodeId, const T&)` on every fact, in id order.
+  template <typename Visit>
+  void for_each(Visit&& visit) const {
+    for (std::uint32_t shard = 0; shard < shards_.size(); ++shard) {
+      const Shard& entries = shards_[shard];
+      for (std::size_t word = 0; word < entries.present.size(); ++word) {
+        for (std::uint64_t bits = entries.present[word]; bits != 0; bits &= bits - 1) {
+          const std::size_t index = 64 * word + static_cast<std::size_t>(std::countr_zero(bits));
+          visit((NodeId{shard} << kShardShift) | index, entries.values[index]);
+        }
+      }
+    }
+  }
+
+  // Forgets every fact but keeps the memory for the next analysis; old values stay until overwritten.
+  void clear() noexcept {
+    for (Shard& entries : shards_) {
+      std::fill(entries.present.begin(), entries.present.end(), std::uint64_t{0});
+    }
+  }
+
+ private:
+  struct Shard {
+    std::vector<T> values{};
+    std::vector<std::uint64_t> present{};
+  };
+
+  [[nodiscard]] static std::size_t index_of(NodeId id) noexcept {
+    return static_cast<std::size_t>(id & ((NodeId{1} << kShardShift) - 1));
+  }
+
+  Shard& shard_entries(std::uint32_t shard) {
+    if (shard >= shards_.size()) {
+      shards_.resize(std::size_t{shard} + 1);
+    }
+    return shards_[shard];
+  }
+
+  std::vector<Shard> shards_{};
+};
+
+}  // namespace istudio::front
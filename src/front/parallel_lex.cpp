@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <cstdint>
+#include <future>
+#include <span>
+#include <vector>
+
+#include "front/lexer.h"
+#include "front/scan.h"
+#include "support/thread_pool.h"
+
+namespace istudio::front {
+namespace {
+
+// Below this a chunk is not worth a task.
+constexpr std::size_t kMinChunkBytes = 64 * 1024;
+// Chunks per worker, so one slow chunk does not idle the rest of the pool.
+constexpr std::size_t kChunksPerWorker = 4;
+
+// Tokens lexed speculatively from a chunk start, assuming it is a token boundary. Only tokens starting
+// inside [begin, end) are kept (plus EndOfFile for the last chunk).
+struct ChunkTokens {
+  std::size_t begin{0};
+  std::size_t end{0};
+  TokenStream tokens{};
+  // Trivia after the last token that starts inside the chunk; whitespace is cut at `end`.
+  std::vector<Trivia> trailing{};
+};
+
+// Trivia in `leading` that starts before `end`, with a whitespace run crossing `end` cut there.
+std::vector<Trivia> trivia_before(std::string_view source, std::span<const Trivia> leading, std::size_t end) {
+  std::vector<Trivia> kept{};
+  for (const Trivia& trivia : leading) {
+    if (trivia.span.start >= end) {
+      break;
+    }
+    Trivia& piece = kept.emplace_back(trivia);
+    if (piece.span.end > end) {
+      piece.span.end = static_cast<std::uint32_t>(end);
+      piece.text = source.substr(piece.span.start, piece.span.length());
+    }
+  }
+  return kept;
+}
+
+ChunkTokens lex_chunk(std::string_view source, std::size_t begin, std::size_t end, const LexerConfig& config) {
+  ChunkTokens chunk{.begin = begin, .end = end, .tokens = TokenStream{source}, .trailing = {}};
+  const bool last = end == source.size();
+  Lexer lexer{source, config};
+  lexer.seek(begin);
+  while (true) {
+    const Token token = lexer.next();
+    if (!last && token.span.start >= end) {
+      chunk.trailing = trivia_before(source, lexer.leading_trivia(), end);
+      return chunk;
+    }
+    chunk.tokens.push_back(token, lexer.leading_trivia());
+    if (token.kind == TokenKind::EndOfFile) {
+      return chunk;
+    }
+  }
+}
+
+// Newline-aligned chunk boundaries: every chunk but the first starts just after a '\n'.
+std::vector<std::size_t> chunk_starts(std::string_view source, std::size_t chunk_bytes) {
+  const ScanKernels& scan = scan_kernels();
+  std::vector<std::size_t> starts{0};
+  for (std::size_t target = chunk_bytes; target < source.size(); target = starts.back() + chunk_bytes) {
+    const std::size_t newline = scan.find_newline(source.data(), source.size(), target);
+    if (newline + 1 >= source.size()) {
+      break;
+    }
+    starts.push_back(newline + 1);
+  }
+  return starts;
+}
+
+// Stitches chunk results, in order, into the sequential token sequence. A chunk's speculative tokens are
+// only valid if lexing really is at a token boundary at its start, i.e. the previous token ended no later.
+// Only string literals can span a newline, so when one does the affected region is re-lexed sequentially
+// until a token start coincides with a speculative one; from there lexing is deterministic and the rest of
+// the chunk is reused.
+class Stitcher {
+ public:
+  Stitcher(std::string_view source, const LexerConfig& config, std::size_t size_hint)
+      : source_(source), config_(config), stream_(source) {
+    stream_.reserve(size_hint);
+  }
+
+  void add(const ChunkTokens& chunk) {
+    if (finished_) {
+      return;
+    }
+    if (resume_ > chunk.begin) {
+      resync(chunk);
+      return;
+    }
+    const std::span<const Trivia> own =
+        chunk.tokens.empty() ? std::span<const Trivia>{chunk.trailing} : chunk.tokens.leading_trivia(0);
+    std::vector<Trivia> leading = std::move(carry_);
+    for (const Trivia& trivia : own) {
+      if (!leading.empty() && leading.back().kind == TriviaKind::Whitespace &&
+          trivia.kind == TriviaKind::Whitespace && leading.back().span.end == trivia.span.start) {
+        // One whitespace run, cut in two at the chunk boundary.
+        leading.back().span.end = trivia.span.end;
+        leading.back().text = source_.substr(leading.back().span.start, leading.back().span.length());
+        continue;
+      }
+      leading.push_back(trivia);
+    }
+    if (chunk.tokens.empty()) {
+      carry_ = std::move(leading);
+      return;
+    }
+    emit(chunk, 0, leading);
+  }
+
+  TokenStream take() { return std::move(stream_); }
+
+ private:
+  // Appends chunk tokens [first, size), giving the first one `leading` as its trivia.
+  void emit(const ChunkTokens& chunk, std::size_t first, std::span<const Trivia> leading) {
+    const Token head = chunk.tokens[first];
+    stream_.push_back(head, leading);
+    stream_.append_shifted(chunk.tokens, first + 1, chunk.tokens.size(), 0);
+    const Token tail = chunk.tokens.back();
+    resume_ = tail.span.end;
+    finished_ = tail.kind == TokenKind::EndOfFile;
+    carry_ = chunk.trailing;
+  }
+
+  // The previous token ran past the chunk start, so nothing is carried and lexing resumes at its end.
+  void resync(const ChunkTokens& chunk) {
+    Lexer lexer{source_, config_};
+    lexer.seek(resume_);
+    std::size_t candidate = 0;
+    while (true) {
+      const Token token = lexer.next();
+      if (token.kind != TokenKind::EndOfFile && token.span.start >= chunk.end) {
+        // No token of this chunk survives; what precedes the next token is carried into the next chunk.
+        carry_ = trivia_before(source_, lexer.leading_trivia(), chunk.end);
+        return;
+      }
+      while (candidate < chunk.tokens.size() && chunk.tokens[candidate].span.start < token.span.start) {
+        ++candidate;
+      }
+      if (candidate < chunk.tokens.size() && chunk.tokens[candidate].span.start == token.span.start) {
+        emit(chunk, candidate, lexer.leading_trivia());
+        return;
+      }
+      stream_.push_back(token, lexer.leading_trivia());
+      resume_ = token.span.end;
+      if (token.kind == TokenKind::EndOfFile) {
+        finished_ = true;
+        return;
+      }
+    }
+  }
+
+  std::string_view source_;
+  LexerConfig config_{};
+  TokenStream stream_;
+  // Trivia seen after the last emitted token, to lead the next one.
+  std::vector<Trivia> carry_{};
+  // End of the last emitted token: where a sequential lexer would continue.
+  std::size_t resume_{0};
+  bool finished_{false};
+};
+
+}  // namespace
+
+TokenStream lex_parallel(std::string_view source, support::ThreadPool& pool, const LexerConfig& config,
+                         std::size_t chunk_bytes) {
+  if (chunk_bytes == 0) {
+    chunk_bytes = std::max(kMinChunkBytes, source.size() / (pool.size() * kChunksPerWorker) + 1);
+  }
+  const std::vector<std::size_t> starts = chunk_starts(source, chunk_bytes);
+  if (starts.size() < 2) {
+    return lex(source, config);
+  }
+
+  std::vector<std::future<ChunkTokens>> pending{};
+  pending.reserve(starts.size());
+  for (std::size_t i = 0; i < starts.size(); ++i) {
+    const std::size_t begin = starts[i];
+    const std::size_t end = i + 1 < starts.size() ? starts[i + 1] : source.size();
+    pending.push_back(
+        pool.submit([source, begin, end, config] { return lex_chunk(source, begin, end, config); }));
+  }
+
+  Stitcher stitcher{source, config, source.size() / 6 + 1};
+  try {
+    for (auto& future : pending) {
+      stitcher.add(future.get());
+    }
+  } catch (...) {
+    // Tasks view the caller's source; none may still be running when the exception leaves.
+    for (auto& future : pending) {
+      if (future.valid()) {
+        future.wait();
+      }
+    }
+    throw;
+  }
+  return stitcher.take();
+}
+
+}  // namespace istudio::front
@@ -0,0 +1,66 @@
+#include <future>
+#include <utility>
+#include <vector>
+
+#include "front/lexer.h"
+#include "front/parser.h"
+#include "support/thread_pool.h"
+
+namespace istudio::front {
+namespace {
+
+struct ParsedFile {
+  NodeId root{0};
+  support::DiagnosticReporter reporter{};
+};
+
+// Streams tokens straight into the parser: nothing but the AST outlives the task.
+ParsedFile parse_file(std::string_view source, support::FileId file, AstContext& shard) {
+  LexerConfig config{};
+  config.capture_comments = false;
+  config.interner = shard.interner().get();
+  ParsedFile parsed{.root = 0, .reporter = support::DiagnosticReporter{file}};
+  Lexer lexer{source, config};
+  parsed.root = parse_module(lexer, shard, parsed.reporter);
+  return parsed;
+}
+
+}  // namespace
+
+AstForest parse_files(const support::SourceManager& sources, std::span<const support::FileId> files,
+                      support::ThreadPool& pool, support::DiagnosticReporter& reporter) {
+  AstForest forest{};
+  for (const support::FileId file : files) {
+    static_cast<void>(forest.add_shard(file));
+  }
+
+  std::vector<std::future<ParsedFile>> pending{};
+  pending.reserve(files.size());
+  for (std::uint32_t shard = 0; shard < files.size(); ++shard) {
+    AstContext& context = forest.shard(shard);
+    const std::string_view source = sources.text(files[shard]);
+    const support::FileId file = files[shard];
+    pending.push_back(pool.submit([source, file, &context] { return parse_file(source, file, context); }));
+  }
+
+  try {
+    for (std::uint32_t shard = 0; shard < pending.size(); ++shard) {
+      ParsedFile parsed = pending[shard].get();
+      forest.set_root(shard, parsed.root);
+      for (const support::Diagnostic& diagnostic : parsed.reporter.diagnostics()) {
+        reporter.add(diagnostic);
+      }
+    }
+  } catch (...) {
+    // Tasks fill the forest's shards; none may still be running when the exception leaves.
+    for (auto& future : pending) {
+      if (future.valid()) {
+        future.wait();
+      }
+    }
+    throw;
+  }
+  return forest;
+}
+
+}  // namespace istudio::front
@@ -1,10 +1,17 @@
 #include "front/parser.h"
 
 #include <algorithm>
+#include <array>
+#include <limits>
 #include <stdexcept>
+#include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include "front/ast_walk.h"
+#include "front/lexer.h"
+
 namespace istudio::front {
 namespace {
 
@@ -12,29 +19,87 @@ support::Span merge_span(support::Span lhs, support::Span rhs) {
   return {.start = std::min(lhs.start, rhs.start), .end = std::max(lhs.end, rhs.end)};
 }
 
-support::Span span_covering(const TokenStream& tokens) {
-  if (tokens.tokens.empty()) {
-    return {};
+struct BinaryOperator {
+  int precedence{-1};
+  bool assignment{false};
+};
+
+// Binding power of every binary operator, indexed by Punct; -1 marks punctuators that never join operands.
+// Assignments bind loosest and associate to the right.
+constexpr std::array<BinaryOperator, kPunctCount> kBinaryOperators = [] {
+  std::array<BinaryOperator, kPunctCount> table{};
+  const auto set = [&table](Punct punct, int precedence, bool assignment = false) {
+    table[static_cast<std::size_t>(punct)] = {.precedence = precedence, .assignment = assignment};
+  };
+  for (const Punct punct : {Punct::Assign, Punct::PlusAssign, Punct::MinusAssign, Punct::StarAssign,
+                            Punct::SlashAssign, Punct::PercentAssign}) {
+    set(punct, 1, true);
+  }
+  set(Punct::PipePipe, 2);
+  set(Punct::AmpAmp, 3);
+  set(Punct::EqualEqual, 4);
+  set(Punct::BangEqual, 4);
+  set(Punct::Less, 5);
+  set(Punct::Greater, 5);
+  set(Punct::LessEqual, 5);
+  set(Punct::GreaterEqual, 5);
+  set(Punct::Plus, 6);
+  set(Punct::Minus, 6);
+  set(Punct::Star, 7);
+  set(Punct::Slash, 7);
+  set(Punct::Percent, 7);
+  return table;
+}();
+
+constexpr const BinaryOperator& binary_operator(Punct punct) {
+  return kBinaryOperators[static_cast<std::size_t>(punct)];
+}
+
+support::Span shift_span(support::Span span, std::ptrdiff_t delta) {
+  return support::make_span(static_cast<std::size_t>(static_cast<std::ptrdiff_t>(span.start) + delta),
+                            static_cast<std::size_t>(static_cast<std::ptrdiff_t>(span.end) + delta));
+}
+
+void shift_subtree(AstContext& context, NodeId root, std::ptrdiff_t delta) {
+  walk_ast_post_order(context, root,
+                      [&](const AstNode& node) { context.node(node.id).span = shift_span(node.span, delta); });
+}
+
+NodeId throw_first_error(const support::DiagnosticReporter& reporter, NodeId root) {
+  if (!reporter.diagnostics().empty()) {
+    throw std::runtime_error(reporter.diagnostics().front().message);
   }
-  support::Span span = tokens.tokens.front().span;
-  span.end = tokens.tokens.back().span.end;
-  return span;
+  return root;
 }
 
 }  // namespace
 
-Parser::Parser(const TokenStream& tokens, AstContext& context)
-    : tokens_(tokens), context_(context), index_(0) {}
+Parser::Parser(const TokenStream& tokens, AstContext& context, support::DiagnosticReporter& reporter)
+    : tokens_(&tokens), context_(context), reporter_(&reporter), index_(0) {
+  fill_through(0);
+}
 
-NodeId Parser::parse_module() {
-  auto& module_ref = context_.create_node(AstKind::Module, span_covering(tokens_));
-  const NodeId module_id = module_ref.id;
+Parser::Parser(Lexer& lexer, AstContext& context, support::DiagnosticReporter& reporter)
+    : lexer_(&lexer), context_(context), reporter_(&reporter), index_(0) {
+  fill_through(0);
+}
 
-  while (!at_end() && current().kind != TokenKind::EndOfFile) {
-    NodeId stmt = parse_statement();
-    context_.node(module_id).children.push_back(stmt);
+// Containers are created after their statements, so every node follows its descendants (see
+// AstContext::is_post_ordered).
+NodeId Parser::parse_module() {
+  const support::Span first = current().span;
+  const ChildList statements = context_.begin_children();
+  while (!at_end()) {
+    if (check_symbol(Punct::RBrace)) {
+      report(support::DiagCode::ParseUnexpectedToken, "unmatched '}'", advance().span);
+      recovering_ = false;
+      continue;
+    }
+    context_.add_child(parse_statement());
   }
-
+  // The end of the module span is only known once the EndOfFile token has been pulled.
+  const NodeId module_id = context_.create_node(AstKind::Module, merge_span(first, current().span)).id;
+  context_.finish_children(module_id, statements);
   return module_id;
 }
 
@@ -42,201 +107,254 @@ NodeId Parser::parse_expression() {
   return parse_expression(1);
 }
 
+// Blocks waiting for their '}' are kept on open_blocks_ rather than the call stack, as pending_ keeps operators,
+// so statements nest as deeply as memory allows. Each statement, a block included, is added to the innermost
+// open block once finished; the outermost one is returned.
 NodeId Parser::parse_statement() {
-  if (check_keyword("let")) {
+  const std::size_t base = open_blocks_.size();
+  while (true) {
+    const std::size_t first = index_;
+    const support::Span start = current().span;
+    if (check_symbol(Punct::LBrace)) {
+      const Token open = advance();
+      open_blocks_.push_back(
+          OpenBlock{.first = first, .start = start, .open = open, .statements = context_.begin_children()});
+    } else {
+      const NodeId statement = finish_statement(first, start, parse_statement_body());
+      if (open_blocks_.size() == base) {
+        return statement;
+      }
+      context_.add_child(statement);
+    }
+
+    while (open_blocks_.size() > base && (at_end() || check_symbol(Punct::RBrace))) {
+      const OpenBlock block = open_blocks_.back();
+      open_blocks_.pop_back();
+      const Token close = consume_symbol(Punct::RBrace, "expected '}' to close block");
+      const NodeId block_id = context_.create_node(AstKind::BlockStmt, merge_span(block.open.span, close.span)).id;
+      context_.finish_children(block_id, block.statements);
+      const NodeId statement = finish_statement(block.first, block.start, block_id);
+      if (open_blocks_.size() == base) {
+        return statement;
+      }
+      context_.add_child(statement);
+    }
+  }
+}
+
+// A statement with a syntax error comes back wrapped in an Error node spanning everything up to the point
+// where parsing resumed, so later phases can skip it without reporting follow-on errors.
+NodeId Parser::finish_statement(std::size_t first, support::Span start, NodeId statement) {
+  if (!recovering_) {
+    return statement;
+  }
+  synchronize(first);
+  const support::Span end = index_ > first ? previous().span : start;
+  const NodeId error = context_.create_node(AstKind::Error, merge_span(start, end)).id;
+  context_.set_children(error, {statement});
+  return error;
+}
+
+// Any statement but a block.
+NodeId Parser::parse_statement_body() {
+  if (check_keyword(Keyword::Let)) {
     return parse_let_statement();
   }
-  if (check_keyword("return")) {
+  if (check_keyword(Keyword::Return)) {
     return parse_return_statement();
   }
-  if (check_symbol("{")) {
-    return parse_block_statement();
-  }
 
   NodeId expr = parse_expression();
-  const Token& semi = consume_symbol(";", "expected ';' after expression");
+  const Token semi = consume_symbol(Punct::Semicolon, "expected ';' after expression");
   const auto& expr_node = context_.node(expr);
-  auto& stmt = context_.create_node(AstKind::ExpressionStmt, merge_span(expr_node.span, semi.span));
-  stmt.children.push_back(expr);
-  return stmt.id;
-}
-
-NodeId Parser::parse_block_statement() {
-  const Token& open = consume_symbol("{", "expected '{'");
-  auto& block_ref = context_.create_node(AstKind::BlockStmt, open.span);
-  const NodeId block_id = block_ref.id;
-
-  while (!at_end() && !check_symbol("}")) {
-    NodeId stmt = parse_statement();
-    context_.node(block_id).children.push_back(stmt);
-  }
-
-  const Token& close = consume_symbol("}", "expected '}' to close block");
-  auto& block = context_.node(block_id);
-  block.span = merge_span(open.span, close.span);
-  return block_id;
+  const NodeId stmt = context_.create_node(AstKind::ExpressionStmt, merge_span(expr_node.span, semi.span)).id;
+  context_.set_children(stmt, {expr});
+  return stmt;
 }
 
 NodeId Parser::parse_let_statement() {
-  const Token& let_token = consume_keyword("let", "expected 'let'");
-  bool is_mutable = match_keyword("mut");
+  const Token let_token = advance();
+  bool is_mutable = match_keyword(Keyword::Mut);
 
-  const Token& ident = consume_identifier("expected identifier after 'let'");
-  auto& name_node = context_.create_node(AstKind::IdentifierExpr, ident.span, ident.lexeme);
+  NodeId name_id{};
+  if (current().kind == TokenKind::Identifier) {
+    name_id = create_identifier(advance());
+  } else {
+    report(support::DiagCode::ParseExpectedToken, "expected identifier after 'let'", current().span);
+    name_id = create_error(current().span);
+  }
 
-  consume_symbol("=", "expected '=' in let binding");
+  consume_symbol(Punct::Assign, "expected '=' in let binding");
   NodeId initializer = parse_expression();
-  const Token& semi = consume_symbol(";", "expected ';' after let binding");
+  const Token semi = consume_symbol(Punct::Semicolon, "expected ';' after let binding");
 
-  auto& let_node =
-      context_.create_node(AstKind::LetStmt, merge_span(let_token.span, semi.span), is_mutable ? "mut" : "let");
-  let_node.children.push_back(name_node.id);
-  let_node.children.push_back(initializer);
-  return let_node.id;
+  const NodeId let_id =
+      context_.create_node(AstKind::LetStmt, merge_span(let_token.span, semi.span), is_mutable ? "mut" : "let").id;
+  context_.set_children(let_id, {name_id, initializer});
+  return let_id;
 }
 
 NodeId Parser::parse_return_statement() {
-  const Token& return_token = consume_keyword("return", "expected 'return'");
-  bool has_value = !check_symbol(";");
+  const Token return_token = advance();
+  bool has_value = !check_symbol(Punct::Semicolon);
   NodeId value{};
   if (has_value) {
     value = parse_expression();
   }
-  const Token& semi = consume_symbol(";", "expected ';' after return");
+  const Token semi = consume_symbol(Punct::Semicolon, "expected ';' after return");
 
-  auto& return_node = context_.create_node(AstKind::ReturnStmt, merge_span(return_token.span, semi.span));
+  const NodeId return_id = context_.create_node(AstKind::ReturnStmt, merge_span(return_token.span, semi.span)).id;
   if (has_value) {
-    return_node.children.push_back(value);
+    context_.set_children(return_id, {value});
   }
-  return return_node.id;
+  return return_id;
 }
 
+// Operators waiting for their right operand, parentheses and argument lists waiting for their ')' are kept on
+// pending_ rather than the call stack, so nesting is bounded by memory alone. Nodes are created in the order
+// recursive descent would create them: each operand as it is parsed, each operator once its operands are done.
 NodeId Parser::parse_expression(int min_precedence) {
-  NodeId left = parse_prefix_expression();
-
-  while (!at_end()) {
-    const Token& op = current();
-    const int precedence = precedence_for(op);
-
-    if (precedence < min_precedence) {
-      break;
+  const std::size_t base = pending_.size();
+  while (true) {
+    // An operand: prefix operators, then a parenthesized expression or a primary one.
+    while (is_unary_prefix(current())) {
+      pending_.push_back(
+          PendingOperator{.kind = PendingKind::Prefix, .op = advance(), .min_precedence = min_precedence});
+      min_precedence = kPrefixPrecedence;
     }
-
-    if (op.kind != TokenKind::Symbol) {
-      break;
+    if (check_symbol(Punct::LParen)) {
+      pending_.push_back(
+          PendingOperator{.kind = PendingKind::Group, .op = advance(), .min_precedence = min_precedence});
+      min_precedence = 1;
+      continue;
     }
+    NodeId operand = parse_primary_expression();
+    // Calls apply directly to a primary, parenthesized or call expression, never to an operator's result.
+    bool callable = true;
+
+    // Fold the operand into the pending operators until one of them needs another operand.
+    bool needs_operand = false;
+    while (!needs_operand) {
+      if (callable && !at_end() && match_symbol(Punct::LParen)) {
+        const ChildList arguments = context_.begin_children();
+        context_.add_child(operand);
+        if (check_symbol(Punct::RParen)) {
+          operand = finish_call(context_.node(operand).span, arguments);
+          continue;
+        }
+        pending_.push_back(PendingOperator{.kind = PendingKind::Call,
+                                           .callee_span = context_.node(operand).span,
+                                           .arguments = arguments,
+                                           .min_precedence = min_precedence});
+        min_precedence = 1;
+        needs_operand = true;
+        continue;
+      }
 
-    advance();
-    const bool is_assignment = is_assignment_operator(op);
-    const int next_precedence = is_assignment ? precedence : precedence + 1;
-    NodeId right = parse_expression(next_precedence);
-
-    const auto& left_node = context_.node(left);
-    const auto& right_node = context_.node(right);
-    support::Span span = merge_span(left_node.span, right_node.span);
+      const Token op = current();
+      const int precedence = precedence_for(op);
+      if (!at_end() && precedence >= min_precedence) {
+        advance();
+        pending_.push_back(
+            PendingOperator{.kind = PendingKind::Binary, .op = op, .left = operand, .min_precedence = min_precedence});
+        min_precedence = is_assignment_operator(op) ? precedence : precedence + 1;
+        needs_operand = true;
+        continue;
+      }
 
-    AstKind kind = is_assignment ? AstKind::AssignmentExpr : AstKind::BinaryExpr;
-    auto& expr = context_.create_node(kind, span, op.lexeme);
-    expr.children.push_back(left);
-    expr.children.push_back(right);
-    left = expr.id;
+      if (pending_.size() == base) {
+        return operand;
+      }
+      const PendingOperator pending = pending_.back();
+      pending_.pop_back();
+      min_precedence = pending.min_precedence;
+      switch (pending.kind) {
+        case PendingKind::Binary: {
+          const support::Span span = merge_span(context_.node(pending.left).span, context_.node(operand).span);
+          const AstKind kind = is_assignment_operator(pending.op) ? AstKind::AssignmentExpr : AstKind::BinaryExpr;
+          const NodeId expr = context_.create_node(kind, span, pending.op.lexeme).id;
+          context_.set_children(expr, {pending.left, operand});
+          operand = expr;
+          callable = false;
+          break;
+        }
+        case PendingKind::Prefix: {
+          const support::Span span = merge_span(pending.op.span, context_.node(operand).span);
+          const NodeId expr = context_.create_node(AstKind::UnaryExpr, span, pending.op.lexeme).id;
+          context_.set_children(expr, {operand});
+          operand = expr;
+          callable = false;
+          break;
+        }
+        case PendingKind::Group: {
+          const Token closing = consume_symbol(Punct::RParen, "expected ')' after expression");
+          const NodeId group = context_.create_node(AstKind::GroupExpr, merge_span(pending.op.span, closing.span)).id;
+          context_.set_children(group, {operand});
+          operand = group;
+          callable = true;
+          break;
+        }
+        case PendingKind::Call:
+          context_.add_child(operand);
+          if (match_symbol(Punct::Comma)) {
+            pending_.push_back(pending);
+            min_precedence = 1;
+            needs_operand = true;
+            break;
+          }
+          operand = finish_call(pending.callee_span, pending.arguments);
+          callable = true;
+          break;
+      }
+    }
   }
-
-  return left;
 }
 
-NodeId Parser::parse_prefix_expression() {
-  if (at_end()) {
-    throw std::runtime_error("unexpected end of input");
+// Names reuse the lexer's symbol; the lexer must intern into the AST context's interner.
+NodeId Parser::create_identifier(const Token& token) {
+  support::Symbol symbol = token.symbol;
+  if (symbol == support::kNoSymbol && context_.interner() != nullptr) {
+    symbol = context_.interner()->intern(token.lexeme);
   }
-
-  const Token& token = current();
-  if (is_unary_prefix(token)) {
-    const Token& op = advance();
-    NodeId operand = parse_expression(precedence_for(op));
-    const auto& operand_node = context_.node(operand);
-    support::Span span = merge_span(op.span, operand_node.span);
-    auto& expr = context_.create_node(AstKind::UnaryExpr, span, op.lexeme);
-    expr.children.push_back(operand);
-    return expr.id;
-  }
-
-  NodeId primary = parse_primary_expression();
-  const auto& primary_node = context_.node(primary);
-  return parse_call_expression(primary, primary_node.span);
+  return context_.create_node(AstKind::IdentifierExpr, token.span, token.lexeme, symbol).id;
 }
 
 NodeId Parser::parse_primary_expression() {
-  if (at_end()) {
-    throw std::runtime_error("unexpected end of input");
-  }
-
-  const Token& token = advance();
+  const Token token = current();
   switch (token.kind) {
-    case TokenKind::Identifier: {
-      auto& node = context_.create_node(AstKind::IdentifierExpr, token.span, token.lexeme);
-      return node.id;
-    }
+    case TokenKind::Identifier:
+      return create_identifier(advance());
     case TokenKind::Number:
-    case TokenKind::StringLiteral: {
-      auto& node = context_.create_node(AstKind::LiteralExpr, token.span, token.lexeme);
-      return node.id;
-    }
-    case TokenKind::Keyword: {
-      auto& node = context_.create_node(AstKind::LiteralExpr, token.span, token.lexeme);
-      return node.id;
-    }
-    case TokenKind::Symbol: {
-      if (token.lexeme == "(") {
-        NodeId expr = parse_expression();
-        const Token& closing = consume_symbol(")", "expected ')' after expression");
-        support::Span span = merge_span(token.span, closing.span);
-        auto& group = context_.create_node(AstKind::GroupExpr, span);
-        group.children.push_back(expr);
-        return group.id;
-      }
-      break;
-    }
+    case TokenKind::StringLiteral:
+    case TokenKind::Keyword:
+      return context_.create_node(AstKind::LiteralExpr, advance().span, token.lexeme).id;
     default:
       break;
   }
 
-  throw std::runtime_error("unexpected token in primary expression");
+  // The offending token is left for synchronize() to skip, so a ';' or '}' still ends the statement.
+  if (token.punct == Punct::Other) {
+    report(support::DiagCode::LexUnknownToken, "unknown character '" + std::string(token.lexeme) + "'", token.span);
+  } else {
+    report(support::DiagCode::ParseExpectedExpression, "expected expression", token.span);
+  }
+  return create_error(token.span);
 }
 
-NodeId Parser::parse_call_expression(NodeId callee, support::Span callee_span) {
-  NodeId current_callee = callee;
-  support::Span current_span = callee_span;
-
-  while (!at_end()) {
-    if (match_symbol("(")) {
-      std::vector<NodeId> args{};
-      if (!check_symbol(")")) {
-        do {
-          NodeId expr = parse_expression();
-          args.push_back(expr);
-        } while (match_symbol(","));
-      }
-
-      const Token& close = consume_symbol(")", "expected ')' after arguments");
-      support::Span span = merge_span(current_span, close.span);
-      auto& call = context_.create_node(AstKind::CallExpr, span);
-      call.children.push_back(current_callee);
-      for (auto arg : args) {
-        call.children.push_back(arg);
-      }
-
-      current_callee = call.id;
-      current_span = span;
-      continue;
-    }
-    break;
-  }
+// Empty and placed where the missing construct was expected, so it does not overlap the token left behind.
+NodeId Parser::create_error(support::Span at) {
+  return context_.create_node(AstKind::Error, support::make_span(at.start, at.start)).id;
+}
 
-  return current_callee;
+// The callee and arguments are the innermost unfinished child list.
+NodeId Parser::finish_call(support::Span callee_span, ChildList arguments) {
+  const Token close = consume_symbol(Punct::RParen, "expected ')' after arguments");
+  const NodeId call = context_.create_node(AstKind::CallExpr, merge_span(callee_span, close.span)).id;
+  context_.finish_children(call, arguments);
+  return call;
 }
 
-bool Parser::match_keyword(std::string_view keyword) {
+bool Parser::match_keyword(Keyword keyword) {
   if (check_keyword(keyword)) {
     advance();
     return true;
@@ -244,29 +362,11 @@ bool Parser::match_keyword(std::string_view keyword) {
   return false;
 }
 
-bool Parser::check_keyword(std::string_view keyword) const {
-  if (at_end()) {
-    return false;
-  }
-  const Token& token = current();
-  return token.kind == TokenKind::Keyword && token.lexeme == keyword;
-}
-
-const Token& Parser::consume_keyword(std::string_view keyword, std::string_view message) {
-  if (!check_keyword(keyword)) {
-    throw std::runtime_error(std::string(message));
-  }
-  return advance();
-}
-
-const Token& Parser::consume_identifier(std::string_view message) {
-  if (at_end() || current().kind != TokenKind::Identifier) {
-    throw std::runtime_error(std::string(message));
-  }
-  return advance();
+bool Parser::check_keyword(Keyword keyword) const {
+  return !at_end() && current().keyword == keyword;
 }
 
-bool Parser::match_symbol(std::string_view symbol) {
+bool Parser::match_symbol(Punct symbol) {
   if (check_symbol(symbol)) {
     advance();
     return true;
@@ -274,99 +374,316 @@ bool Parser::match_symbol(std::string_view symbol) {
   return false;
 }
 
-bool Parser::check_symbol(std::string_view symbol) const {
-  if (at_end()) {
-    return false;
-  }
-  const Token& token = current();
-  return token.kind == TokenKind::Symbol && token.lexeme == symbol;
+bool Parser::check_symbol(Punct symbol) const {
+  return !at_end() && current().punct == symbol;
 }
 
-const Token& Parser::consume_symbol(std::string_view symbol, std::string_view message) {
+// On a mismatch the error is reported, nothing is consumed and the last consumed token stands in for the
+// missing one, so spans stop where the input did.
+Token Parser::consume_symbol(Punct symbol, std::string_view message) {
   if (!check_symbol(symbol)) {
-    throw std::runtime_error(std::string(message));
+    report(support::DiagCode::ParseExpectedToken, message, current().span);
+    return previous();
   }
   return advance();
 }
 
-const Token& Parser::advance() {
+// Only the first error of a statement is reported; the rest are usually consequences of it.
+void Parser::report(support::DiagCode code, std::string_view message, support::Span span) {
+  if (!recovering_) {
+    reporter_->report(code, std::string(message), span);
+    recovering_ = true;
+  }
+}
+
+// Skips the rest of a broken statement: through the next ';', or up to the '}' closing the enclosing block or
+// a keyword that starts a new statement. Braces opened while skipping are skipped with their contents.
+void Parser::synchronize(std::size_t first) {
+  recovering_ = false;
+  if (index_ > first && previous().punct == Punct::Semicolon) {
+    return;
+  }
+  std::size_t depth = 0;
+  while (!at_end()) {
+    const Token& token = window_at(index_);
+    if (token.punct == Punct::Semicolon && depth == 0) {
+      advance();
+      return;
+    }
+    if (token.punct == Punct::RBrace) {
+      if (depth == 0) {
+        return;
+      }
+      --depth;
+    } else if (token.punct == Punct::LBrace) {
+      ++depth;
+    } else if (depth == 0 && (token.keyword == Keyword::Let || token.keyword == Keyword::Return)) {
+      return;
+    }
+    advance();
+  }
+}
+
+Token Parser::advance() {
   if (!at_end()) {
     ++index_;
+    fill_through(index_);
   }
   return previous();
 }
 
-const Token& Parser::current() const {
-  return tokens_.tokens[index_];
+Token Parser::current() const {
+  return window_at(index_);
 }
 
-const Token& Parser::peek(std::size_t offset) const {
-  const std::size_t position = std::min(tokens_.tokens.size() - 1, index_ + offset);
-  return tokens_.tokens[position];
+Token Parser::peek(std::size_t offset) const {
+  const std::size_t position = index_ + std::min(offset, kMaxLookahead);
+  fill_through(position);
+  return window_at(position);
 }
 
-const Token& Parser::previous() const {
-  const std::size_t position = index_ == 0 ? 0 : index_ - 1;
-  return tokens_.tokens[position];
+Token Parser::previous() const {
+  return window_at(index_ == 0 ? 0 : index_ - 1);
 }
 
 bool Parser::at_end() const {
-  return index_ >= tokens_.tokens.size() || current().kind == TokenKind::EndOfFile;
+  return window_at(index_).kind == TokenKind::EndOfFile;
 }
 
-int Parser::precedence_for(const Token& token) const {
-  if (token.kind != TokenKind::Symbol) {
-    return -1;
+const Token& Parser::window_at(std::size_t index) const {
+  return window_[index % kWindowSize];
+}
+
+void Parser::fill_through(std::size_t index) const {
+  while (loaded_ <= index) {
+    window_[loaded_ % kWindowSize] = pull_token();
+    ++loaded_;
+  }
+}
+
+Token Parser::pull_token() const {
+  if (lexer_ != nullptr) {
+    return lexer_->next();
+  }
+  if (loaded_ < tokens_->size()) {
+    return (*tokens_)[loaded_];
   }
+  // Past the end of a materialized stream (or an empty one) keep yielding EndOfFile.
+  const std::uint32_t end = tokens_->empty() ? 0 : tokens_->back().span.end;
+  return Token{.kind = TokenKind::EndOfFile, .lexeme = {}, .span = support::make_span(end, end)};
+}
 
-  const std::string& symbol = token.lexeme;
-  if (symbol == "=") {
-    return 1;
+// Descends to the innermost block holding the edit strictly inside its braces, reparses the statements there
+// and, if that block's closing brace no longer lines up, retries one level further out.
+NodeId Parser::reparse_module(NodeId module, const SourceEdit& edit,
+                              std::span<const support::Diagnostic> previous_diagnostics) {
+  if (tokens_ == nullptr) {
+    throw std::logic_error("incremental reparsing needs a materialized token stream");
+  }
+  const auto delta = static_cast<std::ptrdiff_t>(edit.text.size()) - static_cast<std::ptrdiff_t>(edit.range.length());
+
+  std::vector<NodeId> path{module};
+  while (true) {
+    const std::span<const NodeId> children = context_.node(path.back()).children;
+    const auto touched = std::partition_point(children.begin(), children.end(), [&](NodeId child) {
+      return context_.node(child).span.end < edit.range.start;
+    });
+    if (touched == children.end()) {
+      break;
+    }
+    const AstNode& candidate = context_.node(*touched);
+    if (candidate.kind != AstKind::BlockStmt || candidate.span.start >= edit.range.start ||
+        candidate.span.end <= edit.range.end) {
+      break;
+    }
+    path.push_back(*touched);
   }
-  if (symbol == "||") {
-    return 2;
+
+  support::DiagnosticReporter* const target = reporter_;
+  support::DiagnosticReporter fresh{};
+  ReparsedRange range{};
+  while (true) {
+    fresh = support::DiagnosticReporter{};
+    reporter_ = &fresh;
+    if (reparse_statements(path.back(), edit, delta, range)) {
+      break;
+    }
+    path.pop_back();
+  }
+  reporter_ = target;
+
+  // Ancestors end past the edit, and so does everything after the reparsed block in each of them.
+  for (std::size_t level = path.size() - 1; level-- > 0;) {
+    AstNode& ancestor = context_.node(path[level]);
+    ancestor.span.end = shift_span(ancestor.span, delta).end;
+    const std::span<const NodeId> siblings = ancestor.children;
+    const auto after = std::find(siblings.begin(), siblings.end(), path[level + 1]) + 1;
+    for (auto sibling = after; sibling < siblings.end(); ++sibling) {
+      shift_subtree(context_, *sibling, delta);
+    }
   }
-  if (symbol == "&&") {
-    return 3;
+
+  for (const support::Diagnostic& diagnostic : previous_diagnostics) {
+    if (diagnostic.span.start < range.start) {
+      reporter_->report(diagnostic.code, diagnostic.message, diagnostic.span);
+    }
   }
-  if (symbol == "==" || symbol == "!=") {
-    return 4;
+  for (const support::Diagnostic& diagnostic : fresh.diagnostics()) {
+    reporter_->report(diagnostic.code, diagnostic.message, diagnostic.span);
   }
-  if (symbol == "<" || symbol == ">" || symbol == "<=" || symbol == ">=") {
-    return 5;
+  for (const support::Diagnostic& diagnostic : previous_diagnostics) {
+    if (diagnostic.span.start > range.end) {
+      reporter_->report(diagnostic.code, diagnostic.message, shift_span(diagnostic.span, delta));
+    }
+  }
+  return module;
+}
+
+// Reparses the statements of `container` (a block or the module) from the first one the edit may have changed.
+// Statements ending before the edit keep their nodes, except a trailing Error: where its recovery stopped
+// depended on the tokens after it. Parsing stops early once it reaches, at the same depth, the shifted start of
+// an old statement past the edit: lexing from a token boundary over unchanged bytes yields unchanged tokens,
+// so that statement and all that follow it are reused. Returns false, leaving `container` unusable, if the
+// block's closing brace moved.
+bool Parser::reparse_statements(NodeId container, const SourceEdit& edit, std::ptrdiff_t delta,
+                                ReparsedRange& range) {
+  const bool is_module = context_.node(container).kind == AstKind::Module;
+  const support::Span old_span = context_.node(container).span;
+  const std::span<const NodeId> old_children = context_.node(container).children;
+
+  std::size_t kept = static_cast<std::size_t>(
+      std::partition_point(old_children.begin(), old_children.end(),
+                           [&](NodeId child) { return context_.node(child).span.end < edit.range.start; }) -
+      old_children.begin());
+  while (kept > 0 && context_.node(old_children[kept - 1]).kind == AstKind::Error) {
+    --kept;
+  }
+  range.start = kept > 0 ? context_.node(old_children[kept - 1]).span.end : (is_module ? 0 : old_span.start + 1);
+  range.end = std::numeric_limits<std::size_t>::max();
+  recovering_ = false;
+  seek(tokens_->first_at(range.start));
+
+  const ChildList statements = context_.begin_children();
+  for (std::size_t i = 0; i < kept; ++i) {
+    context_.add_child(old_children[i]);
+  }
+  const auto shifted_start = [&](std::size_t index) {
+    return static_cast<std::ptrdiff_t>(context_.node(old_children[index]).span.start) + delta;
+  };
+  std::size_t candidate = kept;
+  bool resumed = false;
+  while (!at_end()) {
+    if (check_symbol(Punct::RBrace)) {
+      if (!is_module) {
+        break;
+      }
+      report(support::DiagCode::ParseUnexpectedToken, "unmatched '}'", advance().span);
+      recovering_ = false;
+      continue;
+    }
+    const auto position = static_cast<std::ptrdiff_t>(current().span.start);
+    while (candidate < old_children.size() && (context_.node(old_children[candidate]).span.start < edit.range.end ||
+                                               shifted_start(candidate) < position)) {
+      ++candidate;
+    }
+    if (candidate < old_children.size() && shifted_start(candidate) == position &&
+        context_.node(old_children[candidate]).kind != AstKind::Error) {
+      resumed = true;
+      range.end = context_.node(old_children[candidate]).span.start;
+      for (std::size_t i = candidate; i < old_children.size(); ++i) {
+        shift_subtree(context_, old_children[i], delta);
+        context_.add_child(old_children[i]);
+      }
+      break;
+    }
+    context_.add_child(parse_statement());
   }
-  if (symbol == "+" || symbol == "-") {
-    return 6;
+  context_.finish_children(container, statements);
+
+  if (is_module) {
+    context_.node(container).span = merge_span(tokens_->front().span, tokens_->back().span);
+    return true;
   }
-  if (symbol == "*" || symbol == "/" || symbol == "%") {
-    return 7;
+  if (!resumed) {
+    // The block's own '}' must still close it; otherwise the edit changed how braces pair up.
+    const std::ptrdiff_t old_close = static_cast<std::ptrdiff_t>(old_span.end) - 1;
+    if (!check_symbol(Punct::RBrace) || static_cast<std::ptrdiff_t>(current().span.start) != old_close + delta) {
+      return false;
+    }
+    range.end = old_span.end - 1;
   }
-  return -1;
+  context_.node(container).span.end = shift_span(old_span, delta).end;
+  return true;
+}
+
+void Parser::seek(std::size_t index) {
+  index_ = index;
+  // Reload the window from the token before `index`, so previous() is valid straight away.
+  loaded_ = index == 0 ? 0 : index - 1;
+  fill_through(index);
+}
+
+int Parser::precedence_for(const Token& token) const {
+  return binary_operator(token.punct).precedence;
 }
 
 bool Parser::is_assignment_operator(const Token& token) const {
-  return token.kind == TokenKind::Symbol && (token.lexeme == "=" || token.lexeme == "+=" || token.lexeme == "-=" ||
-                                             token.lexeme == "*=" || token.lexeme == "/=");
+  return binary_operator(token.punct).assignment;
 }
 
 bool Parser::is_unary_prefix(const Token& token) const {
-  if (token.kind == TokenKind::Symbol) {
-    return token.lexeme == "!" || token.lexeme == "-" || token.lexeme == "+";
-  }
-  if (token.kind == TokenKind::Keyword) {
-    return token.lexeme == "await";
-  }
-  return false;
+  return token.punct == Punct::Bang || token.punct == Punct::Minus || token.punct == Punct::Plus;
 }
 
-NodeId parse_module(const TokenStream& tokens, AstContext& context) {
-  Parser parser(tokens, context);
+NodeId parse_module(const TokenStream& tokens, AstContext& context, support::DiagnosticReporter& reporter) {
+  context.reserve_for_tokens(tokens.size());
+  Parser parser(tokens, context, reporter);
   return parser.parse_module();
 }
 
-NodeId parse_expression(const TokenStream& tokens, AstContext& context) {
-  Parser parser(tokens, context);
+NodeId parse_expression(const TokenStream& tokens, AstContext& context, support::DiagnosticReporter& reporter) {
+  Parser parser(tokens, context, reporter);
+  return parser.parse_expression();
+}
+
+// Tokens are not counted up front, so they are estimated from a sample of the input; a module past the estimate
+// just grows.
+NodeId parse_module(Lexer& lexer, AstContext& context, support::DiagnosticReporter& reporter) {
+  context.reserve_for_tokens(lexer.estimate_remaining_tokens());
+  Parser parser(lexer, context, reporter);
+  return parser.parse_module();
+}
+
+NodeId parse_expression(Lexer& lexer, AstContext& context, support::DiagnosticReporter& reporter) {
+  Parser parser(lexer, context, reporter);
   return parser.parse_expression();
 }
 
+NodeId reparse_module(const TokenStream& tokens, AstContext& context, NodeId module, const SourceEdit& edit,
+                      std::span<const support::Diagnostic> previous_diagnostics,
+                      support::DiagnosticReporter& reporter) {
+  Parser parser(tokens, context, reporter);
+  return parser.reparse_module(module, edit, previous_diagnostics);
+}
+
+NodeId parse_module(const TokenStream& tokens, AstContext& context) {
+  support::DiagnosticReporter reporter{};
+  return throw_first_error(reporter, parse_module(tokens, context, reporter));
+}
+
+NodeId parse_expression(const TokenStream& tokens, AstContext& context) {
+  support::DiagnosticReporter reporter{};
+  return throw_first_error(reporter, parse_expression(tokens, context, reporter));
+}
+
+NodeId parse_module(Lexer& lexer, AstContext& context) {
+  support::DiagnosticReporter reporter{};
+  return throw_first_error(reporter, parse_module(lexer, context, reporter));
+}
+
+NodeId parse_expression(Lexer& lexer, AstContext& context) {
+  support::DiagnosticReporter reporter{};
+  return throw_first_error(reporter, parse_expression(lexer, context, reporter));
+}
+
 }  // namespace istudio::front
@@ -1,54 +1,148 @@
 #pragma once
 
+#include <array>
 #include <cstddef>
+#include <cstdint>
+#include <span>
 #include <string_view>
+#include <vector>
 
 #include "front/ast.h"
+#include "front/ast_forest.h"
 #include "front/token.h"
+#include "support/diagnostics.h"
+
+namespace istudio::support {
+class ThreadPool;
+}  // namespace istudio::support
 
 namespace istudio::front {
 
+class Lexer;
+struct SourceEdit;
+
+// Syntax errors never throw: each is reported to `reporter`, the offending construct becomes an AstKind::Error
+// node and parsing resumes at the next ';' or '}', so one pass reports every error in the input.
 class Parser {
  public:
-  Parser(const TokenStream& tokens, AstContext& context);
+  Parser(const TokenStream& tokens, AstContext& context, support::DiagnosticReporter& reporter);
+  // Streaming mode: tokens are pulled from `lexer` on demand, so only the lookahead window is ever held.
+  Parser(Lexer& lexer, AstContext& context, support::DiagnosticReporter& reporter);
 
   NodeId parse_module();
   NodeId parse_expression();
+  // Incremental mode, for materialized streams only: `module` was parsed into this parser's context from the
+  // source that `edit` turned into the one the tokens were lexed from (typically by relex()). Only the
+  // statements the edit may have changed, within the innermost block containing it, are parsed again; all
+  // others keep their nodes and NodeIds, with spans moved past the edit. Nodes replaced are left unreferenced
+  // in the context. `previous_diagnostics` are those of the previous parse: the ones outside the reparsed
+  // statements are reported again, shifted, so the reporter ends up with what a full parse would report.
+  NodeId reparse_module(NodeId module, const SourceEdit& edit,
+                        std::span<const support::Diagnostic> previous_diagnostics);
 
  private:
+  // Byte range of the old source whose statements were parsed afresh.
+  struct ReparsedRange {
+    std::size_t start{0};
+    std::size_t end{0};
+  };
+
   NodeId parse_statement();
-  NodeId parse_block_statement();
+  NodeId finish_statement(std::size_t first, support::Span start, NodeId statement);
+  NodeId parse_statement_body();
+  bool reparse_statements(NodeId container, const SourceEdit& edit, std::ptrdiff_t delta, ReparsedRange& range);
   NodeId parse_let_statement();
   NodeId parse_return_statement();
   NodeId parse_expression(int min_precedence);
-  NodeId parse_prefix_expression();
   NodeId parse_primary_expression();
-  NodeId parse_call_expression(NodeId callee, support::Span callee_span);
-
-  bool match_keyword(std::string_view keyword);
-  bool check_keyword(std::string_view keyword) const;
-  const Token& consume_keyword(std::string_view keyword, std::string_view message);
-  const Token& consume_identifier(std::string_view message);
-  bool match_symbol(std::string_view symbol);
-  bool check_symbol(std::string_view symbol) const;
-  const Token& consume_symbol(std::string_view symbol, std::string_view message);
-
-  const Token& advance();
-  const Token& current() const;
-  const Token& peek(std::size_t offset) const;
-  const Token& previous() const;
+  NodeId finish_call(support::Span callee_span, ChildList arguments);
+  NodeId create_identifier(const Token& token);
+  NodeId create_error(support::Span at);
+
+  bool match_keyword(Keyword keyword);
+  bool check_keyword(Keyword keyword) const;
+  bool match_symbol(Punct symbol);
+  bool check_symbol(Punct symbol) const;
+  Token consume_symbol(Punct symbol, std::string_view message);
+  void report(support::DiagCode code, std::string_view message, support::Span span);
+  void synchronize(std::size_t first);
+
+  Token advance();
+  Token current() const;
+  Token peek(std::size_t offset) const;
+  Token previous() const;
   bool at_end() const;
+  void seek(std::size_t index);
 
+  // Operator tests read the token's pre-classified Punct code; no lexeme is compared.
   int precedence_for(const Token& token) const;
   bool is_assignment_operator(const Token& token) const;
   bool is_unary_prefix(const Token& token) const;
 
-  const TokenStream& tokens_;
+  // Prefix operators bind tighter than every binary operator: -a * b is (-a) * b.
+  static constexpr int kPrefixPrecedence = 8;
+
+  enum class PendingKind : std::uint8_t { Binary, Prefix, Group, Call };
+  // A construct parse_expression has started but not finished. `min_precedence` is the binding power the
+  // expression around it was parsed at, restored once it is finished.
+  struct PendingOperator {
+    PendingKind kind{PendingKind::Binary};
+    // The operator for Binary and Prefix, the '(' for Group.
+    Token op{};
+    NodeId left{0};
+    support::Span callee_span{};
+    ChildList arguments{};
+    int min_precedence{1};
+  };
+
+  // A block parse_statement has opened but not closed. `first` and `start` are where its statement began.
+  struct OpenBlock {
+    std::size_t first{0};
+    support::Span start{};
+    Token open{};
+    ChildList statements{};
+  };
+
+  // Tokens flow through a ring buffer holding the previous token, the current one and up to kMaxLookahead
+  // further tokens, whether they come from a materialized TokenStream or a Lexer.
+  static constexpr std::size_t kWindowSize = 8;
+  static constexpr std::size_t kMaxLookahead = kWindowSize - 2;
+
+  const Token& window_at(std::size_t index) const;
+  void fill_through(std::size_t index) const;
+  Token pull_token() const;
+
+  const TokenStream* tokens_{nullptr};
+  Lexer* lexer_{nullptr};
   AstContext& context_;
+  support::DiagnosticReporter* reporter_;
+  // Set by the first error in a statement and cleared once parsing has resynchronized.
+  bool recovering_{false};
+  std::vector<PendingOperator> pending_{};
+  std::vector<OpenBlock> open_blocks_{};
   std::size_t index_{0};
+  mutable std::array<Token, kWindowSize> window_{};
+  mutable std::size_t loaded_{0};
 };
 
+NodeId parse_module(const TokenStream& tokens, AstContext& context, support::DiagnosticReporter& reporter);
+NodeId parse_expression(const TokenStream& tokens, AstContext& context, support::DiagnosticReporter& reporter);
+NodeId parse_module(Lexer& lexer, AstContext& context, support::DiagnosticReporter& reporter);
+NodeId parse_expression(Lexer& lexer, AstContext& context, support::DiagnosticReporter& reporter);
+
+NodeId reparse_module(const TokenStream& tokens, AstContext& context, NodeId module, const SourceEdit& edit,
+                      std::span<const support::Diagnostic> previous_diagnostics, support::DiagnosticReporter& reporter);
+
+// Lexes and parses `files` concurrently on `pool`, `files[i]` into shard i of the returned forest, interning
+// names in the forest's interner. Syntax errors reach `reporter` attributed to their file, in file order, just
+// as parsing the files one after another would report them.
+AstForest parse_files(const support::SourceManager& sources, std::span<const support::FileId> files,
+                      support::ThreadPool& pool, support::DiagnosticReporter& reporter);
+
+// Without a reporter the first syntax error is thrown as std::runtime_error once the whole input is parsed.
 NodeId parse_module(const TokenStream& tokens, AstContext& context);
 NodeId parse_expression(const TokenStream& tokens, AstContext& context);
+NodeId parse_module(Lexer& lexer, AstContext& context);
+NodeId parse_expression(Lexer& lexer, AstContext& context);
 
 }  // namespace istudio::front
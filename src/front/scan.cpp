@@ -0,0 +1,349 @@
+#include "front/scan.h"
+
+#include <bit>
+#include <cstdint>
+
+#include "front/lexer_tables.h"
+
+// SSE2 is only assumed on x86-64, where it is part of the baseline ISA.
+#if defined(__x86_64__) || defined(_M_X64)
+#define ISTUDIO_SCAN_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(ISTUDIO_SCAN_X86) && (defined(__GNUC__) || defined(__clang__))
+#define ISTUDIO_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define ISTUDIO_TARGET_AVX2
+#endif
+
+namespace istudio::front {
+namespace {
+
+constexpr bool is_space_byte(unsigned char ch) noexcept {
+  return (kCharClassTable[ch] & kCharSpace) != 0;
+}
+
+constexpr bool is_identifier_byte(unsigned char ch) noexcept {
+  return (kCharClassTable[ch] & kCharIdentContinue) != 0;
+}
+
+std::size_t scalar_skip_whitespace(const char* data, std::size_t size, std::size_t pos) noexcept {
+  while (pos < size && is_space_byte(static_cast<unsigned char>(data[pos]))) {
+    ++pos;
+  }
+  return pos;
+}
+
+std::size_t scalar_skip_identifier(const char* data, std::size_t size, std::size_t pos) noexcept {
+  while (pos < size && is_identifier_byte(static_cast<unsigned char>(data[pos]))) {
+    ++pos;
+  }
+  return pos;
+}
+
+std::size_t scalar_find_newline(const char* data, std::size_t size, std::size_t pos) noexcept {
+  while (pos < size && data[pos] != '\n') {
+    ++pos;
+  }
+  return pos;
+}
+
+std::size_t scalar_count_newlines_from(const char* data, std::size_t size, std::size_t pos) noexcept {
+  std::size_t count = 0;
+  for (; pos < size; ++pos) {
+    if (data[pos] == '\n') {
+      ++count;
+    }
+  }
+  return count;
+}
+
+void scalar_collect_line_starts_from(const char* data, std::size_t size, std::size_t pos, std::uint32_t* out) noexcept {
+  for (; pos < size; ++pos) {
+    if (data[pos] == '\n') {
+      *out++ = static_cast<std::uint32_t>(pos + 1);
+    }
+  }
+}
+
+std::size_t scalar_count_newlines(const char* data, std::size_t size) noexcept {
+  return scalar_count_newlines_from(data, size, 0);
+}
+
+void scalar_collect_line_starts(const char* data, std::size_t size, std::uint32_t* out) noexcept {
+  scalar_collect_line_starts_from(data, size, 0, out);
+}
+
+#if defined(ISTUDIO_SCAN_X86)
+
+// Appends `block + bit + 1` for every set bit of a newline hit mask.
+std::uint32_t* emit_line_starts(std::uint32_t hits, std::size_t block, std::uint32_t* out) noexcept {
+  while (hits != 0) {
+    *out++ = static_cast<std::uint32_t>(block + static_cast<std::size_t>(std::countr_zero(hits)) + 1);
+    hits &= hits - 1;
+  }
+  return out;
+}
+
+// Each vector helper returns a byte mask with 0xFF in lanes that belong to the run being scanned.
+
+__m128i sse2_in_range(__m128i bytes, char low, char span) noexcept {
+  const __m128i shifted = _mm_sub_epi8(bytes, _mm_set1_epi8(low));
+  return _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(span)), shifted);
+}
+
+__m128i sse2_space_mask(__m128i bytes) noexcept {
+  return _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')), sse2_in_range(bytes, '\t', '\r' - '\t'));
+}
+
+__m128i sse2_identifier_mask(__m128i bytes) noexcept {
+  const __m128i lower = _mm_or_si128(bytes, _mm_set1_epi8(0x20));
+  const __m128i alpha = sse2_in_range(lower, 'a', 'z' - 'a');
+  const __m128i digit = sse2_in_range(bytes, '0', '9' - '0');
+  const __m128i underscore = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('_'));
+  return _mm_or_si128(_mm_or_si128(alpha, digit), underscore);
+}
+
+template <typename MaskFn>
+std::size_t sse2_skip_run(const char* data, std::size_t size, std::size_t pos, MaskFn mask_fn) noexcept {
+  while (pos + 16 <= size) {
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+    const auto in_run = static_cast<std::uint32_t>(_mm_movemask_epi8(mask_fn(bytes)));
+    if (in_run != 0xFFFFu) {
+      return pos + static_cast<std::size_t>(std::countr_one(in_run));
+    }
+    pos += 16;
+  }
+  return pos;
+}
+
+// Most runs between tokens are a single byte, so the vector kernels first check the leading byte(s) with
+// scalar code and only pay for vector setup on longer runs.
+std::size_t sse2_skip_whitespace(const char* data, std::size_t size, std::size_t pos) noexcept {
+  if (pos + 1 >= size || !is_space_byte(static_cast<unsigned char>(data[pos + 1]))) {
+    return scalar_skip_whitespace(data, size, pos);
+  }
+  pos = sse2_skip_run(data, size, pos, sse2_space_mask);
+  return scalar_skip_whitespace(data, size, pos);
+}
+
+std::size_t sse2_skip_identifier(const char* data, std::size_t size, std::size_t pos) noexcept {
+  if (pos >= size || !is_identifier_byte(static_cast<unsigned char>(data[pos]))) {
+    return pos;
+  }
+  pos = sse2_skip_run(data, size, pos, sse2_identifier_mask);
+  return scalar_skip_identifier(data, size, pos);
+}
+
+std::size_t sse2_find_newline(const char* data, std::size_t size, std::size_t pos) noexcept {
+  const __m128i newline = _mm_set1_epi8('\n');
+  while (pos + 16 <= size) {
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+    const auto hits = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline)));
+    if (hits != 0) {
+      return pos + static_cast<std::size_t>(std::countr_zero(hits));
+    }
+    pos += 16;
+  }
+  return scalar_find_newline(data, size, pos);
+}
+
+std::uint32_t sse2_newline_hits(const char* data) noexcept {
+  const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+  return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n'))));
+}
+
+std::size_t sse2_count_newlines(const char* data, std::size_t size) noexcept {
+  std::size_t count = 0;
+  std::size_t pos = 0;
+  for (; pos + 16 <= size; pos += 16) {
+    count += static_cast<std::size_t>(std::popcount(sse2_newline_hits(data + pos)));
+  }
+  return count + scalar_count_newlines_from(data, size, pos);
+}
+
+void sse2_collect_line_starts(const char* data, std::size_t size, std::uint32_t* out) noexcept {
+  std::size_t pos = 0;
+  for (; pos + 16 <= size; pos += 16) {
+    out = emit_line_starts(sse2_newline_hits(data + pos), pos, out);
+  }
+  scalar_collect_line_starts_from(data, size, pos, out);
+}
+
+ISTUDIO_TARGET_AVX2 __m256i avx2_in_range(__m256i bytes, char low, char span) noexcept {
+  const __m256i shifted = _mm256_sub_epi8(bytes, _mm256_set1_epi8(low));
+  return _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(span)), shifted);
+}
+
+ISTUDIO_TARGET_AVX2 std::size_t avx2_skip_whitespace(const char* data, std::size_t size, std::size_t pos) noexcept {
+  if (pos + 1 >= size || !is_space_byte(static_cast<unsigned char>(data[pos + 1]))) {
+    return scalar_skip_whitespace(data, size, pos);
+  }
+  const __m256i space = _mm256_set1_epi8(' ');
+  while (pos + 32 <= size) {
+    const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+    const __m256i mask = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, space), avx2_in_range(bytes, '\t', '\r' - '\t'));
+    const auto in_run = static_cast<std::uint32_t>(_mm256_movemask_epi8(mask));
+    if (in_run != 0xFFFFFFFFu) {
+      return pos + static_cast<std::size_t>(std::countr_one(in_run));
+    }
+    pos += 32;
+  }
+  return sse2_skip_whitespace(data, size, pos);
+}
+
+ISTUDIO_TARGET_AVX2 std::size_t avx2_skip_identifier(const char* data, std::size_t size, std::size_t pos) noexcept {
+  if (pos >= size || !is_identifier_byte(static_cast<unsigned char>(data[pos]))) {
+    return pos;
+  }
+  const __m256i case_bit = _mm256_set1_epi8(0x20);
+  const __m256i underscore = _mm256_set1_epi8('_');
+  while (pos + 32 <= size) {
+    const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+    const __m256i alpha = avx2_in_range(_mm256_or_si256(bytes, case_bit), 'a', 'z' - 'a');
+    const __m256i digit = avx2_in_range(bytes, '0', '9' - '0');
+    const __m256i mask = _mm256_or_si256(_mm256_or_si256(alpha, digit), _mm256_cmpeq_epi8(bytes, underscore));
+    const auto in_run = static_cast<std::uint32_t>(_mm256_movemask_epi8(mask));
+    if (in_run != 0xFFFFFFFFu) {
+      return pos + static_cast<std::size_t>(std::countr_one(in_run));
+    }
+    pos += 32;
+  }
+  return sse2_skip_identifier(data, size, pos);
+}
+
+ISTUDIO_TARGET_AVX2 std::size_t avx2_find_newline(const char* data, std::size_t size, std::size_t pos) noexcept {
+  const __m256i newline = _mm256_set1_epi8('\n');
+  while (pos + 32 <= size) {
+    const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+    const auto hits = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, newline)));
+    if (hits != 0) {
+      return pos + static_cast<std::size_t>(std::countr_zero(hits));
+    }
+    pos += 32;
+  }
+  return sse2_find_newline(data, size, pos);
+}
+
+ISTUDIO_TARGET_AVX2 std::uint32_t avx2_newline_hits(const char* data) noexcept {
+  const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+  return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n'))));
+}
+
+ISTUDIO_TARGET_AVX2 std::size_t avx2_count_newlines(const char* data, std::size_t size) noexcept {
+  std::size_t count = 0;
+  std::size_t pos = 0;
+  for (; pos + 32 <= size; pos += 32) {
+    count += static_cast<std::size_t>(std::popcount(avx2_newline_hits(data + pos)));
+  }
+  return count + scalar_count_newlines_from(data, size, pos);
+}
+
+ISTUDIO_TARGET_AVX2 void avx2_collect_line_starts(const char* data, std::size_t size, std::uint32_t* out) noexcept {
+  std::size_t pos = 0;
+  for (; pos + 32 <= size; pos += 32) {
+    out = emit_line_starts(avx2_newline_hits(data + pos), pos, out);
+  }
+  scalar_collect_line_starts_from(data, size, pos, out);
+}
+
+bool cpu_has_avx2() noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4]{};
+  __cpuid(info, 0);
+  if (info[0] < 7) {
+    return false;
+  }
+  __cpuid(info, 1);
+  const bool os_saves_ymm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+  __cpuidex(info, 7, 0);
+  return os_saves_ymm && (info[1] & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif  // ISTUDIO_SCAN_X86
+
+constexpr ScanKernels kScalarKernels{
+    .isa = ScanIsa::Scalar,
+    .skip_whitespace = scalar_skip_whitespace,
+    .skip_identifier = scalar_skip_identifier,
+    .find_newline = scalar_find_newline,
+    .count_newlines = scalar_count_newlines,
+    .collect_line_starts = scalar_collect_line_starts,
+};
+
+#if defined(ISTUDIO_SCAN_X86)
+constexpr ScanKernels kSse2Kernels{
+    .isa = ScanIsa::Sse2,
+    .skip_whitespace = sse2_skip_whitespace,
+    .skip_identifier = sse2_skip_identifier,
+    .find_newline = sse2_find_newline,
+    .count_newlines = sse2_count_newlines,
+    .collect_line_starts = sse2_collect_line_starts,
+};
+
+constexpr ScanKernels kAvx2Kernels{
+    .isa = ScanIsa::Avx2,
+    .skip_whitespace = avx2_skip_whitespace,
+    .skip_identifier = avx2_skip_identifier,
+    .find_newline = avx2_find_newline,
+    .count_newlines = avx2_count_newlines,
+    .collect_line_starts = avx2_collect_line_starts,
+};
+#endif
+
+const ScanKernels& select_kernels() noexcept {
+#if defined(ISTUDIO_SCAN_X86)
+  if (cpu_has_avx2()) {
+    return kAvx2Kernels;
+  }
+  return kSse2Kernels;
+#else
+  return kScalarKernels;
+#endif
+}
+
+}  // namespace
+
+const ScanKernels& scan_kernels() noexcept {
+  static const ScanKernels& selected = select_kernels();
+  return selected;
+}
+
+const ScanKernels* scan_kernels_for(ScanIsa isa) noexcept {
+  switch (isa) {
+    case ScanIsa::Scalar:
+      return &kScalarKernels;
+#if defined(ISTUDIO_SCAN_X86)
+    case ScanIsa::Sse2:
+      return &kSse2Kernels;
+    case ScanIsa::Avx2:
+      return cpu_has_avx2() ? &kAvx2Kernels : nullptr;
+#else
+    case ScanIsa::Sse2:
+    case ScanIsa::Avx2:
+      return nullptr;
+#endif
+  }
+  return nullptr;
+}
+
+std::string_view to_string(ScanIsa isa) noexcept {
+  switch (isa) {
+    case ScanIsa::Scalar:
+      return "scalar";
+    case ScanIsa::Sse2:
+      return "sse2";
+    case ScanIsa::Avx2:
+      return "avx2";
+  }
+  return "unknown";
+}
+
+}  // namespace istudio::front
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace istudio::front {
+
+enum class ScanIsa {
+  Scalar,
+  Sse2,
+  Avx2,
+};
+
+// Byte-run scanners used by the lexer. Each returns the first index at or after `pos` that ends the run
+// (or `size` when the run reaches the end). Classification is plain ASCII and locale independent.
+struct ScanKernels {
+  ScanIsa isa{ScanIsa::Scalar};
+  // Whitespace as in the "C" locale: ' ', '\t', '\n', '\v', '\f', '\r'.
+  std::size_t (*skip_whitespace)(const char* data, std::size_t size, std::size_t pos) noexcept{nullptr};
+  // Identifier continuation bytes: [A-Za-z0-9_].
+  std::size_t (*skip_identifier)(const char* data, std::size_t size, std::size_t pos) noexcept{nullptr};
+  // Position of the next '\n'.
+  std::size_t (*find_newline)(const char* data, std::size_t size, std::size_t pos) noexcept{nullptr};
+  // Number of '\n' bytes in [0, size).
+  std::size_t (*count_newlines)(const char* data, std::size_t size) noexcept{nullptr};
+  // Writes the offset just past every '\n' in [0, size) to `out`, which must hold count_newlines() entries.
+  // `size` must fit in 32 bits.
+  void (*collect_line_starts)(const char* data, std::size_t size, std::uint32_t* out) noexcept{nullptr};
+};
+
+// Kernels for the widest instruction set supported by the running CPU, selected once on first use.
+[[nodiscard]] const ScanKernels& scan_kernels() noexcept;
+
+// Kernels for a specific instruction set, or nullptr when the CPU (or build target) lacks it.
+[[nodiscard]] const ScanKernels* scan_kernels_for(ScanIsa isa) noexcept;
+
+[[nodiscard]] std::string_view to_string(ScanIsa isa) noexcept;
+
+}  // namespace istudio::front
@@ -1,7 +1,118 @@
 #include "front/token.h"
 
+#include <algorithm>
+
 namespace istudio::front {
 
+void TokenStream::reserve(std::size_t tokens) {
+  kinds_.reserve(tokens);
+  codes_.reserve(tokens);
+  starts_.reserve(tokens);
+  lengths_.reserve(tokens);
+}
+
+std::uint8_t TokenStream::code_of(const Token& token) noexcept {
+  switch (token.kind) {
+    case TokenKind::Symbol:
+      return static_cast<std::uint8_t>(token.punct);
+    case TokenKind::Keyword:
+      return static_cast<std::uint8_t>(token.keyword);
+    default:
+      return 0;
+  }
+}
+
+void TokenStream::push_back(const Token& token, std::span<const Trivia> leading) {
+  if (!leading.empty() && trivia_begin_.empty()) {
+    // First trivia in this stream: every earlier token gets an empty range.
+    trivia_begin_.assign(kinds_.size() + 1, 0);
+  }
+  if (token.symbol != support::kNoSymbol && symbols_.empty()) {
+    symbols_.assign(kinds_.size(), support::kNoSymbol);
+  }
+  if (!symbols_.empty()) {
+    symbols_.push_back(token.symbol);
+  }
+  kinds_.push_back(token.kind);
+  codes_.push_back(code_of(token));
+  starts_.push_back(token.span.start);
+  lengths_.push_back(static_cast<std::uint32_t>(token.span.length()));
+  if (!trivia_begin_.empty()) {
+    trivia_.insert(trivia_.end(), leading.begin(), leading.end());
+    trivia_begin_.push_back(static_cast<std::uint32_t>(trivia_.size()));
+  }
+}
+
+void TokenStream::append_shifted(const TokenStream& from, std::size_t first, std::size_t last,
+                                 std::ptrdiff_t delta) {
+  const auto shift = [delta](std::size_t offset) {
+    return static_cast<std::size_t>(static_cast<std::ptrdiff_t>(offset) + delta);
+  };
+  if (!from.symbols_.empty() && symbols_.empty()) {
+    symbols_.assign(kinds_.size(), support::kNoSymbol);
+  }
+  if (!symbols_.empty()) {
+    if (from.symbols_.empty()) {
+      symbols_.insert(symbols_.end(), last - first, support::kNoSymbol);
+    } else {
+      symbols_.insert(symbols_.end(), from.symbols_.begin() + static_cast<std::ptrdiff_t>(first),
+                      from.symbols_.begin() + static_cast<std::ptrdiff_t>(last));
+    }
+  }
+
+  const bool copies_trivia = from.has_trivia() && from.trivia_begin_[first] != from.trivia_begin_[last];
+  if (copies_trivia && trivia_begin_.empty()) {
+    trivia_begin_.assign(kinds_.size() + 1, 0);
+  }
+
+  const auto begin = static_cast<std::ptrdiff_t>(first);
+  const auto end = static_cast<std::ptrdiff_t>(last);
+  kinds_.insert(kinds_.end(), from.kinds_.begin() + begin, from.kinds_.begin() + end);
+  codes_.insert(codes_.end(), from.codes_.begin() + begin, from.codes_.begin() + end);
+  lengths_.insert(lengths_.end(), from.lengths_.begin() + begin, from.lengths_.begin() + end);
+  starts_.reserve(starts_.size() + (last - first));
+  for (std::size_t i = first; i < last; ++i) {
+    starts_.push_back(static_cast<std::uint32_t>(shift(from.starts_[i])));
+  }
+
+  if (trivia_begin_.empty()) {
+    return;
+  }
+  if (!from.has_trivia()) {
+    trivia_begin_.insert(trivia_begin_.end(), last - first, static_cast<std::uint32_t>(trivia_.size()));
+    return;
+  }
+  const std::uint32_t base = static_cast<std::uint32_t>(trivia_.size()) - from.trivia_begin_[first];
+  for (std::size_t i = first + 1; i <= last; ++i) {
+    trivia_begin_.push_back(from.trivia_begin_[i] + base);
+  }
+  for (std::uint32_t t = from.trivia_begin_[first]; t < from.trivia_begin_[last]; ++t) {
+    const Trivia& trivia = from.trivia_[t];
+    const support::Span span = support::make_span(shift(trivia.span.start), shift(trivia.span.end));
+    trivia_.push_back(Trivia{.kind = trivia.kind, .text = source_.substr(span.start, span.length()), .span = span});
+  }
+}
+
+std::span<const Trivia> TokenStream::leading_trivia(std::size_t index) const {
+  if (trivia_begin_.empty()) {
+    return {};
+  }
+  const std::uint32_t begin = trivia_begin_[index];
+  return {trivia_.data() + begin, trivia_begin_[index + 1] - begin};
+}
+
+std::size_t TokenStream::first_at(std::size_t offset) const noexcept {
+  const auto found = std::partition_point(starts_.begin(), starts_.end(),
+                                          [offset](std::uint32_t start) { return start < offset; });
+  return static_cast<std::size_t>(found - starts_.begin());
+}
+
+std::size_t TokenStream::memory_bytes() const noexcept {
+  return kinds_.capacity() * sizeof(TokenKind) + codes_.capacity() + starts_.capacity() * sizeof(std::uint32_t) +
+         lengths_.capacity() * sizeof(std::uint32_t) + trivia_.capacity() * sizeof(Trivia) +
+         trivia_begin_.capacity() * sizeof(std::uint32_t) + symbols_.capacity() * sizeof(support::Symbol);
+}
+
 std::string_view to_string(TokenKind kind) {
   switch (kind) {
     case TokenKind::Identifier:
@@ -22,4 +133,133 @@ std::string_view to_string(TokenKind kind) {
   return "Unknown";
 }
 
+std::string_view to_string(Keyword keyword) {
+  switch (keyword) {
+    case Keyword::None:
+      return "";
+    case Keyword::Module:
+      return "module";
+    case Keyword::Fn:
+      return "fn";
+    case Keyword::Pub:
+      return "pub";
+    case Keyword::Let:
+      return "let";
+    case Keyword::Mut:
+      return "mut";
+    case Keyword::Struct:
+      return "struct";
+    case Keyword::Enum:
+      return "enum";
+    case Keyword::Ct:
+      return "ct";
+    case Keyword::Return:
+      return "return";
+  }
+  return "";
+}
+
+std::string_view spelling(Punct punct) {
+  switch (punct) {
+    case Punct::None:
+    case Punct::Other:
+      return "";
+    case Punct::LParen:
+      return "(";
+    case Punct::RParen:
+      return ")";
+    case Punct::LBrace:
+      return "{";
+    case Punct::RBrace:
+      return "}";
+    case Punct::LBracket:
+      return "[";
+    case Punct::RBracket:
+      return "]";
+    case Punct::Comma:
+      return ",";
+    case Punct::Semicolon:
+      return ";";
+    case Punct::Colon:
+      return ":";
+    case Punct::Dot:
+      return ".";
+    case Punct::Question:
+      return "?";
+    case Punct::At:
+      return "@";
+    case Punct::Hash:
+      return "#";
+    case Punct::Dollar:
+      return "$";
+    case Punct::Tilde:
+      return "~";
+    case Punct::Plus:
+      return "+";
+    case Punct::Minus:
+      return "-";
+    case Punct::Star:
+      return "*";
+    case Punct::Slash:
+      return "/";
+    case Punct::Percent:
+      return "%";
+    case Punct::Amp:
+      return "&";
+    case Punct::Pipe:
+      return "|";
+    case Punct::Caret:
+      return "^";
+    case Punct::Bang:
+      return "!";
+    case Punct::Less:
+      return "<";
+    case Punct::Greater:
+      return ">";
+    case Punct::Assign:
+      return "=";
+    case Punct::EqualEqual:
+      return "==";
+    case Punct::BangEqual:
+      return "!=";
+    case Punct::LessEqual:
+      return "<=";
+    case Punct::GreaterEqual:
+      return ">=";
+    case Punct::AmpAmp:
+      return "&&";
+    case Punct::PipePipe:
+      return "||";
+    case Punct::ColonColon:
+      return "::";
+    case Punct::Arrow:
+      return "->";
+    case Punct::FatArrow:
+      return "=>";
+    case Punct::PlusAssign:
+      return "+=";
+    case Punct::MinusAssign:
+      return "-=";
+    case Punct::StarAssign:
+      return "*=";
+    case Punct::SlashAssign:
+      return "/=";
+    case Punct::PercentAssign:
+      return "%=";
+    case Punct::AmpAssign:
+      return "&=";
+    case Punct::PipeAssign:
+      return "|=";
+    case Punct::CaretAssign:
+      return "^=";
+    case Punct::ShiftLeft:
+      return "<<";
+    case Punct::ShiftRight:
+      return ">>";
+    case Punct::ShiftRightAssign:
+      return ">>=";
+  }
+  return "";
+}
+
 }  // namespace istudio::front
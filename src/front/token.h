@@ -1,14 +1,18 @@
 #pragma once
 
-#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
 #include <string_view>
 #include <vector>
 
 #include "support/span.h"
+#include "support/string_interner.h"
 
 namespace istudio::front {
 
-enum class TokenKind {
+enum class TokenKind : std::uint8_t {
   Identifier,
   Number,
   StringLiteral,
@@ -18,42 +22,205 @@ enum class TokenKind {
   Unknown,
 };
 
-enum class TriviaKind {
+enum class Keyword : std::uint8_t {
+  None,
+  Module,
+  Fn,
+  Pub,
+  Let,
+  Mut,
+  Struct,
+  Enum,
+  Ct,
+  Return,
+};
+
+// Punctuators and operators. `Other` covers any single byte that is not part of the operator set.
+enum class Punct : std::uint8_t {
+  None,
+  Other,
+  LParen,
+  RParen,
+  LBrace,
+  RBrace,
+  LBracket,
+  RBracket,
+  Comma,
+  Semicolon,
+  Colon,
+  Dot,
+  Question,
+  At,
+  Hash,
+  Dollar,
+  Tilde,
+  Plus,
+  Minus,
+  Star,
+  Slash,
+  Percent,
+  Amp,
+  Pipe,
+  Caret,
+  Bang,
+  Less,
+  Greater,
+  Assign,
+  EqualEqual,
+  BangEqual,
+  LessEqual,
+  GreaterEqual,
+  AmpAmp,
+  PipePipe,
+  ColonColon,
+  Arrow,
+  FatArrow,
+  PlusAssign,
+  MinusAssign,
+  StarAssign,
+  SlashAssign,
+  PercentAssign,
+  AmpAssign,
+  PipeAssign,
+  CaretAssign,
+  ShiftLeft,
+  ShiftRight,
+  ShiftRightAssign,
+};
+
+inline constexpr std::size_t kPunctCount = static_cast<std::size_t>(Punct::ShiftRightAssign) + 1;
+
+enum class TriviaKind : std::uint8_t {
   Whitespace,
   Comment,
 };
 
+// Token lexemes and trivia text are views into the source handed to the lexer, which must outlive the
+// token stream.
 struct Trivia {
   TriviaKind kind{TriviaKind::Whitespace};
-  std::string text{};
+  std::string_view text{};
   support::Span span{};
 };
 
+// Value view of one token, materialized on demand from a TokenStream. Cheap to copy; trivia is kept in the
+// stream's side table and fetched through TokenStream::leading_trivia.
 struct Token {
   TokenKind kind{TokenKind::Unknown};
-  std::string lexeme{};
+  // Classified at lex time so the parser compares codes, not text: set for Symbol and Keyword tokens.
+  Punct punct{Punct::None};
+  Keyword keyword{Keyword::None};
+  std::string_view lexeme{};
   support::Span span{};
-  std::vector<Trivia> leading_trivia{};
-  std::vector<Trivia> trailing_trivia{};
+  // Interned identifier text when the lexer was given an interner; kNoSymbol otherwise.
+  support::Symbol symbol{support::kNoSymbol};
 };
 
 struct LexerConfig {
   bool capture_whitespace{false};
   bool capture_comments{true};
+  // When set, identifiers are interned as they are lexed. Must outlive the lexer; callers lexing
+  // concurrently may share one.
+  support::StringInterner* interner{nullptr};
 };
 
-struct TokenStream {
-  std::vector<Token> tokens{};
+// Struct-of-arrays token store: one byte of kind, one byte of Punct or Keyword code, plus 32-bit start and
+// length per token (10 bytes, versus ~100 for a Token with inline trivia vectors). Trivia lives in a side table
+// indexed by token and is only populated when the LexerConfig asks for it.
+class TokenStream {
+ public:
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Token;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = Token;
+
+    const_iterator() = default;
+    const_iterator(const TokenStream* stream, std::size_t index) : stream_(stream), index_(index) {}
+
+    [[nodiscard]] Token operator*() const { return (*stream_)[index_]; }
+    const_iterator& operator++() {
+      ++index_;
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator copy = *this;
+      ++index_;
+      return copy;
+    }
+    [[nodiscard]] bool operator==(const const_iterator& other) const noexcept { return index_ == other.index_; }
+
+   private:
+    const TokenStream* stream_{nullptr};
+    std::size_t index_{0};
+  };
+
+  TokenStream() = default;
+  explicit TokenStream(std::string_view source) : source_(source) {}
+
+  void reserve(std::size_t tokens);
+  // Appends a token; `leading` becomes its leading trivia when trivia capture is enabled.
+  void push_back(const Token& token, std::span<const Trivia> leading = {});
+  // Appends tokens [first, last) of `from` with every offset moved by `delta`; lexemes and trivia text are
+  // re-viewed from this stream's source, which must hold the same bytes at the shifted offsets.
+  void append_shifted(const TokenStream& from, std::size_t first, std::size_t last, std::ptrdiff_t delta);
+
+  [[nodiscard]] Token operator[](std::size_t index) const {
+    const std::uint32_t start = starts_[index];
+    const TokenKind kind = kinds_[index];
+    return Token{.kind = kind,
+                 .punct = kind == TokenKind::Symbol ? static_cast<Punct>(codes_[index]) : Punct::None,
+                 .keyword = kind == TokenKind::Keyword ? static_cast<Keyword>(codes_[index]) : Keyword::None,
+                 .lexeme = source_.substr(start, lengths_[index]),
+                 .span = {start, start + lengths_[index]},
+                 .symbol = symbol(index)};
+  }
+  [[nodiscard]] TokenKind kind(std::size_t index) const { return kinds_[index]; }
+  [[nodiscard]] Punct punct(std::size_t index) const {
+    return kinds_[index] == TokenKind::Symbol ? static_cast<Punct>(codes_[index]) : Punct::None;
+  }
+  [[nodiscard]] Keyword keyword(std::size_t index) const {
+    return kinds_[index] == TokenKind::Keyword ? static_cast<Keyword>(codes_[index]) : Keyword::None;
+  }
+  [[nodiscard]] support::Symbol symbol(std::size_t index) const {
+    return symbols_.empty() ? support::kNoSymbol : symbols_[index];
+  }
+  [[nodiscard]] std::span<const Trivia> leading_trivia(std::size_t index) const;
+  // Index of the first token starting at or after `offset`; size() if there is none.
+  [[nodiscard]] std::size_t first_at(std::size_t offset) const noexcept;
+  [[nodiscard]] bool has_trivia() const noexcept { return !trivia_begin_.empty(); }
+
+  [[nodiscard]] std::string_view source() const noexcept { return source_; }
+  [[nodiscard]] const_iterator begin() const noexcept { return {this, 0}; }
+  [[nodiscard]] const_iterator end() const noexcept { return {this, kinds_.size()}; }
+  [[nodiscard]] std::size_t size() const noexcept { return kinds_.size(); }
+  [[nodiscard]] bool empty() const noexcept { return kinds_.empty(); }
+  [[nodiscard]] Token front() const { return (*this)[0]; }
+  [[nodiscard]] Token back() const { return (*this)[kinds_.size() - 1]; }
+  // Heap bytes held by the token arrays and trivia side table.
+  [[nodiscard]] std::size_t memory_bytes() const noexcept;
+
+ private:
+  [[nodiscard]] static std::uint8_t code_of(const Token& token) noexcept;
 
-  [[nodiscard]] auto begin() noexcept { return tokens.begin(); }
-  [[nodiscard]] auto end() noexcept { return tokens.end(); }
-  [[nodiscard]] auto begin() const noexcept { return tokens.begin(); }
-  [[nodiscard]] auto end() const noexcept { return tokens.end(); }
-  [[nodiscard]] auto size() const noexcept { return tokens.size(); }
-  [[nodiscard]] bool empty() const noexcept { return tokens.empty(); }
-  [[nodiscard]] const Token& back() const { return tokens.back(); }
+  std::string_view source_{};
+  std::vector<TokenKind> kinds_{};
+  // Punct for Symbol tokens, Keyword for Keyword tokens, 0 otherwise.
+  std::vector<std::uint8_t> codes_{};
+  std::vector<std::uint32_t> starts_{};
+  std::vector<std::uint32_t> lengths_{};
+  // trivia_[trivia_begin_[i], trivia_begin_[i + 1]) is the leading trivia of token i.
+  std::vector<Trivia> trivia_{};
+  std::vector<std::uint32_t> trivia_begin_{};
+  // Per-token interned symbols; like the trivia table, only allocated once a token carries one.
+  std::vector<support::Symbol> symbols_{};
 };
 
 std::string_view to_string(TokenKind kind);
+std::string_view to_string(Keyword keyword);
+// Source spelling of a punctuator; empty for `None` and `Other`.
+std::string_view spelling(Punct punct);
 
 }  // namespace istudio::front
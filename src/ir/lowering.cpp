@@ -1,6 +1,8 @@
 #include "ir/lowering.h"
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "sem/context.h"
 #include "sem/types.h"
@@ -8,7 +10,7 @@
 namespace istudio::ir {
 namespace {
 
-IRType map_type(const sem::Type& type) {
+IRType map_type(const sem::Type& type, sem::TypeArena& types) {
   using sem::TypeKind;
   switch (type.kind) {
     case TypeKind::Void:
@@ -22,7 +24,7 @@ IRType map_type(const sem::Type& type) {
     case TypeKind::String:
       return IRType::String();
     case TypeKind::Function:
-      return IRType::Generic("fn");
+      return IRType{types.generic("fn")};
     case TypeKind::Unknown:
     default:
       return IRType::Void();
@@ -33,18 +35,29 @@ IRType map_type(const sem::Type& type) {
 
 IRModule lower_module(const front::AstContext&, const sem::SemanticAnalyzer& analyzer,
                       front::NodeId, std::string module_name) {
-  IRModule module(std::move(module_name));
+  IRModule module(std::move(module_name), analyzer.context().shared_types());
 
-  const auto& registry = analyzer.context().functions().entries();
-  for (const auto& [name, signature] : registry) {
+  // The registry is keyed by symbol, whose order depends on interning and so on thread timing; functions are
+  // emitted in declaration order instead, which node ids follow across files too.
+  std::vector<const sem::FunctionSignature*> signatures{};
+  for (const auto& [symbol, signature] : analyzer.context().functions().entries()) {
+    signatures.push_back(&signature);
+  }
+  std::sort(signatures.begin(), signatures.end(),
+            [](const sem::FunctionSignature* lhs, const sem::FunctionSignature* rhs) {
+              return lhs->node_id < rhs->node_id;
+            });
+
+  // IR names are owned copies: the module outlives the front end and its interner.
+  for (const sem::FunctionSignature* signature : signatures) {
     std::vector<IRParameter> params;
-    params.reserve(signature.parameters.size());
-    for (const auto& param : signature.parameters) {
-      params.push_back(IRParameter{param.name, map_type(param.type)});
+    params.reserve(signature->parameters.size());
+    for (const auto& param : signature->parameters) {
+      params.push_back(IRParameter{std::string(param.name), map_type(param.type, module.types())});
     }
 
-    IRType return_type = map_type(signature.return_type);
-    module.add_function(name, return_type, std::move(params));
+    const IRType return_type = map_type(signature->return_type, module.types());
+    module.add_function(std::string(signature->name), return_type, std::move(params));
   }
 
   return module;
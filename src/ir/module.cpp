@@ -29,7 +29,7 @@ IRFunction& IRModule::add_function(std::string name, IRType return_type,
                                    std::vector<std::string> template_params) {
   IRFunction fn{};
   fn.name = std::move(name);
-  fn.return_type = std::move(return_type);
+  fn.return_type = return_type;
   fn.parameters = std::move(parameters);
   fn.template_params = std::move(template_params);
   return add_function(std::move(fn));
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -46,11 +47,17 @@ struct IRFunction {
 
 class IRModule {
  public:
-  explicit IRModule(std::string name = "module") : name_(std::move(name)) {}
+  // Lowering passes the analyzer's arena, so IR and semantic types share ids.
+  explicit IRModule(std::string name = "module",
+                    std::shared_ptr<sem::TypeArena> types = std::make_shared<sem::TypeArena>())
+      : name_(std::move(name)), types_(std::move(types)) {}
 
   void set_name(std::string name) { name_ = std::move(name); }
   [[nodiscard]] const std::string& name() const noexcept { return name_; }
 
+  [[nodiscard]] sem::TypeArena& types() noexcept { return *types_; }
+  [[nodiscard]] const sem::TypeArena& types() const noexcept { return *types_; }
+
   IRStruct& add_struct(IRStruct value);
   IRStruct& add_struct(std::string name, std::vector<IRField> fields = {},
                        std::vector<std::string> template_params = {}, bool is_public = true);
@@ -66,6 +73,7 @@ class IRModule {
 
  private:
   std::string name_;
+  std::shared_ptr<sem::TypeArena> types_;
   std::vector<IRStruct> structs_{};
   std::vector<IRFunction> functions_{};
 };
@@ -0,0 +1,52 @@
+#include "lsp/position.h"
+
+#include <string_view>
+
+namespace istudio::lsp {
+namespace {
+
+// UTF-16 code units encoded by the UTF-8 sequence starting with `lead`; continuation bytes count as zero.
+std::uint32_t utf16_units(unsigned char lead) {
+  if (lead < 0x80) {
+    return 1;
+  }
+  if (lead < 0xC0) {
+    return 0;
+  }
+  return lead >= 0xF0 ? 2 : 1;
+}
+
+}  // namespace
+
+Position to_position(const support::SourceManager& sources, support::FileId file, std::size_t offset) {
+  const auto location = sources.line_column(file, offset);
+  const std::string_view text = sources.text(file);
+  const std::size_t line_start = sources.line_start(file, location.line);
+
+  std::uint32_t character = 0;
+  for (std::size_t i = line_start; i < line_start + location.column - 1; ++i) {
+    character += utf16_units(static_cast<unsigned char>(text[i]));
+  }
+  return Position{.line = location.line - 1, .character = character};
+}
+
+std::size_t to_offset(const support::SourceManager& sources, support::FileId file, Position position) {
+  if (position.line >= sources.line_count(file)) {
+    return sources.text(file).size();
+  }
+  const std::uint32_t line = position.line + 1;
+  const std::string_view text = sources.line_text(file, line);
+
+  std::uint32_t character = 0;
+  std::size_t column = 0;
+  while (column < text.size() && character < position.character) {
+    character += utf16_units(static_cast<unsigned char>(text[column]));
+    ++column;
+    while (column < text.size() && utf16_units(static_cast<unsigned char>(text[column])) == 0) {
+      ++column;
+    }
+  }
+  return sources.line_start(file, line) + column;
+}
+
+}  // namespace istudio::lsp
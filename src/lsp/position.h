@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "support/source_manager.h"
+
+namespace istudio::lsp {
+
+// Position as defined by the Language Server Protocol: 0-based line and UTF-16 code unit within the line.
+struct Position {
+  std::uint32_t line{0};
+  std::uint32_t character{0};
+};
+
+// Converts a byte offset in `file` to an LSP position.
+[[nodiscard]] Position to_position(const support::SourceManager& sources, support::FileId file, std::size_t offset);
+
+// Converts an LSP position back to a byte offset. Lines past the end map to the end of the file and
+// characters past the end of a line to the end of that line, as the protocol requires.
+[[nodiscard]] std::size_t to_offset(const support::SourceManager& sources, support::FileId file,
+                                    Position position);
+
+}  // namespace istudio::lsp
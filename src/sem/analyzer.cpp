@@ -1,12 +1,21 @@
 #include "sem/analyzer.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <exception>
+#include <future>
 #include <limits>
+#include <memory>
+#include <stdexcept>
 #include <string>
 #include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "support/thread_pool.h"
+
 namespace istudio::sem {
 namespace {
 
@@ -38,6 +47,19 @@ bool is_float_literal(std::string_view value) {
   return value.find('.') != std::string_view::npos;
 }
 
+TypeKind literal_kind(std::string_view value) {
+  if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+    return TypeKind::String;
+  }
+  if (is_bool_literal(value)) {
+    return TypeKind::Bool;
+  }
+  if (is_number_literal(value)) {
+    return is_float_literal(value) ? TypeKind::Float : TypeKind::Integer;
+  }
+  return TypeKind::Unknown;
+}
+
 inline Type pick_known(Type lhs, Type rhs) {
   if (lhs.kind != TypeKind::Unknown) {
     return lhs;
@@ -45,161 +67,551 @@ inline Type pick_known(Type lhs, Type rhs) {
   return rhs;
 }
 
+// A function with a name, as opposed to the placeholder of one that failed to parse.
+bool is_named_function(const front::AstNode& node) {
+  return node.kind == front::AstKind::Function && !node.children.empty();
+}
+
 }  // namespace
 
-void TypeTable::set(front::NodeId id, Type type) {
-  types_[id] = type;
+SemanticAnalyzer::SemanticAnalyzer(const front::AstContext& ast, support::DiagnosticReporter& reporter)
+    : ast_(&ast), reporter_(reporter), worker_reporter_(reporter.file()) {}
+
+SemanticAnalyzer::SemanticAnalyzer(const front::AstForest& forest, support::DiagnosticReporter& reporter)
+    : forest_(&forest), reporter_(reporter), worker_reporter_(reporter.file()) {}
+
+SemanticAnalyzer::SemanticAnalyzer(SemanticAnalyzer& parent)
+    : ast_(parent.ast_),
+      forest_(parent.forest_),
+      reporter_(worker_reporter_),
+      parent_(&parent),
+      worker_reporter_(parent.reporter_.file()),
+      context_(parent.context_.shared_names()) {
+  context_.symbols() = parent.context_.symbols();
+}
+
+void SemanticAnalyzer::analyze(front::NodeId root) {
+  reset(forest_ != nullptr ? forest_->interner() : ast_->interner());
+  tree_ = forest_ != nullptr ? &forest_->shard(front::shard_of(root)) : ast_;
+  types_.reserve(tree_->shard(), tree_->size());
+  analyze_tree(root);
 }
 
-Type TypeTable::get(front::NodeId id) const {
-  auto it = types_.find(id);
-  if (it != types_.end()) {
-    return it->second;
+void SemanticAnalyzer::analyze() {
+  if (forest_ == nullptr) {
+    throw std::logic_error("analyze() without a root needs an AstForest");
   }
-  return Type{};
+  reset(forest_->interner());
+  for (std::uint32_t shard = 0; shard < forest_->shard_count(); ++shard) {
+    current_file_ = forest_->file(shard);
+    tree_ = &forest_->shard(shard);
+    types_.reserve(shard, tree_->size());
+    analyze_tree(forest_->root(shard));
+  }
+  current_file_ = support::kInvalidFileId;
 }
 
-bool TypeTable::contains(front::NodeId id) const noexcept {
-  return types_.find(id) != types_.end();
+void SemanticAnalyzer::analyze_parallel(front::NodeId root, support::ThreadPool& pool) {
+  reset(forest_ != nullptr ? forest_->interner() : ast_->interner());
+  tree_ = forest_ != nullptr ? &forest_->shard(front::shard_of(root)) : ast_;
+  types_.reserve(tree_->shard(), tree_->size());
+  const ModuleRoot module{.tree = tree_, .file = support::kInvalidFileId, .root = root};
+  analyze_in_phases(std::span<const ModuleRoot>(&module, 1), pool);
 }
 
-void TypeTable::clear() {
-  types_.clear();
+void SemanticAnalyzer::analyze_parallel(support::ThreadPool& pool) {
+  if (forest_ == nullptr) {
+    throw std::logic_error("analyze_parallel() without a root needs an AstForest");
+  }
+  reset(forest_->interner());
+  std::vector<ModuleRoot> roots{};
+  for (std::uint32_t shard = 0; shard < forest_->shard_count(); ++shard) {
+    types_.reserve(shard, forest_->shard(shard).size());
+    roots.push_back(
+        ModuleRoot{.tree = &forest_->shard(shard), .file = forest_->file(shard), .root = forest_->root(shard)});
+  }
+  analyze_in_phases(roots, pool);
+  current_file_ = support::kInvalidFileId;
 }
 
-SemanticAnalyzer::SemanticAnalyzer(const front::AstContext& ast, support::DiagnosticReporter& reporter)
-    : ast_(ast), reporter_(reporter) {}
+void SemanticAnalyzer::analyze_in_phases(std::span<const ModuleRoot> roots, support::ThreadPool& pool) {
+  PackedLists calls{};
+  const std::vector<TopLevelFunction> functions = declare_globals(roots, &calls);
+  analyze_bodies(functions, calls, pool);
+  for (std::vector<support::Diagnostic>& diagnostics : body_diagnostics_) {
+    for (support::Diagnostic& diagnostic : diagnostics) {
+      reporter_.add(std::move(diagnostic));
+    }
+  }
+  body_diagnostics_.clear();
+
+  for (const ModuleRoot& module : roots) {
+    tree_ = module.tree;
+    current_file_ = module.file;
+    const front::AstNode& root = ast_node(module.root);
+    if (root.kind != front::AstKind::Module) {
+      analyze_tree(root.id);
+      continue;
+    }
+    for (const front::NodeId child : root.children) {
+      if (!is_named_function(ast_node(child))) {
+        analyze_tree(child);
+      }
+    }
+    assign_type(root.id, Type{TypeKind::Unknown});
+  }
+}
 
-void SemanticAnalyzer::analyze(front::NodeId root) {
+SemanticAnalyzer::PackedLists SemanticAnalyzer::strongly_connected_components(const PackedLists& edges) {
+  constexpr std::uint32_t kUnvisited = std::numeric_limits<std::uint32_t>::max();
+  struct Frame {
+    std::uint32_t vertex;
+    std::size_t next_edge;
+  };
+  std::vector<std::uint32_t> order(edges.size(), kUnvisited);
+  std::vector<std::uint32_t> low(edges.size(), 0);
+  std::vector<bool> on_stack(edges.size(), false);
+  std::vector<std::uint32_t> stack{};
+  std::vector<Frame> frames{};
+  PackedLists components{};
+  std::uint32_t visited = 0;
+
+  const auto visit = [&](std::uint32_t vertex) {
+    order[vertex] = low[vertex] = visited++;
+    stack.push_back(vertex);
+    on_stack[vertex] = true;
+    frames.push_back(Frame{vertex, 0});
+  };
+
+  for (std::uint32_t root = 0; root < edges.size(); ++root) {
+    if (order[root] != kUnvisited) {
+      continue;
+    }
+    visit(root);
+    while (!frames.empty()) {
+      const std::uint32_t vertex = frames.back().vertex;
+      if (frames.back().next_edge < edges[vertex].size()) {
+        const std::uint32_t next = edges[vertex][frames.back().next_edge++];
+        if (order[next] == kUnvisited) {
+          visit(next);
+        } else if (on_stack[next]) {
+          low[vertex] = std::min(low[vertex], order[next]);
+        }
+        continue;
+      }
+
+      frames.pop_back();
+      if (!frames.empty()) {
+        low[frames.back().vertex] = std::min(low[frames.back().vertex], low[vertex]);
+      }
+      if (low[vertex] == order[vertex]) {
+        const auto first = static_cast<std::ptrdiff_t>(components.items.size());
+        std::uint32_t member = 0;
+        do {
+          member = stack.back();
+          stack.pop_back();
+          on_stack[member] = false;
+          components.items.push_back(member);
+        } while (member != vertex);
+        std::sort(components.items.begin() + first, components.items.end());
+        components.close_list();
+      }
+    }
+  }
+  return components;
+}
+
+std::vector<SemanticAnalyzer::TopLevelFunction> SemanticAnalyzer::declare_globals(std::span<const ModuleRoot> roots,
+                                                                                   PackedLists* calls) {
+  std::vector<TopLevelFunction> functions{};
+  for (const ModuleRoot& module : roots) {
+    tree_ = module.tree;
+    current_file_ = module.file;
+    const front::AstNode& root = ast_node(module.root);
+    if (root.kind != front::AstKind::Module) {
+      continue;
+    }
+    declarations_.reserve(tree_->shard(), tree_->size());
+    for (const front::NodeId child : root.children) {
+      const front::AstNode& node = ast_node(child);
+      if (node.kind == front::AstKind::LetStmt && !node.children.empty()) {
+        const front::AstNode& name_node = ast_node(node.children.front());
+        declare_symbol(name_node);
+        declarations_.set(name_node.id, Declaration{});
+      } else if (is_named_function(node)) {
+        const auto index = static_cast<std::uint32_t>(functions.size());
+        const front::AstNode& name_node = ast_node(node.children.front());
+        declare_symbol(name_node);
+        declare_function_type(name_node, node);
+        const Declaration declaration{.signature = register_function(node), .function = index};
+        declarations_.set(node.id, declaration);
+        declarations_.set(name_node.id, declaration);
+        functions.push_back(TopLevelFunction{.tree = tree_, .file = current_file_, .node = node.id});
+      }
+    }
+  }
+
+  // A body depends on every top-level function it names, called or not, as the global scope binds the name;
+  // shadowing only adds spurious edges.
+  for (std::uint32_t index = 0; index < functions.size(); ++index) {
+    tree_ = functions[index].tree;
+    current_file_ = functions[index].file;
+    front::walk_ast_post_order(*tree_, functions[index].node, [&](const front::AstNode& node) {
+      if (node.kind == front::AstKind::IdentifierExpr) {
+        if (calls == nullptr) {
+          return;
+        }
+        const Declaration* declaration = declarations_.find(context_.symbols().lookup(name_of(node)));
+        if (declaration != nullptr && declaration->function != kNoFunction) {
+          calls->items.push_back(declaration->function);
+        }
+      } else if (is_named_function(node) && node.id != functions[index].node) {
+        declarations_.set(node.id, Declaration{.signature = register_function(node), .function = index});
+      }
+    });
+    if (calls != nullptr) {
+      calls->close_list();
+    }
+  }
+  return functions;
+}
+
+void SemanticAnalyzer::analyze_bodies(std::span<const TopLevelFunction> functions, const PackedLists& calls,
+                                      support::ThreadPool& pool) {
+  const PackedLists components = strongly_connected_components(calls);
+  component_of_.assign(functions.size(), 0);
+  for (std::uint32_t component = 0; component < components.size(); ++component) {
+    for (const std::uint32_t function : components[component]) {
+      component_of_[function] = component;
+    }
+  }
+
+  // A component runs one level after the deepest component it calls; components come callees first.
+  std::vector<std::uint32_t> level_of(components.size(), 0);
+  std::vector<std::uint32_t> level_sizes{};
+  for (std::uint32_t component = 0; component < components.size(); ++component) {
+    for (const std::uint32_t function : components[component]) {
+      for (const std::uint32_t callee : calls[function]) {
+        if (component_of_[callee] != component) {
+          level_of[component] = std::max(level_of[component], level_of[component_of_[callee]] + 1);
+        }
+      }
+    }
+    if (level_sizes.size() <= level_of[component]) {
+      level_sizes.resize(std::size_t{level_of[component]} + 1, 0);
+    }
+    ++level_sizes[level_of[component]];
+  }
+  // Each level lists its components in the order they came.
+  PackedLists levels{};
+  levels.items.resize(components.size());
+  for (const std::uint32_t size : level_sizes) {
+    levels.offsets.push_back(levels.offsets.back() + size);
+  }
+  std::vector<std::uint32_t> filled(levels.offsets.begin(), levels.offsets.end() - 1);
+  for (std::uint32_t component = 0; component < components.size(); ++component) {
+    levels.items[filled[level_of[component]]++] = component;
+  }
+  const std::size_t widest = level_sizes.empty() ? 0 : *std::max_element(level_sizes.begin(), level_sizes.end());
+
+  // Workers are only worth copying the global scope for when they run beside one another.
+  const bool serial = pool.size() == 1 || widest == 1;
+  body_diagnostics_.assign(functions.size(), {});
+  std::vector<std::unique_ptr<SemanticAnalyzer>> workers{};
+  for (std::size_t i = 0; !serial && i < std::min(pool.size(), widest); ++i) {
+    workers.push_back(std::unique_ptr<SemanticAnalyzer>(new SemanticAnalyzer(*this)));
+  }
+
+  analyzing_bodies_ = true;
+  for (std::size_t index = 0; index < levels.size(); ++index) {
+    const std::span<const std::uint32_t> level = levels[index];
+    // A lone component, as along a call chain, is not worth a round trip through the pool either.
+    if (serial || level.size() == 1) {
+      for (const std::uint32_t component : level) {
+        analyze_component(functions, components[component], component);
+      }
+      continue;
+    }
+
+    // Workers take components in turn; results do not depend on which worker took which.
+    std::atomic<std::size_t> next{0};
+    std::vector<std::future<void>> pending{};
+    for (std::size_t i = 0; i < std::min(workers.size(), level.size()); ++i) {
+      pending.push_back(pool.submit([&, worker = workers[i].get()] {
+        for (std::size_t taken = next++; taken < level.size(); taken = next++) {
+          worker->analyze_component(functions, components[level[taken]], level[taken]);
+        }
+      }));
+    }
+
+    // Every task reads this analyzer; none may still be running when an exception leaves.
+    std::exception_ptr failure{};
+    for (std::future<void>& task : pending) {
+      try {
+        task.get();
+      } catch (...) {
+        if (failure == nullptr) {
+          failure = std::current_exception();
+        }
+      }
+    }
+    if (failure != nullptr) {
+      std::rethrow_exception(failure);
+    }
+  }
+  analyzing_bodies_ = false;
+  // The third phase may update any declaration.
+  component_of_.clear();
+}
+
+void SemanticAnalyzer::analyze_component(std::span<const TopLevelFunction> functions,
+                                         std::span<const std::uint32_t> members, std::uint32_t component) {
+  component_ = component;
+  SemanticAnalyzer& owner = parent_ != nullptr ? *parent_ : *this;
+  for (const std::uint32_t index : members) {
+    tree_ = functions[index].tree;
+    current_file_ = functions[index].file;
+    analyze_tree(functions[index].node);
+    owner.body_diagnostics_[index] = worker_reporter_.diagnostics();
+    worker_reporter_ = support::DiagnosticReporter{worker_reporter_.file()};
+  }
+}
+
+void SemanticAnalyzer::infer(front::NodeId root) {
+  reset(forest_ != nullptr ? forest_->interner() : ast_->interner());
+  tree_ = forest_ != nullptr ? &forest_->shard(front::shard_of(root)) : ast_;
+  types_.reserve(tree_->shard(), tree_->size());
+  const ModuleRoot module{.tree = tree_, .file = support::kInvalidFileId, .root = root};
+  infer_roots(std::span<const ModuleRoot>(&module, 1));
+}
+
+void SemanticAnalyzer::infer() {
+  if (forest_ == nullptr) {
+    throw std::logic_error("infer() without a root needs an AstForest");
+  }
+  reset(forest_->interner());
+  std::vector<ModuleRoot> roots{};
+  for (std::uint32_t shard = 0; shard < forest_->shard_count(); ++shard) {
+    types_.reserve(shard, forest_->shard(shard).size());
+    roots.push_back(
+        ModuleRoot{.tree = &forest_->shard(shard), .file = forest_->file(shard), .root = forest_->root(shard)});
+  }
+  infer_roots(roots);
+  current_file_ = support::kInvalidFileId;
+}
+
+void SemanticAnalyzer::infer_roots(std::span<const ModuleRoot> roots) {
+  inference_ = std::make_unique<Inference>();
+  for (const ModuleRoot& module : roots) {
+    inference_->variables.reserve(module.tree->shard(), module.tree->size());
+  }
+  static_cast<void>(declare_globals(roots, nullptr));
+  for (const ModuleRoot& module : roots) {
+    tree_ = module.tree;
+    current_file_ = module.file;
+    analyze_tree(module.root);
+  }
+  inference_->solver.solve([this](std::uint32_t call, Type callee) { resolve_call(call, callee); });
+  apply_solution();
+  inference_.reset();
+}
+
+void SemanticAnalyzer::reset(const std::shared_ptr<support::StringInterner>& interner) {
   types_.clear();
-  context_ = SemanticContext{};
-  analyze_node(root);
+  inference_.reset();
+  function_stack_.clear();
+  declarations_.clear();
+  component_of_.clear();
+  body_diagnostics_.clear();
+  analyzing_bodies_ = false;
+  worker_reporter_ = support::DiagnosticReporter{reporter_.file()};
+  // Share the AST's interner so symbols the lexer assigned are used as is.
+  context_ = SemanticContext{interner != nullptr ? interner : std::make_shared<support::StringInterner>()};
+}
+
+// In forest mode the diagnostic belongs to the shard's file, not to whatever file the reporter was made for.
+void SemanticAnalyzer::report(support::DiagCode code, std::string message, support::Span span) {
+  support::DiagnosticReporter& reporter = analyzing_bodies_ ? worker_reporter_ : reporter_;
+  if (forest_ == nullptr) {
+    reporter.report(code, std::move(message), span);
+    return;
+  }
+  reporter.add(support::Diagnostic{
+      .code = code, .message = std::move(message), .span = span, .notes = {}, .file = current_file_});
+}
+
+void SemanticAnalyzer::analyze_tree(front::NodeId root) {
+  front::walk_ast(
+      *tree_, root, [this](const front::AstNode& node) { return enter_statement(node); },
+      [this](const front::AstNode& node) { leave_statement(node); });
 }
 
-void SemanticAnalyzer::analyze_node(front::NodeId id) {
-  const auto& node = ast_.node(id);
+front::WalkAction SemanticAnalyzer::enter_statement(const front::AstNode& node) {
   switch (node.kind) {
     case front::AstKind::Module:
-      analyze_module(node);
-      break;
+      return front::WalkAction::visit_children();
     case front::AstKind::Function:
-      analyze_function(node);
-      break;
+      return enter_function(node);
     case front::AstKind::BlockStmt:
-      analyze_block(node);
-      break;
+      context_.symbols().push_scope();
+      return front::WalkAction::visit_children();
     case front::AstKind::LetStmt:
       analyze_let(node);
-      break;
+      return front::WalkAction::skip_children();
     case front::AstKind::ReturnStmt:
       analyze_return(node);
-      break;
+      return front::WalkAction::skip_children();
     case front::AstKind::ExpressionStmt:
       analyze_expression_statement(node);
-      break;
+      return front::WalkAction::skip_children();
+    case front::AstKind::Error:
+      // The parser reported the error; what did parse is still checked so its declarations stay visible.
+      return front::WalkAction::visit_children();
     default:
-      break;
-  }
-}
-
-void SemanticAnalyzer::analyze_module(const front::AstNode& node) {
-  for (front::NodeId child : node.children) {
-    analyze_node(child);
+      return front::WalkAction::skip_children();
   }
-  assign_type(node.id, Type{TypeKind::Unknown});
 }
 
-void SemanticAnalyzer::analyze_block(const front::AstNode& node) {
-  context_.symbols().push_scope();
-  for (front::NodeId child : node.children) {
-    analyze_node(child);
+void SemanticAnalyzer::leave_statement(const front::AstNode& node) {
+  switch (node.kind) {
+    case front::AstKind::Module:
+      assign_type(node.id, Type{TypeKind::Unknown});
+      break;
+    case front::AstKind::Function:
+      leave_function(node);
+      break;
+    case front::AstKind::BlockStmt:
+      context_.symbols().pop_scope();
+      assign_type(node.id, Type{TypeKind::Unknown});
+      break;
+    default:
+      break;
   }
-  context_.symbols().pop_scope();
-  assign_type(node.id, Type{TypeKind::Unknown});
 }
 
-void SemanticAnalyzer::analyze_function(const front::AstNode& node) {
+// Declares the function and its parameters, then has the walk visit the body statements that follow them.
+front::WalkAction SemanticAnalyzer::enter_function(const front::AstNode& node) {
   if (node.children.empty()) {
     Type function_type{TypeKind::Function, node.id};
     assign_type(node.id, function_type);
-    return;
+    return front::WalkAction::skip_children();
   }
 
-  const auto& name_node = ast_.node(node.children.front());
-  declare_symbol(name_node.value, name_node.id, name_node.span);
+  const auto& name_node = ast_node(node.children.front());
+  declare_symbol(name_node);
+  declare_function_type(name_node, node);
 
-  Type function_type{TypeKind::Function, node.id};
-  assign_type(name_node.id, function_type);
-  assign_type(node.id, function_type);
+  // Workers, and infer(), find every signature registered by the first phase.
+  FunctionSignature* entry = nullptr;
+  const auto& declared = parent_ != nullptr ? parent_->declarations_ : declarations_;
+  if (const Declaration* found = declared.find(node.id)) {
+    entry = found->signature;
+  } else {
+    entry = register_function(node);
+  }
+  const bool has_parameters =
+      node.children.size() > 1 && ast_node(node.children[1]).kind == front::AstKind::ArgumentList;
+
+  function_stack_.push_back(
+      ActiveFunction{.signature = entry, .inferred_return = Type{TypeKind::Unknown}, .saw_return = false});
 
+  context_.symbols().push_scope();
+  if (entry != nullptr) {
+    for (auto& param : entry->parameters) {
+      const auto& param_node = ast_node(param.node_id);
+      declare_symbol(param_node);
+      assign_type(param.node_id, param.type);
+    }
+  }
+  return front::WalkAction::visit_children_from(has_parameters ? 2 : 1);
+}
+
+FunctionSignature* SemanticAnalyzer::register_function(const front::AstNode& node) {
+  const auto& name_node = ast_node(node.children.front());
   FunctionSignature signature{};
-  signature.name = name_node.value;
+  signature.symbol = name_of(name_node);
+  signature.name = context_.names().text(signature.symbol);
   signature.node_id = node.id;
   signature.return_type = Type{TypeKind::Unknown};
 
-  std::size_t next_index = 1;
   if (node.children.size() > 1) {
-    const auto& potential_params = ast_.node(node.children[1]);
+    const auto& potential_params = ast_node(node.children[1]);
     if (potential_params.kind == front::AstKind::ArgumentList) {
       for (front::NodeId param_id : potential_params.children) {
-        const auto& param_node = ast_.node(param_id);
+        const auto& param_node = ast_node(param_id);
         FunctionParameter param{};
-        param.name = param_node.value;
+        param.symbol = name_of(param_node);
+        param.name = context_.names().text(param.symbol);
         param.node_id = param_node.id;
         param.type = Type{TypeKind::Unknown};
         signature.parameters.push_back(std::move(param));
       }
-      next_index = 2;
     }
   }
 
-  auto [entry, inserted] = context_.functions().declare(std::move(signature));
+  auto [entry, inserted] = functions().declare(std::move(signature));
   if (!inserted) {
-    reporter_.report(support::DiagCode::SemDuplicateSymbol,
-                     "duplicate function '" + name_node.value + "'", name_node.span);
+    report(support::DiagCode::SemDuplicateSymbol, "duplicate function '" + std::string(name_node.value) + "'",
+           name_node.span);
   }
+  return entry;
+}
 
-  function_stack_.push_back(
-      ActiveFunction{.signature = entry, .inferred_return = Type{TypeKind::Unknown}, .saw_return = false});
-
-  context_.symbols().push_scope();
-  if (entry != nullptr) {
-    for (auto& param : entry->parameters) {
-      const auto& param_node = ast_.node(param.node_id);
-      declare_symbol(param.name, param.node_id, param_node.span);
-      assign_type(param.node_id, param.type);
-    }
+void SemanticAnalyzer::declare_function_type(const front::AstNode& name_node, const front::AstNode& node) {
+  const Type function_type{TypeKind::Function, node.id};
+  assign_type(name_node.id, function_type);
+  assign_type(node.id, function_type);
+  // Known from the start, so calls resolve before any constraint is solved.
+  if (inference_ != nullptr && !inference_->variables.contains(name_node.id)) {
+    inference_->variables.set(name_node.id, inference_->solver.known(function_type, site(name_node.span)));
   }
+}
 
-  for (std::size_t i = next_index; i < node.children.size(); ++i) {
-    analyze_node(node.children[i]);
+void SemanticAnalyzer::leave_function(const front::AstNode& node) {
+  if (node.children.empty()) {
+    return;
   }
-
   context_.symbols().pop_scope();
 
   ActiveFunction active = function_stack_.back();
   function_stack_.pop_back();
 
-  if (entry != nullptr) {
+  FunctionSignature* entry = active.signature;
+  if (inference_ != nullptr) {
+    if (entry != nullptr) {
+      if (!active.saw_return) {
+        const TypeSite name_site = site(ast_node(node.children.front()).span);
+        inference_->solver.equate(return_variable(*entry), inference_->solver.known(Type{TypeKind::Void}, name_site),
+                                  name_site, ConstraintReason::Return, entry->node_id);
+      }
+      inference_->signatures.push_back(entry);
+    }
+    return;
+  }
+  if (entry != nullptr && owns(entry->node_id)) {
     Type return_type = active.inferred_return;
     if (!active.saw_return && return_type.kind == TypeKind::Unknown) {
       return_type.kind = TypeKind::Void;
     }
     entry->return_type = return_type;
     for (auto& param : entry->parameters) {
-      param.type = types_.get(param.node_id);
+      param.type = type_of(param.node_id);
     }
   }
 }
 
 void SemanticAnalyzer::analyze_let(const front::AstNode& node) {
+  if (inference_ != nullptr) {
+    constrain_let(node);
+    return;
+  }
   if (node.children.empty()) {
     assign_type(node.id, Type{TypeKind::Unknown});
     return;
   }
 
-  const auto& name_node = ast_.node(node.children[0]);
-  declare_symbol(name_node.value, name_node.id, name_node.span);
+  const auto& name_node = ast_node(node.children[0]);
+  declare_symbol(name_node);
 
   Type init_type{TypeKind::Unknown};
   if (node.children.size() > 1) {
@@ -211,6 +623,10 @@ void SemanticAnalyzer::analyze_let(const front::AstNode& node) {
 }
 
 void SemanticAnalyzer::analyze_return(const front::AstNode& node) {
+  if (inference_ != nullptr) {
+    constrain_return(node);
+    return;
+  }
   Type return_type{TypeKind::Void};
   if (!node.children.empty()) {
     return_type = analyze_expression(node.children.front());
@@ -220,9 +636,11 @@ void SemanticAnalyzer::analyze_return(const front::AstNode& node) {
   if (ActiveFunction* active = current_function()) {
     if (active->signature != nullptr) {
       std::string message =
-          "return type mismatch for function '" + active->signature->name + "'";
+          "return type mismatch for function '" + std::string(active->signature->name) + "'";
       Type unified = unify_types(active->signature->return_type, return_type, node.span, message);
-      active->signature->return_type = unified;
+      if (owns(active->signature->node_id)) {
+        active->signature->return_type = unified;
+      }
       return_type = unified;
     }
   }
@@ -230,7 +648,9 @@ void SemanticAnalyzer::analyze_return(const front::AstNode& node) {
 }
 
 void SemanticAnalyzer::analyze_expression_statement(const front::AstNode& node) {
-  if (!node.children.empty()) {
+  if (inference_ != nullptr && !node.children.empty()) {
+    inference_->variables.set(node.id, constrain_expression(node.children.front()));
+  } else if (!node.children.empty()) {
     const Type expr_type = analyze_expression(node.children.front());
     assign_type(node.id, expr_type);
   } else {
@@ -238,100 +658,105 @@ void SemanticAnalyzer::analyze_expression_statement(const front::AstNode& node)
   }
 }
 
+// Every node leaves its type on operand_types_, where its parent finds its operands' types, in order.
 Type SemanticAnalyzer::analyze_expression(front::NodeId id) {
-  const auto& node = ast_.node(id);
+  const std::size_t base = operand_types_.size();
+  front::walk_ast_post_order(*tree_, id, [&](const front::AstNode& node) {
+    const std::size_t first = operand_types_.size() - node.children.size();
+    const Type type = infer_expression(node, std::span<const Type>{operand_types_}.subspan(first));
+    operand_types_.resize(first);
+    operand_types_.push_back(type);
+  });
+  const Type result = operand_types_.back();
+  operand_types_.resize(base);
+  return result;
+}
+
+Type SemanticAnalyzer::infer_expression(const front::AstNode& node, std::span<const Type> operands) {
   switch (node.kind) {
     case front::AstKind::IdentifierExpr:
       return analyze_identifier(node);
     case front::AstKind::LiteralExpr:
       return analyze_literal(node);
     case front::AstKind::BinaryExpr:
-      return analyze_binary(node);
+      return analyze_binary(node, operands);
     case front::AstKind::AssignmentExpr:
-      return analyze_assignment(node);
-    case front::AstKind::UnaryExpr:
-      return analyze_unary(node);
-    case front::AstKind::GroupExpr:
-      return analyze_group(node);
+      return analyze_assignment(node, operands);
     case front::AstKind::CallExpr:
-      return analyze_call(node);
-    default:
-      for (front::NodeId child : node.children) {
-        analyze_expression(child);
-      }
+      return analyze_call(node, operands);
+    case front::AstKind::UnaryExpr:
+    case front::AstKind::GroupExpr: {
+      // Both take the type of their one operand.
+      const Type result = operands.empty() ? Type{TypeKind::Unknown} : operands.front();
+      assign_type(node.id, result);
+      return result;
+    }
+    default: {
       Type result{TypeKind::Unknown};
       assign_type(node.id, result);
       return result;
+    }
   }
 }
 
 Type SemanticAnalyzer::analyze_identifier(const front::AstNode& node) {
-  const front::NodeId symbol_id = context_.symbols().lookup(node.value);
+  const front::NodeId symbol_id = context_.symbols().lookup(name_of(node));
   if (symbol_id == kInvalidNode) {
-    reporter_.report(support::DiagCode::SemUnknownIdentifier,
-                     "use of undeclared symbol '" + node.value + "'", node.span);
+    report(support::DiagCode::SemUnknownIdentifier, "use of undeclared symbol '" + std::string(node.value) + "'",
+           node.span);
     Type type{TypeKind::Unknown};
     assign_type(node.id, type);
     return type;
   }
 
-  const Type decl_type = types_.get(symbol_id);
+  const Type decl_type = type_of(symbol_id);
   assign_type(node.id, decl_type);
   return decl_type;
 }
 
 Type SemanticAnalyzer::analyze_literal(const front::AstNode& node) {
-  Type result{TypeKind::Unknown};
-  const std::string& value = node.value;
-
-  if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
-    result.kind = TypeKind::String;
-  } else if (is_bool_literal(value)) {
-    result.kind = TypeKind::Bool;
-  } else if (is_number_literal(value)) {
-    result.kind = is_float_literal(value) ? TypeKind::Float : TypeKind::Integer;
-  }
-
+  const Type result{literal_kind(node.value)};
   assign_type(node.id, result);
   return result;
 }
 
-Type SemanticAnalyzer::analyze_binary(const front::AstNode& node) {
-  if (node.children.size() < 2) {
+Type SemanticAnalyzer::analyze_binary(const front::AstNode& node, std::span<const Type> operands) {
+  if (operands.size() < 2) {
     Type result{TypeKind::Unknown};
     assign_type(node.id, result);
     return result;
   }
 
-  const Type left = analyze_expression(node.children[0]);
-  const Type right = analyze_expression(node.children[1]);
-  std::string message = "type mismatch in '" + node.value + "' expression";
+  const Type left = operands[0];
+  const Type right = operands[1];
+  std::string message = "type mismatch in '" + std::string(node.value) + "' expression";
   Type result = unify_types(left, right, node.span, message);
   assign_type(node.id, result);
   return result;
 }
 
-Type SemanticAnalyzer::analyze_assignment(const front::AstNode& node) {
-  if (node.children.size() < 2) {
+Type SemanticAnalyzer::analyze_assignment(const front::AstNode& node, std::span<const Type> operands) {
+  if (operands.size() < 2) {
     Type result{TypeKind::Unknown};
     assign_type(node.id, result);
     return result;
   }
 
   const front::NodeId lhs_id = node.children[0];
-  const front::NodeId rhs_id = node.children[1];
-  Type left = analyze_expression(lhs_id);
-  const Type right = analyze_expression(rhs_id);
+  Type left = operands[0];
+  const Type right = operands[1];
   Type result = unify_types(left, right, node.span, "type mismatch in assignment");
 
-  const auto& lhs_node = ast_.node(lhs_id);
+  const auto& lhs_node = ast_node(lhs_id);
   if (lhs_node.kind == front::AstKind::IdentifierExpr) {
-    const front::NodeId decl_id = context_.symbols().lookup(lhs_node.value);
+    const front::NodeId decl_id = context_.symbols().lookup(name_of(lhs_node));
     if (decl_id != kInvalidNode) {
-      Type decl_type = types_.get(decl_id);
+      Type decl_type = type_of(decl_id);
       Type unified = unify_types(decl_type, right, lhs_node.span,
-                                 "assignment to '" + lhs_node.value + "'");
-      types_.set(decl_id, unified);
+                                 "assignment to '" + std::string(lhs_node.value) + "'");
+      if (owns(decl_id)) {
+        assign_type(decl_id, unified);
+      }
       assign_type(lhs_id, unified);
       left = unified;
     }
@@ -342,66 +767,40 @@ Type SemanticAnalyzer::analyze_assignment(const front::AstNode& node) {
   return result;
 }
 
-Type SemanticAnalyzer::analyze_unary(const front::AstNode& node) {
-  if (node.children.empty()) {
-    Type result{TypeKind::Unknown};
-    assign_type(node.id, result);
-    return result;
-  }
-  const Type operand = analyze_expression(node.children.front());
-  assign_type(node.id, operand);
-  return operand;
-}
-
-Type SemanticAnalyzer::analyze_group(const front::AstNode& node) {
-  if (node.children.empty()) {
-    Type result{TypeKind::Unknown};
-    assign_type(node.id, result);
-    return result;
-  }
-  const Type inner = analyze_expression(node.children.front());
-  assign_type(node.id, inner);
-  return inner;
-}
-
-Type SemanticAnalyzer::analyze_call(const front::AstNode& node) {
-  if (node.children.empty()) {
+Type SemanticAnalyzer::analyze_call(const front::AstNode& node, std::span<const Type> operands) {
+  if (operands.empty()) {
     Type result{TypeKind::Unknown};
     assign_type(node.id, result);
     return result;
   }
 
-  const front::NodeId callee_id = node.children.front();
-  const Type callee_type = analyze_expression(callee_id);
-  std::vector<Type> argument_types;
-  argument_types.reserve(node.children.size() > 0 ? node.children.size() - 1 : 0);
-  for (std::size_t i = 1; i < node.children.size(); ++i) {
-    argument_types.push_back(analyze_expression(node.children[i]));
-  }
+  const Type callee_type = operands.front();
+  const std::span<const Type> argument_types = operands.subspan(1);
 
   Type result{TypeKind::Unknown};
   if (callee_type.kind == TypeKind::Function) {
-    if (auto* signature = context_.functions().lookup(callee_type.reference)) {
+    if (auto* signature = functions().lookup_by_node(callee_type.reference)) {
       const std::size_t expected_params = signature->parameters.size();
       const std::size_t provided_args = argument_types.size();
       if (expected_params != provided_args) {
-        reporter_.report(support::DiagCode::SemArgumentCountMismatch,
-                         "expected " + std::to_string(expected_params) +
-                             " argument(s) but got " + std::to_string(provided_args) +
-                             " when calling '" + signature->name + "'",
-                         node.span);
+        report(support::DiagCode::SemArgumentCountMismatch,
+               "expected " + std::to_string(expected_params) + " argument(s) but got " +
+                   std::to_string(provided_args) + " when calling '" + std::string(signature->name) + "'",
+               node.span);
       }
 
       const std::size_t limit = std::min(expected_params, provided_args);
       for (std::size_t i = 0; i < limit; ++i) {
         const auto& param = signature->parameters[i];
-        Type param_type = types_.get(param.node_id);
-        const auto& arg_node = ast_.node(node.children[1 + i]);
+        Type param_type = type_of(param.node_id);
+        const auto& arg_node = ast_node(node.children[1 + i]);
         std::string message =
-            "argument type mismatch for parameter '" + param.name + "'";
+            "argument type mismatch for parameter '" + std::string(param.name) + "'";
         Type unified = unify_types(param_type, argument_types[i], arg_node.span, message);
-        types_.set(param.node_id, unified);
-        signature->parameters[i].type = unified;
+        if (owns(signature->node_id)) {
+          assign_type(param.node_id, unified);
+          signature->parameters[i].type = unified;
+        }
       }
 
       result = signature->return_type;
@@ -412,15 +811,300 @@ Type SemanticAnalyzer::analyze_call(const front::AstNode& node) {
   return result;
 }
 
-void SemanticAnalyzer::declare_symbol(std::string_view name, front::NodeId id, support::Span span) {
-  std::string name_copy{name};
-  if (!context_.symbols().insert(name_copy, id)) {
-    reporter_.report(support::DiagCode::SemDuplicateSymbol, "duplicate symbol '" + name_copy + "'", span);
+void SemanticAnalyzer::constrain_let(const front::AstNode& node) {
+  if (node.children.empty()) {
+    assign_type(node.id, Type{TypeKind::Unknown});
+    return;
+  }
+
+  const auto& name_node = ast_node(node.children[0]);
+  declare_symbol(name_node);
+  // Uses of a top-level let may have been constrained already.
+  const TypeVariable declared = variable(name_node.id);
+  if (node.children.size() > 1) {
+    const TypeVariable init = constrain_expression(node.children[1]);
+    inference_->solver.equate(declared, init, site(name_node.span), ConstraintReason::Declaration, name_node.id);
+  }
+  inference_->variables.set(node.id, declared);
+}
+
+void SemanticAnalyzer::constrain_return(const front::AstNode& node) {
+  const TypeVariable value = node.children.empty()
+                                 ? inference_->solver.known(Type{TypeKind::Void}, site(node.span))
+                                 : constrain_expression(node.children.front());
+  inference_->variables.set(node.id, value);
+
+  ActiveFunction* active = current_function();
+  if (active != nullptr && active->signature != nullptr) {
+    active->saw_return = true;
+    inference_->solver.equate(return_variable(*active->signature), value, site(node.span), ConstraintReason::Return,
+                              active->signature->node_id);
+  }
+}
+
+// Like analyze_expression(), with a variable per node in place of a type.
+TypeVariable SemanticAnalyzer::constrain_expression(front::NodeId id) {
+  std::vector<TypeVariable>& operands = inference_->operands;
+  const std::size_t base = operands.size();
+  front::walk_ast_post_order(*tree_, id, [&](const front::AstNode& node) {
+    const std::size_t first = operands.size() - node.children.size();
+    const TypeVariable result = constrain_node(node, std::span<const TypeVariable>{operands}.subspan(first));
+    operands.resize(first);
+    operands.push_back(result);
+    inference_->variables.set(node.id, result);
+  });
+  const TypeVariable result = operands.back();
+  operands.resize(base);
+  return result;
+}
+
+TypeVariable SemanticAnalyzer::constrain_node(const front::AstNode& node, std::span<const TypeVariable> operands) {
+  TypeSolver& solver = inference_->solver;
+  switch (node.kind) {
+    case front::AstKind::IdentifierExpr: {
+      const front::NodeId symbol_id = context_.symbols().lookup(name_of(node));
+      if (symbol_id == kInvalidNode) {
+        report(support::DiagCode::SemUnknownIdentifier, "use of undeclared symbol '" + std::string(node.value) + "'",
+               node.span);
+        return solver.fresh();
+      }
+      return variable(symbol_id);
+    }
+    case front::AstKind::LiteralExpr: {
+      const TypeKind kind = literal_kind(node.value);
+      return kind == TypeKind::Unknown ? solver.fresh() : solver.known(Type{kind}, site(node.span));
+    }
+    case front::AstKind::BinaryExpr:
+      if (operands.size() < 2) {
+        return solver.fresh();
+      }
+      solver.equate(operands[0], operands[1], site(node.span), ConstraintReason::Operands, node.id);
+      return operands[0];
+    case front::AstKind::AssignmentExpr:
+      if (operands.size() < 2) {
+        return solver.fresh();
+      }
+      solver.equate(operands[0], operands[1], site(node.span), ConstraintReason::Assignment, node.id);
+      return operands[1];
+    case front::AstKind::CallExpr: {
+      if (operands.empty()) {
+        return solver.fresh();
+      }
+      // The callee may be any expression whose type is a function once solved.
+      const auto call = static_cast<std::uint32_t>(inference_->calls.size());
+      inference_->calls.push_back(PendingCall{.node = node.id, .file = site(node.span).file});
+      solver.watch(operands.front(), call);
+      return solver.fresh();
+    }
+    case front::AstKind::UnaryExpr:
+    case front::AstKind::GroupExpr:
+      return operands.empty() ? solver.fresh() : operands.front();
+    default:
+      return solver.fresh();
+  }
+}
+
+void SemanticAnalyzer::resolve_call(std::uint32_t call, Type callee) {
+  if (callee.kind != TypeKind::Function) {
+    return;
+  }
+  const FunctionSignature* signature = functions().lookup_by_node(callee.reference);
+  if (signature == nullptr) {
+    return;
+  }
+
+  const PendingCall pending = inference_->calls[call];
+  const front::AstNode& node = any_node(pending.node);
+  const std::size_t expected_params = signature->parameters.size();
+  const std::size_t provided_args = node.children.size() - 1;
+  if (expected_params != provided_args) {
+    inference_->diagnostics.push_back(support::Diagnostic{
+        .code = support::DiagCode::SemArgumentCountMismatch,
+        .message = "expected " + std::to_string(expected_params) + " argument(s) but got " +
+                   std::to_string(provided_args) + " when calling '" + std::string(signature->name) + "'",
+        .span = node.span,
+        .notes = {},
+        .file = pending.file});
+  }
+
+  TypeSolver& solver = inference_->solver;
+  const std::size_t limit = std::min(expected_params, provided_args);
+  for (std::size_t i = 0; i < limit; ++i) {
+    const front::NodeId argument = node.children[1 + i];
+    solver.equate(variable(signature->parameters[i].node_id), variable(argument),
+                  TypeSite{.span = any_node(argument).span, .file = pending.file}, ConstraintReason::Argument,
+                  signature->parameters[i].node_id);
+  }
+  solver.equate(return_variable(*signature), variable(node.id), TypeSite{.span = node.span, .file = pending.file},
+                ConstraintReason::CallResult, node.id);
+}
+
+void SemanticAnalyzer::apply_solution() {
+  TypeSolver& solver = inference_->solver;
+  inference_->variables.for_each([&](front::NodeId id, TypeVariable type) { types_.set(id, solver.type_of(type)); });
+  for (FunctionSignature* signature : inference_->signatures) {
+    signature->return_type = solver.type_of(return_variable(*signature));
+    for (FunctionParameter& param : signature->parameters) {
+      param.type = solver.type_of(variable(param.node_id));
+      types_.set(param.node_id, param.type);
+    }
+  }
+
+  std::vector<support::Diagnostic> diagnostics = std::move(inference_->diagnostics);
+  for (const TypeMismatch& mismatch : solver.mismatches()) {
+    switch (mismatch.reason) {
+      case ConstraintReason::Operands:
+      case ConstraintReason::Assignment:
+      case ConstraintReason::CallResult:
+        types_.set(mismatch.node, Type{TypeKind::Unknown});
+        break;
+      case ConstraintReason::Return:
+        if (FunctionSignature* signature = functions().lookup_by_node(mismatch.node)) {
+          signature->return_type = Type{TypeKind::Unknown};
+        }
+        break;
+      case ConstraintReason::Declaration:
+      case ConstraintReason::Argument:
+        break;
+    }
+    std::vector<support::DiagnosticNote> notes{};
+    notes.push_back(support::DiagnosticNote{.message = describe(mismatch.expected) + " inferred here",
+                                            .span = mismatch.expected_origin.span,
+                                            .file = mismatch.expected_origin.file});
+    notes.push_back(support::DiagnosticNote{.message = describe(mismatch.found) + " inferred here",
+                                            .span = mismatch.found_origin.span,
+                                            .file = mismatch.found_origin.file});
+    diagnostics.push_back(support::Diagnostic{.code = support::DiagCode::SemTypeMismatch,
+                                              .message = mismatch_message(mismatch),
+                                              .span = mismatch.site.span,
+                                              .notes = std::move(notes),
+                                              .file = mismatch.site.file});
+  }
+
+  // Solving order follows no source order; report by position instead.
+  std::stable_sort(diagnostics.begin(), diagnostics.end(), [](const auto& a, const auto& b) {
+    return a.file != b.file ? a.file < b.file : a.span.start < b.span.start;
+  });
+  for (support::Diagnostic& diagnostic : diagnostics) {
+    reporter_.add(std::move(diagnostic));
+  }
+}
+
+TypeVariable SemanticAnalyzer::variable(front::NodeId id) {
+  if (const TypeVariable* found = inference_->variables.find(id)) {
+    return *found;
+  }
+  const TypeVariable fresh = inference_->solver.fresh();
+  inference_->variables.set(id, fresh);
+  return fresh;
+}
+
+TypeVariable SemanticAnalyzer::return_variable(const FunctionSignature& signature) {
+  const auto [entry, inserted] = inference_->returns.try_emplace(signature.node_id, 0);
+  if (inserted) {
+    entry->second = inference_->solver.fresh();
+  }
+  return entry->second;
+}
+
+TypeSite SemanticAnalyzer::site(support::Span span) const noexcept {
+  return TypeSite{.span = span, .file = forest_ != nullptr ? current_file_ : reporter_.file()};
+}
+
+std::string SemanticAnalyzer::describe(Type type) {
+  switch (type.kind) {
+    case TypeKind::Unknown:
+      return "unknown";
+    case TypeKind::Void:
+      return "void";
+    case TypeKind::Integer:
+      return "integer";
+    case TypeKind::Float:
+      return "float";
+    case TypeKind::Bool:
+      return "bool";
+    case TypeKind::String:
+      return "string";
+    case TypeKind::Function:
+      if (const FunctionSignature* signature = functions().lookup_by_node(type.reference)) {
+        return "function '" + std::string(signature->name) + "'";
+      }
+      return "function";
+  }
+  return "unknown";
+}
+
+std::string SemanticAnalyzer::mismatch_message(const TypeMismatch& mismatch) {
+  switch (mismatch.reason) {
+    case ConstraintReason::Operands:
+      return "type mismatch in '" + std::string(any_node(mismatch.node).value) + "' expression";
+    case ConstraintReason::Assignment:
+      return "type mismatch in assignment";
+    case ConstraintReason::Declaration:
+      return "type mismatch in declaration of '" + std::string(any_node(mismatch.node).value) + "'";
+    case ConstraintReason::Return: {
+      const FunctionSignature* signature = functions().lookup_by_node(mismatch.node);
+      return "return type mismatch for function '" + std::string(signature != nullptr ? signature->name : "") + "'";
+    }
+    case ConstraintReason::Argument:
+      return "argument type mismatch for parameter '" + std::string(any_node(mismatch.node).value) + "'";
+    case ConstraintReason::CallResult:
+      return "type mismatch in call result";
+  }
+  return "type mismatch";
+}
+
+// The parser interns names when the AST has an interner; hand-built nodes are interned here.
+support::Symbol SemanticAnalyzer::name_of(const front::AstNode& node) {
+  if (node.symbol != support::kNoSymbol) {
+    return node.symbol;
+  }
+  return context_.names().intern(node.value);
+}
+
+void SemanticAnalyzer::declare_symbol(const front::AstNode& node) {
+  // The first phase of analyze_parallel() declared the top-level names; the walks that meet them again skip them.
+  const auto& declared = parent_ != nullptr ? parent_->declarations_ : declarations_;
+  if (context_.symbols().depth() == 1 && declared.contains(node.id)) {
+    return;
+  }
+  if (!context_.symbols().insert(name_of(node), node.id)) {
+    report(support::DiagCode::SemDuplicateSymbol, "duplicate symbol '" + std::string(node.value) + "'", node.span);
   }
 }
 
 void SemanticAnalyzer::assign_type(front::NodeId id, Type type) {
-  types_.set(id, type);
+  // Workers of one level type disjoint nodes: each only updates the declarations it owns, in its own bodies.
+  if (parent_ != nullptr) {
+    parent_->types_.set_shared(id, type);
+  } else {
+    types_.set(id, type);
+  }
+}
+
+FunctionRegistry& SemanticAnalyzer::functions() noexcept {
+  return parent_ != nullptr ? parent_->context_.functions() : context_.functions();
+}
+
+Type SemanticAnalyzer::type_of(front::NodeId id) const noexcept {
+  if (parent_ == nullptr) {
+    return types_.get(id);
+  }
+  return parent_->types_.get_shared(id);
+}
+
+bool SemanticAnalyzer::owns(front::NodeId id) const noexcept {
+  const SemanticAnalyzer& owner = parent_ != nullptr ? *parent_ : *this;
+  if (owner.component_of_.empty()) {
+    return true;
+  }
+  const Declaration* declaration = owner.declarations_.find(id);
+  if (declaration == nullptr) {
+    // Declared in the body being analyzed.
+    return true;
+  }
+  const std::uint32_t function = declaration->function;
+  return function != kNoFunction && owner.component_of_[function] == component_;
 }
 
 void SemanticAnalyzer::update_current_function_return(Type return_type, const front::AstNode& node) {
@@ -435,7 +1119,7 @@ void SemanticAnalyzer::update_current_function_return(Type return_type, const fr
 
   if (return_type.kind == TypeKind::Unknown) {
     active.inferred_return = Type{TypeKind::Unknown};
-    if (active.signature != nullptr) {
+    if (active.signature != nullptr && owns(active.signature->node_id)) {
       active.signature->return_type = Type{TypeKind::Unknown};
     }
     return;
@@ -443,13 +1127,13 @@ void SemanticAnalyzer::update_current_function_return(Type return_type, const fr
 
   std::string conflict_message = "conflicting return types";
   if (active.signature != nullptr) {
-    conflict_message += " in function '" + active.signature->name + "'";
+    conflict_message += " in function '" + std::string(active.signature->name) + "'";
   }
 
   active.inferred_return =
       unify_types(active.inferred_return, return_type, node.span, conflict_message);
 
-  if (active.signature != nullptr) {
+  if (active.signature != nullptr && owns(active.signature->node_id)) {
     active.signature->return_type = active.inferred_return;
   }
 }
@@ -464,13 +1148,13 @@ Type SemanticAnalyzer::unify_types(Type lhs, Type rhs, support::Span span, std::
 
   if (lhs.kind == rhs.kind) {
     if (lhs.kind == TypeKind::Function && lhs.reference != rhs.reference) {
-      reporter_.report(support::DiagCode::SemTypeMismatch, std::string(context), span);
+      report(support::DiagCode::SemTypeMismatch, std::string(context), span);
       return Type{TypeKind::Unknown};
     }
     return lhs;
   }
 
-  reporter_.report(support::DiagCode::SemTypeMismatch, std::string(context), span);
+  report(support::DiagCode::SemTypeMismatch, std::string(context), span);
   return Type{TypeKind::Unknown};
 }
 
@@ -1,71 +1,261 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
 #include <string>
 #include <string_view>
 #include <unordered_map>
 #include <vector>
 
 #include "front/ast.h"
+#include "front/ast_forest.h"
+#include "front/ast_walk.h"
+#include "front/node_table.h"
 #include "sem/context.h"
+#include "sem/type_solver.h"
 #include "sem/types.h"
 #include "support/diagnostics.h"
 
+namespace istudio::support {
+class ThreadPool;
+}  // namespace istudio::support
+
 namespace istudio::sem {
 
+// The type of each analyzed node; Type{} for nodes without one.
 class TypeTable {
  public:
-  void set(front::NodeId id, Type type);
-  [[nodiscard]] Type get(front::NodeId id) const;
-  [[nodiscard]] bool contains(front::NodeId id) const noexcept;
-  void clear();
+  void reserve(std::uint32_t shard, std::size_t nodes) { types_.reserve(shard, nodes); }
+  void set(front::NodeId id, Type type) { types_.set(id, type); }
+  [[nodiscard]] Type get(front::NodeId id) const noexcept {
+    const Type* type = types_.find(id);
+    return type != nullptr ? *type : Type{};
+  }
+  [[nodiscard]] bool contains(front::NodeId id) const noexcept { return types_.contains(id); }
+  // For threads typing disjoint nodes of a reserved table at once; see NodeTable::set_shared.
+  void set_shared(front::NodeId id, Type type) { types_.set_shared(id, type); }
+  [[nodiscard]] Type get_shared(front::NodeId id) const noexcept {
+    const Type* type = types_.find_shared(id);
+    return type != nullptr ? *type : Type{};
+  }
+  void clear() noexcept { types_.clear(); }
+  // Calls `visit(NodeId, Type)` on every recorded type, in id order.
+  template <typename Visit>
+  void for_each(Visit&& visit) const {
+    types_.for_each(visit);
+  }
 
  private:
-  std::unordered_map<front::NodeId, Type> types_{};
+  front::NodeTable<Type> types_{};
 };
 
 class SemanticAnalyzer {
  public:
   SemanticAnalyzer(const front::AstContext& ast, support::DiagnosticReporter& reporter);
+  // Analyzes every shard of `forest` as one program: shard roots in order, sharing one global scope, with
+  // diagnostics attributed to each shard's file.
+  SemanticAnalyzer(const front::AstForest& forest, support::DiagnosticReporter& reporter);
 
   void analyze(front::NodeId root);
+  // Forest mode only.
+  void analyze();
+
+  // Analyzes in three phases, with function bodies spread over `pool`. The first declares every top-level
+  // function and let, so bodies may use names declared after them, and registers every signature. The second
+  // analyzes the bodies of top-level functions by strongly connected component of the call graph, callees before
+  // callers: a component is one task, its functions analyzed in declaration order, and components that do not
+  // call each other run concurrently. The third analyzes the remaining top-level statements in order.
+  // A body only refines the parameter types of functions in its own component, and treats top-level lets as
+  // untyped until the third phase. Types and diagnostics do not depend on the pool: diagnostics come phase by
+  // phase, and those of bodies in declaration order. Components run on the calling thread when the pool has one
+  // thread, or when each level holds one, as along a call chain.
+  // Scoping differs from analyze(), which declares top-level names as it reaches them: here every top-level name
+  // is in scope from the start, so a use before its declaration at module scope is not reported, where analyze()
+  // reports an undeclared symbol.
+  void analyze_parallel(front::NodeId root, support::ThreadPool& pool);
+  // Forest mode only.
+  void analyze_parallel(support::ThreadPool& pool);
+
+  // Types the whole program at once rather than in visitation order. Every top-level function and let is
+  // declared first, as by analyze_parallel(); one walk then resolves names and records a TypeSolver constraint
+  // per typing rule, and solving them together afterwards gives each node the same type whatever order
+  // declarations, calls and bodies come in: a call before its callee's body gets the callee's return type, and a
+  // parameter is typed by every call. A mismatch is reported where the constraint arose, with a note at the
+  // origin of each side's type. An expression whose own operands mismatch has no type, nor has the return type
+  // of a function whose returns disagree.
+  void infer(front::NodeId root);
+  // Forest mode only.
+  void infer();
 
   [[nodiscard]] const SemanticContext& context() const noexcept { return context_; }
   [[nodiscard]] const TypeTable& types() const noexcept { return types_; }
 
  private:
-  void analyze_node(front::NodeId id);
-  void analyze_module(const front::AstNode& node);
-  void analyze_block(const front::AstNode& node);
-  void analyze_function(const front::AstNode& node);
+  struct ModuleRoot {
+    const front::AstContext* tree{nullptr};
+    support::FileId file{support::kInvalidFileId};
+    front::NodeId root{0};
+  };
+  struct TopLevelFunction {
+    const front::AstContext* tree{nullptr};
+    support::FileId file{support::kInvalidFileId};
+    front::NodeId node{0};
+  };
+  static constexpr std::uint32_t kNoFunction = std::numeric_limits<std::uint32_t>::max();
+  // What the first phase of analyze_parallel() declared: each function's signature, under both its node and
+  // its name, with the top-level function whose task may update it; top-level lets belong to no task.
+  struct Declaration {
+    FunctionSignature* signature{nullptr};
+    std::uint32_t function{kNoFunction};
+  };
+
+  // A worker of analyze_parallel(): it analyzes bodies on its own copy of `parent`'s global scope, records
+  // types straight into `parent`'s table and keeps its diagnostics until `parent` merges them.
+  explicit SemanticAnalyzer(SemanticAnalyzer& parent);
+
+  void analyze_in_phases(std::span<const ModuleRoot> roots, support::ThreadPool& pool);
+  // Lists of indices packed back to back in one array, list `i` being items[offsets[i], offsets[i + 1]), so a
+  // list per function or component costs no allocation of its own.
+  struct PackedLists {
+    std::vector<std::uint32_t> offsets{0};
+    std::vector<std::uint32_t> items{};
+
+    [[nodiscard]] std::size_t size() const noexcept { return offsets.size() - 1; }
+    [[nodiscard]] std::span<const std::uint32_t> operator[](std::size_t list) const noexcept {
+      return std::span<const std::uint32_t>(items).subspan(offsets[list], offsets[list + 1] - offsets[list]);
+    }
+    // Ends the list the items appended since the last call make up.
+    void close_list() { offsets.push_back(static_cast<std::uint32_t>(items.size())); }
+  };
+
+  // Tarjan's algorithm on an explicit stack. Components come out callees first, each after every component it
+  // has an edge to, and list their vertices in increasing order.
+  static PackedLists strongly_connected_components(const PackedLists& edges);
+
+  // Phase one; returns the top-level functions in declaration order and, unless `calls` is null, the call graph
+  // among them.
+  std::vector<TopLevelFunction> declare_globals(std::span<const ModuleRoot> roots, PackedLists* calls);
+  // Phase two: runs each level of components on `pool`, the next level once all of one are done. A lone component,
+  // or every one when the pool has a single thread or the call graph is a chain, runs on this analyzer instead.
+  void analyze_bodies(std::span<const TopLevelFunction> functions, const PackedLists& calls,
+                      support::ThreadPool& pool);
+  // In a worker, or in this analyzer when it runs the component itself.
+  void analyze_component(std::span<const TopLevelFunction> functions, std::span<const std::uint32_t> members,
+                         std::uint32_t component);
+
+  // Statements are walked depth-first with explicit enter and leave steps; each expression is then typed in one
+  // post-order pass, operands before operators, so neither recursion nor nesting depth is bounded by the stack.
+  void analyze_tree(front::NodeId root);
+  [[nodiscard]] front::WalkAction enter_statement(const front::AstNode& node);
+  void leave_statement(const front::AstNode& node);
+  [[nodiscard]] front::WalkAction enter_function(const front::AstNode& node);
+  void leave_function(const front::AstNode& node);
   void analyze_let(const front::AstNode& node);
   void analyze_return(const front::AstNode& node);
   void analyze_expression_statement(const front::AstNode& node);
 
   Type analyze_expression(front::NodeId id);
+  // Types `node` from the types of its children, in order.
+  Type infer_expression(const front::AstNode& node, std::span<const Type> operands);
   Type analyze_identifier(const front::AstNode& node);
   Type analyze_literal(const front::AstNode& node);
-  Type analyze_binary(const front::AstNode& node);
-  Type analyze_assignment(const front::AstNode& node);
-  Type analyze_unary(const front::AstNode& node);
-  Type analyze_group(const front::AstNode& node);
-  Type analyze_call(const front::AstNode& node);
+  Type analyze_binary(const front::AstNode& node, std::span<const Type> operands);
+  Type analyze_assignment(const front::AstNode& node, std::span<const Type> operands);
+  Type analyze_call(const front::AstNode& node, std::span<const Type> operands);
+
+  // infer() walks with the statement steps above, which defer to these while inference_ is set.
+  void infer_roots(std::span<const ModuleRoot> roots);
+  void constrain_let(const front::AstNode& node);
+  void constrain_return(const front::AstNode& node);
+  TypeVariable constrain_expression(front::NodeId id);
+  TypeVariable constrain_node(const front::AstNode& node, std::span<const TypeVariable> operands);
+  // Constrains a call's arguments and result once its callee turns out to be `callee`.
+  void resolve_call(std::uint32_t call, Type callee);
+  // Types every node and signature from the solution and reports what did not unify.
+  void apply_solution();
+  [[nodiscard]] TypeVariable variable(front::NodeId id);
+  [[nodiscard]] TypeVariable return_variable(const FunctionSignature& signature);
+  [[nodiscard]] TypeSite site(support::Span span) const noexcept;
+  [[nodiscard]] std::string describe(Type type);
+  [[nodiscard]] std::string mismatch_message(const TypeMismatch& mismatch);
 
-  void declare_symbol(std::string_view name, front::NodeId id, support::Span span);
+  [[nodiscard]] const front::AstNode& ast_node(front::NodeId id) const { return tree_->node(id); }
+  // Any shard's node in forest mode.
+  [[nodiscard]] const front::AstNode& any_node(front::NodeId id) const {
+    return forest_ != nullptr ? forest_->node(id) : ast_->node(id);
+  }
+  [[nodiscard]] FunctionRegistry& functions() noexcept;
+  [[nodiscard]] Type type_of(front::NodeId id) const noexcept;
+  // Whether this analysis may update the declaration at `id`: always, except while analyzing bodies in
+  // analyze_parallel() for declarations of other components and top-level lets.
+  [[nodiscard]] bool owns(front::NodeId id) const noexcept;
+  // Registers the signature of the function at `node`, reporting duplicates.
+  FunctionSignature* register_function(const front::AstNode& node);
+  // Types the name of the function at `node`.
+  void declare_function_type(const front::AstNode& name_node, const front::AstNode& node);
+  void reset(const std::shared_ptr<support::StringInterner>& interner);
+  void report(support::DiagCode code, std::string message, support::Span span);
+  [[nodiscard]] support::Symbol name_of(const front::AstNode& node);
+  void declare_symbol(const front::AstNode& node);
   void assign_type(front::NodeId id, Type type);
   void update_current_function_return(Type return_type, const front::AstNode& node);
   Type unify_types(Type lhs, Type rhs, support::Span span, std::string_view context);
 
-  const front::AstContext& ast_;
+  // Exactly one is set.
+  const front::AstContext* ast_{nullptr};
+  const front::AstForest* forest_{nullptr};
+  // The context holding the tree being analyzed: `ast_`, or in forest mode the shard being analyzed.
+  const front::AstContext* tree_{nullptr};
   support::DiagnosticReporter& reporter_;
+  // Set in workers, whose reporter_ is worker_reporter_.
+  SemanticAnalyzer* parent_{nullptr};
+  support::DiagnosticReporter worker_reporter_{};
+  // Set while this analyzer runs bodies of analyze_parallel() itself; they report to worker_reporter_ too.
+  bool analyzing_bodies_{false};
+  // The component whose bodies are being analyzed.
+  std::uint32_t component_{0};
+  // File of the shard being analyzed in forest mode.
+  support::FileId current_file_{support::kInvalidFileId};
   SemanticContext context_{};
   TypeTable types_{};
   struct ActiveFunction {
     FunctionSignature* signature{nullptr};
     Type inferred_return{};
+    // When inferring, whether any return statement was seen, with a value or not.
     bool saw_return{false};
   };
+  // Types of the expression nodes analyzed but not yet consumed by their parent.
+  std::vector<Type> operand_types_{};
   [[nodiscard]] ActiveFunction* current_function() noexcept;
   std::vector<ActiveFunction> function_stack_{};
+
+  // State of analyze_parallel() that its workers read.
+  front::NodeTable<Declaration> declarations_{};
+  std::vector<std::uint32_t> component_of_{};
+  // Diagnostics of each top-level function's body, filled in by the workers.
+  std::vector<std::vector<support::Diagnostic>> body_diagnostics_{};
+
+  // State of infer().
+  struct PendingCall {
+    front::NodeId node{0};
+    support::FileId file{support::kInvalidFileId};
+  };
+  struct Inference {
+    TypeSolver solver{};
+    front::NodeTable<TypeVariable> variables{};
+    // Keyed by the function's node.
+    std::unordered_map<front::NodeId, TypeVariable> returns{};
+    // Watched by index until their callees' types are known.
+    std::vector<PendingCall> calls{};
+    std::vector<FunctionSignature*> signatures{};
+    std::vector<TypeVariable> operands{};
+    // Reported while solving, before the mismatches.
+    std::vector<support::Diagnostic> diagnostics{};
+  };
+  std::unique_ptr<Inference> inference_{};
 };
 
 }  // namespace istudio::sem
@@ -1,47 +1,102 @@
 #include "sem/context.h"
 
 #include <limits>
+#include <stdexcept>
 #include <string>
 #include <string_view>
 #include <utility>
 
 namespace istudio::sem {
+namespace {
 
-SymbolTable::SymbolTable() {
+constexpr std::size_t kInitialSlots = 64;
+
+}  // namespace
+
+SymbolTable::SymbolTable(std::shared_ptr<support::StringInterner> names)
+    : names_(std::move(names)), slots_(kInitialSlots) {
   push_scope();
 }
 
 void SymbolTable::push_scope() {
-  scopes_.emplace_back();
+  scope_starts_.push_back(bindings_.size());
 }
 
 void SymbolTable::pop_scope() {
-  if (scopes_.size() > 1) {
-    scopes_.pop_back();
+  if (scope_starts_.size() <= 1) {
+    return;
+  }
+  const std::size_t start = scope_starts_.back();
+  scope_starts_.pop_back();
+  while (bindings_.size() > start) {
+    const Binding& binding = bindings_.back();
+    slots_[probe(binding.name)].innermost = binding.shadowed;
+    bindings_.pop_back();
+  }
+}
+
+bool SymbolTable::insert(support::Symbol name, front::NodeId id) {
+  std::size_t slot = probe(name);
+  if (slots_[slot].used) {
+    const std::uint32_t innermost = slots_[slot].innermost;
+    if (innermost != kNoBinding && innermost >= scope_starts_.back()) {
+      return false;
+    }
+  } else {
+    if (2 * (used_slots_ + 1) > slots_.size()) {
+      grow();
+      slot = probe(name);
+    }
+    slots_[slot] = Slot{.name = name, .innermost = kNoBinding, .used = true};
+    ++used_slots_;
+  }
+  if (bindings_.size() >= kNoBinding) {
+    throw std::length_error("too many symbols in scope");
   }
+  bindings_.push_back(Binding{.id = id, .name = name, .shadowed = slots_[slot].innermost});
+  slots_[slot].innermost = static_cast<std::uint32_t>(bindings_.size() - 1);
+  return true;
 }
 
-bool SymbolTable::insert(const std::string& name, front::NodeId id) {
-  if (scopes_.empty()) {
-    push_scope();
+front::NodeId SymbolTable::lookup(support::Symbol name) const {
+  const Slot& slot = slots_[probe(name)];
+  if (!slot.used || slot.innermost == kNoBinding) {
+    return std::numeric_limits<front::NodeId>::max();
   }
+  return bindings_[slot.innermost].id;
+}
 
-  auto& scope = scopes_.back();
-  return scope.emplace(name, id).second;
+front::NodeId SymbolTable::lookup(std::string_view name) const {
+  const support::Symbol symbol = names_->find(name);
+  if (symbol == support::kNoSymbol) {
+    return std::numeric_limits<front::NodeId>::max();
+  }
+  return lookup(symbol);
 }
 
-front::NodeId SymbolTable::lookup(const std::string& name) const {
-  for (auto it = scopes_.rbegin(); it != scopes_.rend(); ++it) {
-    const auto found = it->find(name);
-    if (found != it->end()) {
-      return found->second;
+// Symbols carry their interner shard in the low bits, so they are spread with a multiplicative hash.
+std::size_t SymbolTable::probe(support::Symbol name) const noexcept {
+  const std::size_t mask = slots_.size() - 1;
+  std::size_t slot = static_cast<std::size_t>((std::uint64_t{name} * 0x9E3779B97F4A7C15) >> 32) & mask;
+  while (slots_[slot].used && slots_[slot].name != name) {
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+void SymbolTable::grow() {
+  std::vector<Slot> old = std::exchange(slots_, std::vector<Slot>(slots_.size() * 2));
+  for (const Slot& slot : old) {
+    if (slot.used) {
+      slots_[probe(slot.name)] = slot;
     }
   }
-  return std::numeric_limits<front::NodeId>::max();
 }
 
+FunctionRegistry::FunctionRegistry(std::shared_ptr<support::StringInterner> names) : names_(std::move(names)) {}
+
 std::pair<FunctionSignature*, bool> FunctionRegistry::declare(FunctionSignature signature) {
-  auto [it, inserted] = by_name_.emplace(signature.name, std::move(signature));
+  auto [it, inserted] = by_name_.emplace(signature.symbol, std::move(signature));
   FunctionSignature* entry = &it->second;
   if (inserted) {
     by_node_.emplace(entry->node_id, entry);
@@ -49,23 +104,33 @@ std::pair<FunctionSignature*, bool> FunctionRegistry::declare(FunctionSignature
   return {entry, inserted};
 }
 
-FunctionSignature* FunctionRegistry::lookup(std::string_view name) {
-  auto it = by_name_.find(std::string(name));
+FunctionSignature* FunctionRegistry::lookup(support::Symbol name) {
+  auto it = by_name_.find(name);
   if (it == by_name_.end()) {
     return nullptr;
   }
   return &it->second;
 }
 
-const FunctionSignature* FunctionRegistry::lookup(std::string_view name) const {
-  auto it = by_name_.find(std::string(name));
+const FunctionSignature* FunctionRegistry::lookup(support::Symbol name) const {
+  auto it = by_name_.find(name);
   if (it == by_name_.end()) {
     return nullptr;
   }
   return &it->second;
 }
 
-FunctionSignature* FunctionRegistry::lookup(front::NodeId id) {
+FunctionSignature* FunctionRegistry::lookup(std::string_view name) {
+  const support::Symbol symbol = names_->find(name);
+  return symbol == support::kNoSymbol ? nullptr : lookup(symbol);
+}
+
+const FunctionSignature* FunctionRegistry::lookup(std::string_view name) const {
+  const support::Symbol symbol = names_->find(name);
+  return symbol == support::kNoSymbol ? nullptr : lookup(symbol);
+}
+
+FunctionSignature* FunctionRegistry::lookup_by_node(front::NodeId id) {
   auto it = by_node_.find(id);
   if (it == by_node_.end()) {
     return nullptr;
@@ -73,7 +138,7 @@ FunctionSignature* FunctionRegistry::lookup(front::NodeId id) {
   return it->second;
 }
 
-const FunctionSignature* FunctionRegistry::lookup(front::NodeId id) const {
+const FunctionSignature* FunctionRegistry::lookup_by_node(front::NodeId id) const {
   auto it = by_node_.find(id);
   if (it == by_node_.end()) {
     return nullptr;
@@ -81,6 +146,7 @@ const FunctionSignature* FunctionRegistry::lookup(front::NodeId id) const {
   return it->second;
 }
 
-SemanticContext::SemanticContext(SymbolTable table) : symbols_(std::move(table)) {}
+SemanticContext::SemanticContext(std::shared_ptr<support::StringInterner> names)
+    : names_(std::move(names)), types_(std::make_shared<TypeArena>(names_)), symbols_(names_), functions_(names_) {}
 
 }  // namespace istudio::sem
@@ -1,39 +1,81 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <limits>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <unordered_map>
 #include <vector>
 
 #include "front/ast.h"
+#include "sem/type_arena.h"
 #include "sem/types.h"
+#include "support/string_interner.h"
 
 namespace istudio::sem {
 
+// Every name in scope lives in one open-addressed table keyed by interned symbol, so a lookup is one probe
+// whatever the nesting depth. A name's slot points at its innermost binding, which links to the binding it
+// shadows. Bindings are appended in declaration order and double as the undo log: pop_scope unlinks the
+// scope's bindings newest first. The string overloads resolve through the interner and never intern.
 class SymbolTable {
  public:
-  SymbolTable();
+  explicit SymbolTable(std::shared_ptr<support::StringInterner> names = std::make_shared<support::StringInterner>());
 
   void push_scope();
+  // The outermost scope is never popped.
   void pop_scope();
-  [[nodiscard]] std::size_t depth() const noexcept { return scopes_.size(); }
+  [[nodiscard]] std::size_t depth() const noexcept { return scope_starts_.size(); }
 
-  bool insert(const std::string& name, front::NodeId id);
-  [[nodiscard]] front::NodeId lookup(const std::string& name) const;
+  // False, leaving the table unchanged, if `name` is already declared in the innermost scope; names of outer
+  // scopes are shadowed.
+  bool insert(support::Symbol name, front::NodeId id);
+  [[nodiscard]] front::NodeId lookup(support::Symbol name) const;
+  [[nodiscard]] front::NodeId lookup(std::string_view name) const;
 
  private:
-  std::vector<std::unordered_map<std::string, front::NodeId>> scopes_{};
+  static constexpr std::uint32_t kNoBinding = std::numeric_limits<std::uint32_t>::max();
+
+  struct Binding {
+    front::NodeId id{0};
+    support::Symbol name{support::kNoSymbol};
+    std::uint32_t shadowed{kNoBinding};
+  };
+
+  // A name stays in its slot once declared; `innermost` is kNoBinding while it is out of scope.
+  struct Slot {
+    support::Symbol name{support::kNoSymbol};
+    std::uint32_t innermost{kNoBinding};
+    bool used{false};
+  };
+
+  // Slot holding `name`, or the empty slot where it belongs.
+  [[nodiscard]] std::size_t probe(support::Symbol name) const noexcept;
+  void grow();
+
+  std::shared_ptr<support::StringInterner> names_{};
+  // Power-of-two sized, at most half full.
+  std::vector<Slot> slots_{};
+  std::size_t used_slots_{0};
+  std::vector<Binding> bindings_{};
+  // Index into bindings_ of each open scope's first binding.
+  std::vector<std::size_t> scope_starts_{};
 };
 
 struct FunctionParameter {
-  std::string name{};
+  // Interned text, valid for the interner's lifetime.
+  std::string_view name{};
+  support::Symbol symbol{support::kNoSymbol};
   front::NodeId node_id{std::numeric_limits<front::NodeId>::max()};
   Type type{};
 };
 
 struct FunctionSignature {
-  std::string name{};
+  // Interned text, valid for the interner's lifetime.
+  std::string_view name{};
+  support::Symbol symbol{support::kNoSymbol};
   front::NodeId node_id{std::numeric_limits<front::NodeId>::max()};
   std::vector<FunctionParameter> parameters{};
   Type return_type{};
@@ -41,25 +83,37 @@ struct FunctionSignature {
 
 class FunctionRegistry {
  public:
-  FunctionRegistry() = default;
+  explicit FunctionRegistry(std::shared_ptr<support::StringInterner> names =
+                                std::make_shared<support::StringInterner>());
 
+  // Keyed by `signature.symbol`.
   std::pair<FunctionSignature*, bool> declare(FunctionSignature signature);
+  [[nodiscard]] FunctionSignature* lookup(support::Symbol name);
+  [[nodiscard]] const FunctionSignature* lookup(support::Symbol name) const;
   [[nodiscard]] FunctionSignature* lookup(std::string_view name);
   [[nodiscard]] const FunctionSignature* lookup(std::string_view name) const;
-  [[nodiscard]] FunctionSignature* lookup(front::NodeId id);
-  [[nodiscard]] const FunctionSignature* lookup(front::NodeId id) const;
-  [[nodiscard]] const std::unordered_map<std::string, FunctionSignature>& entries() const noexcept {
+  // By the id of the declaring Function node. Named apart from lookup(Symbol) since both keys are plain integers.
+  [[nodiscard]] FunctionSignature* lookup_by_node(front::NodeId id);
+  [[nodiscard]] const FunctionSignature* lookup_by_node(front::NodeId id) const;
+  [[nodiscard]] const std::unordered_map<support::Symbol, FunctionSignature>& entries() const noexcept {
     return by_name_;
   }
 
  private:
-  std::unordered_map<std::string, FunctionSignature> by_name_{};
+  std::shared_ptr<support::StringInterner> names_{};
+  std::unordered_map<support::Symbol, FunctionSignature> by_name_{};
   std::unordered_map<front::NodeId, FunctionSignature*> by_node_{};
 };
 
+// Symbols, functions and type names share one interner, normally the one the lexer and AST used.
 class SemanticContext {
  public:
-  explicit SemanticContext(SymbolTable table = {});
+  explicit SemanticContext(std::shared_ptr<support::StringInterner> names =
+                               std::make_shared<support::StringInterner>());
+
+  [[nodiscard]] support::StringInterner& names() noexcept { return *names_; }
+  [[nodiscard]] const support::StringInterner& names() const noexcept { return *names_; }
+  [[nodiscard]] const std::shared_ptr<support::StringInterner>& shared_names() const noexcept { return names_; }
 
   [[nodiscard]] SymbolTable& symbols() noexcept { return symbols_; }
   [[nodiscard]] const SymbolTable& symbols() const noexcept { return symbols_; }
@@ -67,9 +121,16 @@ class SemanticContext {
   [[nodiscard]] FunctionRegistry& functions() noexcept { return functions_; }
   [[nodiscard]] const FunctionRegistry& functions() const noexcept { return functions_; }
 
+  [[nodiscard]] TypeArena& types() noexcept { return *types_; }
+  [[nodiscard]] const TypeArena& types() const noexcept { return *types_; }
+  // For the IR module lowered from this context, which keeps interning into the same arena.
+  [[nodiscard]] const std::shared_ptr<TypeArena>& shared_types() const noexcept { return types_; }
+
  private:
-  SymbolTable symbols_{};
-  FunctionRegistry functions_{};
+  std::shared_ptr<support::StringInterner> names_{};
+  std::shared_ptr<TypeArena> types_{};
+  SymbolTable symbols_;
+  FunctionRegistry functions_;
 };
 
 }  // namespace istudio::sem
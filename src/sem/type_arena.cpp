@@ -0,0 +1,283 @@
+#include "sem/type_arena.h"
+
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+namespace istudio::sem {
+namespace {
+
+constexpr std::size_t kInitialSlots = 64;
+constexpr std::uint64_t kHashMultiplier = 0x9E3779B97F4A7C15;
+
+std::uint64_t mix(std::uint64_t hash, std::uint64_t value) noexcept {
+  return (std::rotl(hash, 23) ^ value) * kHashMultiplier;
+}
+
+// Ids and symbols are small and dense; the finisher spreads them over the bits the table mask keeps.
+std::uint64_t finish(std::uint64_t hash) noexcept {
+  hash ^= hash >> 33;
+  hash *= 0xFF51AFD7ED558CCD;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+std::uint64_t hash_type(TypeForm form, support::Symbol name, std::span<const TypeId> arguments) noexcept {
+  std::uint64_t hash = mix(mix(static_cast<std::uint64_t>(form), name), arguments.size());
+  for (const TypeId argument : arguments) {
+    hash = mix(hash, argument);
+  }
+  return finish(hash);
+}
+
+std::string_view builtin_name(TypeForm form) noexcept {
+  switch (form) {
+    case TypeForm::Void:
+      return "void";
+    case TypeForm::Bool:
+      return "bool";
+    case TypeForm::I32:
+      return "i32";
+    case TypeForm::I64:
+      return "i64";
+    case TypeForm::F32:
+      return "f32";
+    case TypeForm::F64:
+      return "f64";
+    case TypeForm::String:
+      return "string";
+    case TypeForm::Unknown:
+    case TypeForm::Function:
+    case TypeForm::Struct:
+    case TypeForm::Generic:
+      break;
+  }
+  return "unknown";
+}
+
+}  // namespace
+
+TypeArena::TypeArena(std::shared_ptr<support::StringInterner> names)
+    : names_(std::move(names)), slots_(kInitialSlots, kNoType) {
+  for (TypeId id = 0; is_builtin_type(id); ++id) {
+    static_cast<void>(intern(static_cast<TypeForm>(id), support::kNoSymbol, {}));
+  }
+}
+
+TypeId TypeArena::function(TypeId result, std::span<const TypeId> parameters) {
+  std::vector<TypeId> arguments{};
+  arguments.reserve(parameters.size() + 1);
+  arguments.push_back(result);
+  arguments.insert(arguments.end(), parameters.begin(), parameters.end());
+  return intern(TypeForm::Function, support::kNoSymbol, arguments);
+}
+
+TypeId TypeArena::function(TypeId result, std::initializer_list<TypeId> parameters) {
+  return function(result, std::span<const TypeId>(parameters.begin(), parameters.size()));
+}
+
+TypeId TypeArena::structure(std::string_view name, std::span<const TypeId> arguments) {
+  return intern(TypeForm::Struct, names_->intern(name), arguments);
+}
+
+TypeId TypeArena::structure(std::string_view name, std::initializer_list<TypeId> arguments) {
+  return structure(name, std::span<const TypeId>(arguments.begin(), arguments.size()));
+}
+
+TypeId TypeArena::generic(std::string_view name) {
+  return intern(TypeForm::Generic, names_->intern(name), {});
+}
+
+TypeForm TypeArena::form(TypeId type) const {
+  return record(type).form;
+}
+
+std::string_view TypeArena::name(TypeId type) const {
+  return names_->text(record(type).name);
+}
+
+std::span<const TypeId> TypeArena::arguments(TypeId type) const {
+  const Record& entry = record(type);
+  return std::span<const TypeId>(arguments_).subspan(entry.first_argument, entry.argument_count);
+}
+
+bool TypeArena::has_parameters(TypeId type) const {
+  return record(type).has_parameters;
+}
+
+TypeId TypeArena::substitute(TypeId type, std::span<const TypeBinding> bindings) {
+  if (!has_parameters(type) || bindings.empty()) {
+    return type;
+  }
+
+  // The canonical form of the set keys the memo, so bindings given in another order share results.
+  std::vector<TypeBinding> sorted(bindings.begin(), bindings.end());
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](const TypeBinding& a, const TypeBinding& b) { return a.parameter < b.parameter; });
+  std::vector<TypeId> pairs{};
+  pairs.reserve(2 * sorted.size());
+  for (const TypeBinding& binding : sorted) {
+    if (pairs.empty() || pairs[pairs.size() - 2] != binding.parameter) {
+      pairs.push_back(binding.parameter);
+      pairs.push_back(binding.replacement);
+    }
+  }
+  const auto set = binding_sets_.try_emplace(std::move(pairs), static_cast<std::uint32_t>(binding_sets_.size()));
+  return substitute_with(type, set.first->second, set.first->first);
+}
+
+TypeId TypeArena::substitute(TypeId type, std::initializer_list<TypeBinding> bindings) {
+  return substitute(type, std::span<const TypeBinding>(bindings.begin(), bindings.size()));
+}
+
+TypeId TypeArena::substitute_with(TypeId type, std::uint32_t binding_set, std::span<const TypeId> pairs) {
+  const Record entry = record(type);
+  if (!entry.has_parameters) {
+    return type;
+  }
+  const std::uint64_t key = std::uint64_t{type} << 32 | binding_set;
+  if (const auto found = substitutions_.find(key); found != substitutions_.end()) {
+    return found->second;
+  }
+
+  TypeId result = type;
+  if (entry.form == TypeForm::Generic) {
+    std::size_t low = 0;
+    std::size_t high = pairs.size() / 2;
+    while (low < high) {
+      const std::size_t middle = (low + high) / 2;
+      if (pairs[2 * middle] < type) {
+        low = middle + 1;
+      } else {
+        high = middle;
+      }
+    }
+    if (low < pairs.size() / 2 && pairs[2 * low] == type) {
+      result = pairs[2 * low + 1];
+    }
+  } else {
+    // Interning while recursing may move arguments_, so the list is copied first.
+    const auto original = arguments(type);
+    std::vector<TypeId> replaced(original.begin(), original.end());
+    for (TypeId& argument : replaced) {
+      argument = substitute_with(argument, binding_set, pairs);
+    }
+    result = intern(entry.form, entry.name, replaced);
+  }
+  substitutions_.emplace(key, result);
+  return result;
+}
+
+std::string TypeArena::to_string(TypeId type) const {
+  const Record& entry = record(type);
+  const auto spell_list = [this](std::string& out, std::span<const TypeId> types) {
+    for (std::size_t i = 0; i < types.size(); ++i) {
+      if (i != 0) {
+        out += ", ";
+      }
+      out += to_string(types[i]);
+    }
+  };
+
+  switch (entry.form) {
+    case TypeForm::Function: {
+      const auto types = arguments(type);
+      std::string out = "fn(";
+      spell_list(out, types.subspan(1));
+      return out + ") -> " + to_string(types.front());
+    }
+    case TypeForm::Struct: {
+      std::string out(name(type));
+      if (entry.argument_count != 0) {
+        out += '<';
+        spell_list(out, arguments(type));
+        out += '>';
+      }
+      return out;
+    }
+    case TypeForm::Generic:
+      return std::string(name(type));
+    default:
+      return std::string(builtin_name(entry.form));
+  }
+}
+
+TypeId TypeArena::intern(TypeForm form, support::Symbol name, std::span<const TypeId> arguments) {
+  const std::uint64_t hash = hash_type(form, name, arguments);
+  std::size_t slot = probe(form, name, arguments, hash);
+  if (slots_[slot] != kNoType) {
+    return slots_[slot];
+  }
+  if (records_.size() >= kNoType - 1) {
+    throw std::length_error("too many types");
+  }
+
+  bool has_parameters = form == TypeForm::Generic;
+  for (const TypeId argument : arguments) {
+    has_parameters = has_parameters || record(argument).has_parameters;
+  }
+
+  const std::size_t first = arguments_.size();
+  const std::less<const TypeId*> before{};
+  if (!arguments.empty() && !before(arguments.data(), arguments_.data()) &&
+      before(arguments.data(), arguments_.data() + arguments_.size())) {
+    // `arguments` lives in arguments_, which appending may reallocate.
+    const std::vector<TypeId> copy(arguments.begin(), arguments.end());
+    arguments_.insert(arguments_.end(), copy.begin(), copy.end());
+  } else {
+    arguments_.insert(arguments_.end(), arguments.begin(), arguments.end());
+  }
+
+  const auto id = static_cast<TypeId>(records_.size());
+  records_.push_back(Record{.form = form,
+                            .has_parameters = has_parameters,
+                            .name = name,
+                            .first_argument = static_cast<std::uint32_t>(first),
+                            .argument_count = static_cast<std::uint32_t>(arguments_.size() - first),
+                            .hash = hash});
+  if (2 * records_.size() > slots_.size()) {
+    grow();
+  } else {
+    slots_[slot] = id;
+  }
+  return id;
+}
+
+const TypeArena::Record& TypeArena::record(TypeId type) const {
+  if (type >= records_.size()) {
+    throw std::out_of_range("type id was not issued by this arena");
+  }
+  return records_[type];
+}
+
+std::size_t TypeArena::probe(TypeForm form, support::Symbol name, std::span<const TypeId> arguments,
+                             std::uint64_t hash) const noexcept {
+  const std::size_t mask = slots_.size() - 1;
+  std::size_t slot = static_cast<std::size_t>(hash) & mask;
+  while (slots_[slot] != kNoType) {
+    const Record& entry = records_[slots_[slot]];
+    if (entry.hash == hash && entry.form == form && entry.name == name && entry.argument_count == arguments.size() &&
+        std::equal(arguments.begin(), arguments.end(), arguments_.begin() + entry.first_argument)) {
+      return slot;
+    }
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+// Rehashes every record, including one just appended but not yet placed.
+void TypeArena::grow() {
+  slots_.assign(2 * slots_.size(), kNoType);
+  const std::size_t mask = slots_.size() - 1;
+  for (TypeId id = 0; id < records_.size(); ++id) {
+    std::size_t slot = static_cast<std::size_t>(records_[id].hash) & mask;
+    while (slots_[slot] != kNoType) {
+      slot = (slot + 1) & mask;
+    }
+    slots_[slot] = id;
+  }
+}
+
+}  // namespace istudio::sem
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <map>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "support/string_interner.h"
+
+namespace istudio::sem {
+
+// A type interned in a TypeArena. Within one arena, equal ids are equal types.
+using TypeId = std::uint32_t;
+
+// Builtins come first: every arena interns them up front at the id of the same number, so builtin_type() names
+// them without an arena.
+enum class TypeForm : std::uint8_t {
+  Unknown,
+  Void,
+  Bool,
+  I32,
+  I64,
+  F32,
+  F64,
+  String,
+  // Arguments: the result, then the parameters.
+  Function,
+  // A named type, with type arguments when it instantiates a generic one, e.g. Pair<T>.
+  Struct,
+  // A type parameter, e.g. the T of Pair<T>.
+  Generic,
+};
+
+[[nodiscard]] constexpr TypeId builtin_type(TypeForm form) noexcept {
+  return static_cast<TypeId>(form);
+}
+
+[[nodiscard]] constexpr bool is_builtin_type(TypeId type) noexcept {
+  return type <= builtin_type(TypeForm::String);
+}
+
+// A type parameter and what substitute() replaces it with.
+struct TypeBinding {
+  TypeId parameter{0};
+  TypeId replacement{0};
+};
+
+// Interns every structural type once (hash-consing), so equal types get equal ids and compare as integers
+// however deeply they nest, and a type costs four bytes to store or copy. Interned types never change and are
+// never freed; the arena only grows. Not thread-safe.
+class TypeArena {
+ public:
+  explicit TypeArena(std::shared_ptr<support::StringInterner> names = std::make_shared<support::StringInterner>());
+
+  [[nodiscard]] TypeId function(TypeId result, std::span<const TypeId> parameters);
+  [[nodiscard]] TypeId function(TypeId result, std::initializer_list<TypeId> parameters);
+  [[nodiscard]] TypeId structure(std::string_view name, std::span<const TypeId> arguments = {});
+  [[nodiscard]] TypeId structure(std::string_view name, std::initializer_list<TypeId> arguments);
+  [[nodiscard]] TypeId generic(std::string_view name);
+
+  // The accessors throw std::out_of_range for ids the arena did not issue.
+  [[nodiscard]] TypeForm form(TypeId type) const;
+  // Empty for builtins and functions.
+  [[nodiscard]] std::string_view name(TypeId type) const;
+  // Valid until the next type is interned.
+  [[nodiscard]] std::span<const TypeId> arguments(TypeId type) const;
+  // Whether a type parameter occurs in `type`.
+  [[nodiscard]] bool has_parameters(TypeId type) const;
+
+  // `type` with every parameter bound in `bindings` replaced, e.g. Pair<T> with T := i64 gives Pair<i64>; the
+  // first binding of a parameter wins. Results are memoized per type and set of bindings, and types without
+  // parameters are returned as they are.
+  [[nodiscard]] TypeId substitute(TypeId type, std::span<const TypeBinding> bindings);
+  [[nodiscard]] TypeId substitute(TypeId type, std::initializer_list<TypeBinding> bindings);
+
+  // Spelled like "i64", "Pair<T>" or "fn(i64, bool) -> void", for diagnostics and dumps.
+  [[nodiscard]] std::string to_string(TypeId type) const;
+
+  [[nodiscard]] std::size_t size() const noexcept { return records_.size(); }
+  [[nodiscard]] const std::shared_ptr<support::StringInterner>& names() const noexcept { return names_; }
+
+ private:
+  static constexpr TypeId kNoType = std::numeric_limits<TypeId>::max();
+
+  struct Record {
+    TypeForm form{TypeForm::Unknown};
+    bool has_parameters{false};
+    support::Symbol name{support::kNoSymbol};
+    std::uint32_t first_argument{0};
+    std::uint32_t argument_count{0};
+    std::uint64_t hash{0};
+  };
+
+  [[nodiscard]] TypeId intern(TypeForm form, support::Symbol name, std::span<const TypeId> arguments);
+  [[nodiscard]] const Record& record(TypeId type) const;
+  // Slot of the type equal to the one described, or the empty slot where it belongs.
+  [[nodiscard]] std::size_t probe(TypeForm form, support::Symbol name, std::span<const TypeId> arguments,
+                                  std::uint64_t hash) const noexcept;
+  void grow();
+  // `pairs` is the canonical form of binding set `binding_set`.
+  [[nodiscard]] TypeId substitute_with(TypeId type, std::uint32_t binding_set, std::span<const TypeId> pairs);
+
+  std::shared_ptr<support::StringInterner> names_;
+  std::vector<Record> records_{};
+  // Argument lists of all types, back to back.
+  std::vector<TypeId> arguments_{};
+  // Open-addressed ids, at most half full; kNoType marks empty slots.
+  std::vector<TypeId> slots_{};
+  // Binding sets substitute() has seen, canonicalized as sorted (parameter, replacement) pairs.
+  std::map<std::vector<TypeId>, std::uint32_t> binding_sets_{};
+  // Keyed by type << 32 | binding set.
+  std::unordered_map<std::uint64_t, TypeId> substitutions_{};
+};
+
+}  // namespace istudio::sem
@@ -0,0 +1,155 @@
+#include "sem/type_solver.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace istudio::sem {
+namespace {
+
+bool same_type(Type lhs, Type rhs) noexcept {
+  return lhs.kind == rhs.kind && (lhs.kind != TypeKind::Function || lhs.reference == rhs.reference);
+}
+
+}  // namespace
+
+TypeVariable TypeSolver::fresh() {
+  if (parents_.size() >= std::numeric_limits<TypeVariable>::max()) {
+    throw std::length_error("too many type variables");
+  }
+  const auto variable = static_cast<TypeVariable>(parents_.size());
+  parents_.push_back(variable);
+  classes_.emplace_back();
+  return variable;
+}
+
+TypeVariable TypeSolver::known(Type type, TypeSite origin) {
+  const TypeVariable variable = fresh();
+  classes_[variable].type = type;
+  classes_[variable].origin = origin;
+  return variable;
+}
+
+void TypeSolver::equate(TypeVariable expected, TypeVariable found, TypeSite site, ConstraintReason reason,
+                        front::NodeId node) {
+  (solving_ ? late_ : constraints_)
+      .push_back(Constraint{.expected = expected, .found = found, .site = site, .reason = reason, .node = node});
+}
+
+void TypeSolver::watch(TypeVariable variable, std::uint32_t watch) {
+  const TypeVariable root = find(variable);
+  if (classes_[root].type.kind != TypeKind::Unknown) {
+    ready_.push_back(Ready{.watch = watch, .variable = root});
+    return;
+  }
+  const auto index = static_cast<std::uint32_t>(watches_.size());
+  watches_.push_back(Watch{.id = watch, .next = kNoWatch});
+  Class& entry = classes_[root];
+  if (entry.last_watch == kNoWatch) {
+    entry.first_watch = index;
+  } else {
+    watches_[entry.last_watch].next = index;
+  }
+  entry.last_watch = index;
+}
+
+Type TypeSolver::type_of(TypeVariable variable) {
+  return classes_[find(variable)].type;
+}
+
+// Two passes: find the root, then point every variable on the path straight at it.
+TypeVariable TypeSolver::find(TypeVariable variable) {
+  TypeVariable root = variable;
+  while (parents_[root] != root) {
+    root = parents_[root];
+  }
+  while (parents_[variable] != root) {
+    const TypeVariable next = parents_[variable];
+    parents_[variable] = root;
+    variable = next;
+  }
+  return root;
+}
+
+void TypeSolver::begin_solving() {
+  std::stable_partition(constraints_.begin() + static_cast<std::ptrdiff_t>(next_constraint_), constraints_.end(),
+                        [](const Constraint& constraint) {
+                          return constraint.reason == ConstraintReason::Declaration ||
+                                 constraint.reason == ConstraintReason::Return;
+                        });
+  solving_ = true;
+}
+
+void TypeSolver::finish_solving() {
+  solving_ = false;
+  ready_.clear();
+  next_ready_ = 0;
+  late_.clear();
+  next_late_ = 0;
+}
+
+void TypeSolver::apply(const Constraint& constraint) {
+  TypeVariable expected = find(constraint.expected);
+  TypeVariable found = find(constraint.found);
+  if (expected == found) {
+    return;
+  }
+
+  const Type expected_type = classes_[expected].type;
+  const Type found_type = classes_[found].type;
+  const bool expected_known = expected_type.kind != TypeKind::Unknown;
+  const bool found_known = found_type.kind != TypeKind::Unknown;
+  if (expected_known && found_known) {
+    if (!same_type(expected_type, found_type)) {
+      mismatches_.push_back(TypeMismatch{.reason = constraint.reason,
+                                         .node = constraint.node,
+                                         .site = constraint.site,
+                                         .expected = expected_type,
+                                         .expected_origin = classes_[expected].origin,
+                                         .found = found_type,
+                                         .found_origin = classes_[found].origin});
+      return;
+    }
+  } else if (expected_known != found_known) {
+    // The unknown side learns its type now.
+    release_watches(expected_known ? found : expected);
+  }
+
+  // Union by rank; the surviving class keeps whichever type and origin is known, the expected side's first.
+  TypeVariable root = expected;
+  TypeVariable child = found;
+  if (classes_[expected].rank < classes_[found].rank) {
+    root = found;
+    child = expected;
+  } else if (classes_[expected].rank == classes_[found].rank) {
+    ++classes_[expected].rank;
+  }
+  parents_[child] = root;
+  Class& kept = classes_[root];
+  const Class& merged = classes_[child];
+  if (expected_known) {
+    kept.type = expected_type;
+    kept.origin = classes_[expected].origin;
+  } else if (found_known) {
+    kept.type = found_type;
+    kept.origin = classes_[found].origin;
+  }
+  if (merged.first_watch != kNoWatch) {
+    if (kept.last_watch == kNoWatch) {
+      kept.first_watch = merged.first_watch;
+    } else {
+      watches_[kept.last_watch].next = merged.first_watch;
+    }
+    kept.last_watch = merged.last_watch;
+  }
+}
+
+void TypeSolver::release_watches(TypeVariable root) {
+  Class& entry = classes_[root];
+  for (std::uint32_t index = entry.first_watch; index != kNoWatch; index = watches_[index].next) {
+    ready_.push_back(Ready{.watch = watches_[index].id, .variable = root});
+  }
+  entry.first_watch = kNoWatch;
+  entry.last_watch = kNoWatch;
+}
+
+}  // namespace istudio::sem
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "front/ast.h"
+#include "sem/types.h"
+#include "support/source_manager.h"
+#include "support/span.h"
+
+namespace istudio::sem {
+
+// Stands for the type of one or more nodes until TypeSolver::solve() settles it.
+using TypeVariable = std::uint32_t;
+
+// Where a constraint or a known type comes from.
+struct TypeSite {
+  support::Span span{};
+  support::FileId file{support::kInvalidFileId};
+};
+
+// Why two types must be equal; the analyzer words the diagnostic from this and the constraint's node.
+// Declaration and Return constraints define types; solve() applies them before the others, which use types, so
+// a mismatch is blamed on the use wherever it appears relative to the definition.
+enum class ConstraintReason : std::uint8_t {
+  // Node: the binary expression.
+  Operands,
+  // Node: the assignment.
+  Assignment,
+  // Node: the declared name.
+  Declaration,
+  // Node: the function.
+  Return,
+  // Node: the parameter.
+  Argument,
+  // Node: the call.
+  CallResult,
+};
+
+// A constraint solve() could not satisfy. Each side's origin is where its type was first known.
+struct TypeMismatch {
+  ConstraintReason reason{ConstraintReason::Operands};
+  front::NodeId node{std::numeric_limits<front::NodeId>::max()};
+  TypeSite site{};
+  Type expected{};
+  TypeSite expected_origin{};
+  Type found{};
+  TypeSite found_origin{};
+};
+
+// Solves type equalities with union-find: a variable's class shares one type, classes merge by rank and lookups
+// compress paths, so n variables and m constraints take near-linear time, O((n + m) a(n)) for the inverse
+// Ackermann function a, whatever order they were recorded in. A constraint between two classes of different
+// known types is a mismatch, leaves both classes as they are and is reported once; the solver never guesses
+// between them.
+class TypeSolver {
+ public:
+  [[nodiscard]] TypeVariable fresh();
+  // A variable already known to be `type`, e.g. a literal's.
+  [[nodiscard]] TypeVariable known(Type type, TypeSite origin);
+
+  // Records that `expected` and `found` have the same type. Checked by solve(), definitions first and otherwise
+  // in the order recorded.
+  void equate(TypeVariable expected, TypeVariable found, TypeSite site, ConstraintReason reason,
+              front::NodeId node);
+  // Has solve() call `resolved(watch, type)` once, when `variable` gets a known type; never if it does not.
+  void watch(TypeVariable variable, std::uint32_t watch);
+
+  // Applies every constraint. A watch fires as soon as its variable's type is known, before the next recorded
+  // constraint, and the constraints `resolved` records are applied right after it returns.
+  template <typename Resolved>
+  void solve(Resolved&& resolved) {
+    begin_solving();
+    for (;;) {
+      if (next_late_ < late_.size()) {
+        apply(late_[next_late_++]);
+      } else if (next_ready_ < ready_.size()) {
+        const std::uint32_t watch = ready_[next_ready_].watch;
+        const Type type = type_of(ready_[next_ready_].variable);
+        ++next_ready_;
+        resolved(watch, type);
+      } else if (next_constraint_ < constraints_.size()) {
+        apply(constraints_[next_constraint_++]);
+      } else {
+        break;
+      }
+    }
+    finish_solving();
+  }
+
+  // Type{} while the variable's type is unknown.
+  [[nodiscard]] Type type_of(TypeVariable variable);
+  [[nodiscard]] const std::vector<TypeMismatch>& mismatches() const noexcept { return mismatches_; }
+  [[nodiscard]] std::size_t size() const noexcept { return parents_.size(); }
+
+ private:
+  static constexpr std::uint32_t kNoWatch = std::numeric_limits<std::uint32_t>::max();
+
+  // Meaningful for class representatives only.
+  struct Class {
+    Type type{};
+    TypeSite origin{};
+    // Watches waiting for the type, linked through Watch::next.
+    std::uint32_t first_watch{kNoWatch};
+    std::uint32_t last_watch{kNoWatch};
+    std::uint8_t rank{0};
+  };
+  struct Watch {
+    std::uint32_t id{0};
+    std::uint32_t next{kNoWatch};
+  };
+  struct Ready {
+    std::uint32_t watch{0};
+    TypeVariable variable{0};
+  };
+  struct Constraint {
+    TypeVariable expected{0};
+    TypeVariable found{0};
+    TypeSite site{};
+    ConstraintReason reason{ConstraintReason::Operands};
+    front::NodeId node{0};
+  };
+
+  [[nodiscard]] TypeVariable find(TypeVariable variable);
+  void begin_solving();
+  void finish_solving();
+  void apply(const Constraint& constraint);
+  // Moves the watches of `root`'s class to ready_.
+  void release_watches(TypeVariable root);
+
+  std::vector<TypeVariable> parents_{};
+  std::vector<Class> classes_{};
+  std::vector<Watch> watches_{};
+  std::vector<Ready> ready_{};
+  std::size_t next_ready_{0};
+  std::vector<Constraint> constraints_{};
+  std::size_t next_constraint_{0};
+  // Recorded while solving.
+  std::vector<Constraint> late_{};
+  std::size_t next_late_{0};
+  bool solving_{false};
+  std::vector<TypeMismatch> mismatches_{};
+};
+
+}  // namespace istudio::sem
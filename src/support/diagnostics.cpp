@@ -1,9 +1,11 @@
 #include "support/diagnostics.h"
 
+#include <algorithm>
+
 namespace istudio::support {
 
 void DiagnosticReporter::report(DiagCode code, std::string message, Span span) {
-  diagnostics_.push_back(Diagnostic{.code = code, .message = std::move(message), .span = span, .notes = {}});
+  diagnostics_.push_back(Diagnostic{.code = code, .message = std::move(message), .span = span, .notes = {}, .file = file_});
 }
 
 std::string_view to_string(DiagCode code) {
@@ -12,6 +14,12 @@ std::string_view to_string(DiagCode code) {
       return "GenericNote";
     case DiagCode::LexUnknownToken:
       return "LexUnknownToken";
+    case DiagCode::ParseExpectedToken:
+      return "ParseExpectedToken";
+    case DiagCode::ParseExpectedExpression:
+      return "ParseExpectedExpression";
+    case DiagCode::ParseUnexpectedToken:
+      return "ParseUnexpectedToken";
     case DiagCode::SemDuplicateSymbol:
       return "SemDuplicateSymbol";
     case DiagCode::SemUnknownIdentifier:
@@ -24,4 +32,43 @@ std::string_view to_string(DiagCode code) {
   return "Unknown";
 }
 
+std::string format_diagnostic(const Diagnostic& diagnostic, const SourceManager& sources) {
+  std::string out{};
+  const bool located = diagnostic.file != kInvalidFileId && diagnostic.file < sources.file_count();
+  LineColumn start{};
+  if (located) {
+    start = sources.line_column(diagnostic.file, diagnostic.span.start);
+    out += sources.name(diagnostic.file) + ":" + std::to_string(start.line) + ":" + std::to_string(start.column) +
+           ": ";
+  }
+  out += to_string(diagnostic.code);
+  out += ": ";
+  out += diagnostic.message;
+  out.push_back('\n');
+
+  if (located) {
+    const std::string_view line = sources.line_text(diagnostic.file, start.line);
+    const std::size_t column = std::min<std::size_t>(start.column - 1, line.size());
+    const std::size_t width = std::clamp<std::size_t>(diagnostic.span.length(), 1, line.size() - column + 1);
+    out += "  ";
+    out += line;
+    out += "\n  ";
+    out.append(column, ' ');
+    out.push_back('^');
+    out.append(width - 1, '~');
+    out.push_back('\n');
+  }
+
+  for (const DiagnosticNote& note : diagnostic.notes) {
+    out += "  note: ";
+    if (note.file != kInvalidFileId && note.file < sources.file_count()) {
+      const LineColumn at = sources.line_column(note.file, note.span.start);
+      out += sources.name(note.file) + ":" + std::to_string(at.line) + ":" + std::to_string(at.column) + ": ";
+    }
+    out += note.message;
+    out.push_back('\n');
+  }
+  return out;
+}
+
 }  // namespace istudio::support
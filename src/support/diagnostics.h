@@ -2,8 +2,10 @@
 
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
+#include "support/source_manager.h"
 #include "support/span.h"
 
 namespace istudio::support {
@@ -11,28 +13,52 @@ namespace istudio::support {
 enum class DiagCode {
   GenericNote = 0,
   LexUnknownToken = 1000,
+  ParseExpectedToken = 1100,
+  ParseExpectedExpression = 1101,
+  ParseUnexpectedToken = 1102,
   SemDuplicateSymbol = 2000,
   SemUnknownIdentifier = 2001,
   SemTypeMismatch = 2002,
   SemArgumentCountMismatch = 2003,
 };
 
+// Extra context for a diagnostic, e.g. where a conflicting type came from. Located when `file` is known.
+struct DiagnosticNote {
+  std::string message{};
+  Span span{};
+  FileId file{kInvalidFileId};
+};
+
 struct Diagnostic {
   DiagCode code{DiagCode::GenericNote};
   std::string message{};
   Span span{};
-  std::vector<std::string> notes{};
+  std::vector<DiagnosticNote> notes{};
+  FileId file{kInvalidFileId};
 };
 
 class DiagnosticReporter {
  public:
+  DiagnosticReporter() = default;
+  // Diagnostics reported through this instance are attributed to `file`.
+  explicit DiagnosticReporter(FileId file) : file_(file) {}
+
   void report(DiagCode code, std::string message, Span span);
+  // Appends a diagnostic as is, keeping its file; e.g. one collected by another reporter.
+  void add(Diagnostic diagnostic) { diagnostics_.push_back(std::move(diagnostic)); }
   [[nodiscard]] const std::vector<Diagnostic>& diagnostics() const noexcept { return diagnostics_; }
+  [[nodiscard]] FileId file() const noexcept { return file_; }
 
  private:
   std::vector<Diagnostic> diagnostics_{};
+  FileId file_{kInvalidFileId};
 };
 
 std::string_view to_string(DiagCode code);
 
+// Renders "file:line:column: Code: message" followed by the offending source line, a caret underline and
+// any notes, each as "note: file:line:column: message" when located. Without a known file only the code and
+// message are printed.
+[[nodiscard]] std::string format_diagnostic(const Diagnostic& diagnostic, const SourceManager& sources);
+
 }  // namespace istudio::support
@@ -0,0 +1,69 @@
+#include "support/file_bytes.h"
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define ISTUDIO_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace istudio::support {
+namespace {
+
+std::string describe(std::string_view what, const std::filesystem::path& path) {
+  return std::string(what) + " '" + path.string() + "'";
+}
+
+#if defined(ISTUDIO_HAVE_MMAP)
+// Maps a regular, non-empty file read-only. Returns nullptr when mapping does not apply (empty or special
+// files), leaving the caller to fall back to reading.
+std::shared_ptr<const void> map_file(const std::filesystem::path& path, std::string_view what, std::size_t& size) {
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("cannot open " + describe(what, path));
+  }
+  struct stat info {};
+  if (::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size <= 0) {
+    ::close(fd);
+    return nullptr;
+  }
+  size = static_cast<std::size_t>(info.st_size);
+  void* address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (address == MAP_FAILED) {
+    return nullptr;
+  }
+  return {address, [size](const void* mapped) { ::munmap(const_cast<void*>(mapped), size); }};
+}
+#endif
+
+}  // namespace
+
+FileBytes read_file_bytes(const std::filesystem::path& path, std::string_view what) {
+#if defined(ISTUDIO_HAVE_MMAP)
+  std::size_t size = 0;
+  if (auto mapping = map_file(path, what, size)) {
+    const std::string_view bytes{static_cast<const char*>(mapping.get()), size};
+    return FileBytes{.bytes = bytes, .storage = std::move(mapping)};
+  }
+#endif
+  std::ifstream in{path, std::ios::binary};
+  if (!in) {
+    throw std::runtime_error("cannot open " + describe(what, path));
+  }
+  auto text = std::make_shared<const std::string>(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+  if (in.bad()) {
+    throw std::runtime_error("cannot read " + describe(what, path));
+  }
+  const std::string_view bytes{*text};
+  return FileBytes{.bytes = bytes, .storage = std::move(text)};
+}
+
+}  // namespace istudio::support
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string_view>
+
+namespace istudio::support {
+
+// The contents of a file, memory-mapped read-only where the platform allows it and read into memory otherwise.
+struct FileBytes {
+  std::string_view bytes{};
+  // Keeps `bytes` alive: either a mapping or an owned string.
+  std::shared_ptr<const void> storage{};
+};
+
+// `what` names the file in error messages ("source file", ...). Throws std::runtime_error if the file cannot be
+// opened or read.
+[[nodiscard]] FileBytes read_file_bytes(const std::filesystem::path& path, std::string_view what);
+
+}  // namespace istudio::support
@@ -0,0 +1,102 @@
+#include "support/source_manager.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "front/scan.h"
+#include "support/file_bytes.h"
+
+namespace istudio::support {
+namespace {
+
+void check_size(std::size_t size, const std::string& name) {
+  if (size > std::numeric_limits<std::uint32_t>::max()) {
+    throw std::length_error("source file '" + name + "' exceeds the 4 GiB limit");
+  }
+}
+
+}  // namespace
+
+FileId SourceManager::load_file(const std::filesystem::path& path) {
+  FileBytes contents = read_file_bytes(path, "source file");
+  check_size(contents.bytes.size(), path.string());
+  return add_file(path.string(), contents.bytes, std::move(contents.storage));
+}
+
+FileId SourceManager::add_buffer(std::string name, std::string text) {
+  auto contents = std::make_shared<const std::string>(std::move(text));
+  const std::string_view view{*contents};
+  return add_file(std::move(name), view, std::move(contents));
+}
+
+FileId SourceManager::add_file(std::string name, std::string_view text, std::shared_ptr<const void> storage) {
+  check_size(text.size(), name);
+  if (files_.size() >= kInvalidFileId) {
+    throw std::length_error("too many source files");
+  }
+
+  // Count first so the table is allocated exactly once; both passes run at vector width.
+  const front::ScanKernels& scan = front::scan_kernels();
+  std::vector<std::uint32_t> line_starts(scan.count_newlines(text.data(), text.size()) + 1);
+  line_starts[0] = 0;
+  scan.collect_line_starts(text.data(), text.size(), line_starts.data() + 1);
+
+  files_.push_back(File{.name = std::move(name), .text = text, .storage = std::move(storage),
+                        .line_starts = std::move(line_starts)});
+  return static_cast<FileId>(files_.size() - 1);
+}
+
+const SourceManager::File& SourceManager::file(FileId file) const {
+  if (file >= files_.size()) {
+    throw std::out_of_range("unknown source file id");
+  }
+  return files_[file];
+}
+
+std::string_view SourceManager::text(FileId file) const {
+  return this->file(file).text;
+}
+
+const std::string& SourceManager::name(FileId file) const {
+  return this->file(file).name;
+}
+
+std::size_t SourceManager::line_count(FileId file) const {
+  return this->file(file).line_starts.size();
+}
+
+std::size_t SourceManager::line_start(FileId file, std::uint32_t line) const {
+  const File& entry = this->file(file);
+  if (line == 0 || line > entry.line_starts.size()) {
+    throw std::out_of_range("line number out of range");
+  }
+  return entry.line_starts[line - 1];
+}
+
+std::string_view SourceManager::line_text(FileId file, std::uint32_t line) const {
+  const File& entry = this->file(file);
+  const std::size_t start = line_start(file, line);
+  std::size_t end = line < entry.line_starts.size() ? entry.line_starts[line] : entry.text.size();
+  while (end > start && (entry.text[end - 1] == '\n' || entry.text[end - 1] == '\r')) {
+    --end;
+  }
+  return entry.text.substr(start, end - start);
+}
+
+LineColumn SourceManager::line_column(FileId file, std::size_t offset) const {
+  const File& entry = this->file(file);
+  offset = std::min(offset, entry.text.size());
+  const auto next_line = std::upper_bound(entry.line_starts.begin(), entry.line_starts.end(), offset);
+  const auto line = static_cast<std::size_t>(next_line - entry.line_starts.begin());
+  const std::size_t column = offset - entry.line_starts[line - 1] + 1;
+  return LineColumn{.line = static_cast<std::uint32_t>(line), .column = static_cast<std::uint32_t>(column)};
+}
+
+std::size_t SourceManager::offset_of(FileId file, LineColumn position) const {
+  const std::size_t start = line_start(file, position.line);
+  const std::size_t length = line_text(file, position.line).size();
+  return start + std::min<std::size_t>(position.column == 0 ? 0 : position.column - 1, length);
+}
+
+}  // namespace istudio::support
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace istudio::support {
+
+using FileId = std::uint32_t;
+inline constexpr FileId kInvalidFileId = std::numeric_limits<FileId>::max();
+
+// 1-based line and byte column.
+struct LineColumn {
+  std::uint32_t line{1};
+  std::uint32_t column{1};
+};
+
+// Owns the text of every input file and maps file-relative offsets to lines and columns. Files are
+// memory-mapped where the platform allows it; texts stay valid and unmoved for the manager's lifetime.
+class SourceManager {
+ public:
+  // Throws std::runtime_error if the file cannot be read and std::length_error if it exceeds 4 GiB.
+  FileId load_file(const std::filesystem::path& path);
+  // Registers an in-memory buffer, e.g. an editor document.
+  FileId add_buffer(std::string name, std::string text);
+
+  [[nodiscard]] std::string_view text(FileId file) const;
+  [[nodiscard]] const std::string& name(FileId file) const;
+  [[nodiscard]] std::size_t file_count() const noexcept { return files_.size(); }
+
+  [[nodiscard]] std::size_t line_count(FileId file) const;
+  // Offset of the first byte of 1-based `line`.
+  [[nodiscard]] std::size_t line_start(FileId file, std::uint32_t line) const;
+  // Text of 1-based `line` without its line terminator.
+  [[nodiscard]] std::string_view line_text(FileId file, std::uint32_t line) const;
+  // O(log lines). Offsets past the end map to the end of the last line.
+  [[nodiscard]] LineColumn line_column(FileId file, std::size_t offset) const;
+  // Inverse of line_column; columns past the end of the line clamp to it.
+  [[nodiscard]] std::size_t offset_of(FileId file, LineColumn position) const;
+
+ private:
+  struct File {
+    std::string name{};
+    std::string_view text{};
+    // Keeps `text` alive: either a mapping or an owned string.
+    std::shared_ptr<const void> storage{};
+    // line_starts[i] is the offset of line i + 1; always starts with 0.
+    std::vector<std::uint32_t> line_starts{};
+  };
+
+  FileId add_file(std::string name, std::string_view text, std::shared_ptr<const void> storage);
+  [[nodiscard]] const File& file(FileId file) const;
+
+  std::vector<File> files_{};
+};
+
+}  // namespace istudio::support
@@ -1,19 +1,29 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <ostream>
 
 namespace istudio::support {
 
+// Half-open byte range within one file. Offsets are file-relative and 32-bit (sources are capped at 4 GiB);
+// the owning file is tracked alongside, e.g. by Diagnostic::file or the AstContext.
 struct Span {
-  std::size_t start{0};
-  std::size_t end{0};
+  std::uint32_t start{0};
+  std::uint32_t end{0};
 
   [[nodiscard]] constexpr std::size_t length() const noexcept {
     return end >= start ? end - start : 0;
   }
 };
 
+static_assert(sizeof(Span) == 8);
+
+// Builds a span from size_t offsets that the caller has already bounded to 32 bits.
+[[nodiscard]] constexpr Span make_span(std::size_t start, std::size_t end) noexcept {
+  return Span{static_cast<std::uint32_t>(start), static_cast<std::uint32_t>(end)};
+}
+
 inline std::ostream& operator<<(std::ostream& os, const Span& span) {
   os << '[' << span.start << ", " << span.end << ')';
   return os;
@@ -0,0 +1,150 @@
+#include "support/string_interner.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+namespace istudio::support {
+namespace {
+
+constexpr std::size_t kStringChunkSize = 16 * 1024;
+constexpr std::size_t kInitialSlots = 64;
+
+struct Hashed {
+  std::size_t shard{0};
+  std::uint32_t hash{0};
+};
+
+template <std::size_t ShardBits>
+Hashed hash_text(std::string_view text) noexcept {
+  // Low bits pick the shard, the rest probe within it.
+  const std::size_t hash = std::hash<std::string_view>{}(text);
+  return Hashed{.shard = hash & ((std::size_t{1} << ShardBits) - 1),
+                .hash = static_cast<std::uint32_t>(hash >> ShardBits)};
+}
+
+}  // namespace
+
+std::size_t StringInterner::probe(const Shard& shard, std::string_view text, std::uint32_t hash) noexcept {
+  const std::size_t mask = shard.slots.size() - 1;
+  for (std::size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+    const Symbol symbol = shard.slots[slot];
+    if (symbol == kNoSymbol) {
+      return slot;
+    }
+    const std::size_t position = (symbol >> kShardBits) - 1;
+    if (shard.hashes[position] == hash && shard.strings[position] == text) {
+      return slot;
+    }
+  }
+}
+
+void StringInterner::grow(Shard& shard) {
+  std::vector<Symbol> slots(std::max(kInitialSlots, shard.slots.size() * 2), kNoSymbol);
+  const std::size_t mask = slots.size() - 1;
+  for (const Symbol symbol : shard.slots) {
+    if (symbol == kNoSymbol) {
+      continue;
+    }
+    std::size_t slot = shard.hashes[(symbol >> kShardBits) - 1] & mask;
+    while (slots[slot] != kNoSymbol) {
+      slot = (slot + 1) & mask;
+    }
+    slots[slot] = symbol;
+  }
+  shard.slots = std::move(slots);
+}
+
+std::string_view StringInterner::store(Shard& shard, std::string_view text) {
+  if (shard.chunk_capacity - shard.chunk_used < text.size()) {
+    shard.chunk_capacity = std::max(kStringChunkSize, text.size());
+    shard.chunks.push_back(std::make_unique<char[]>(shard.chunk_capacity));
+    shard.chunk_bytes += shard.chunk_capacity;
+    shard.chunk_used = 0;
+  }
+  char* slot = shard.chunks.back().get() + shard.chunk_used;
+  std::memcpy(slot, text.data(), text.size());
+  shard.chunk_used += text.size();
+  return {slot, text.size()};
+}
+
+Symbol StringInterner::intern(std::string_view text) {
+  if (text.empty()) {
+    return kNoSymbol;
+  }
+  const Hashed hashed = hash_text<kShardBits>(text);
+  Shard& shard = shards_[hashed.shard];
+  {
+    const std::shared_lock lock{shard.mutex};
+    if (!shard.slots.empty()) {
+      if (const Symbol found = shard.slots[probe(shard, text, hashed.hash)]; found != kNoSymbol) {
+        return found;
+      }
+    }
+  }
+
+  const std::unique_lock lock{shard.mutex};
+  if ((shard.strings.size() + 1) * 2 > shard.slots.size()) {
+    grow(shard);
+  }
+  const std::size_t slot = probe(shard, text, hashed.hash);
+  if (shard.slots[slot] != kNoSymbol) {
+    return shard.slots[slot];
+  }
+  if (shard.strings.size() >= (std::numeric_limits<Symbol>::max() >> kShardBits) - 1) {
+    throw std::length_error("string interner is full");
+  }
+  shard.strings.push_back(store(shard, text));
+  shard.hashes.push_back(hashed.hash);
+  const auto symbol = static_cast<Symbol>((shard.strings.size() << kShardBits) | hashed.shard);
+  shard.slots[slot] = symbol;
+  return symbol;
+}
+
+Symbol StringInterner::find(std::string_view text) const {
+  if (text.empty()) {
+    return kNoSymbol;
+  }
+  const Hashed hashed = hash_text<kShardBits>(text);
+  const Shard& shard = shards_[hashed.shard];
+  const std::shared_lock lock{shard.mutex};
+  return shard.slots.empty() ? kNoSymbol : shard.slots[probe(shard, text, hashed.hash)];
+}
+
+std::string_view StringInterner::text(Symbol symbol) const {
+  if (symbol == kNoSymbol) {
+    return {};
+  }
+  const Shard& shard = shards_[symbol & (kShardCount - 1)];
+  const std::size_t position = (symbol >> kShardBits) - 1;
+  const std::shared_lock lock{shard.mutex};
+  if (position >= shard.strings.size()) {
+    throw std::out_of_range("unknown interned symbol");
+  }
+  return shard.strings[position];
+}
+
+std::size_t StringInterner::size() const {
+  std::size_t total = 0;
+  for (const Shard& shard : shards_) {
+    const std::shared_lock lock{shard.mutex};
+    total += shard.strings.size();
+  }
+  return total;
+}
+
+std::size_t StringInterner::memory_bytes() const {
+  std::size_t total = 0;
+  for (const Shard& shard : shards_) {
+    const std::shared_lock lock{shard.mutex};
+    total += shard.slots.capacity() * sizeof(Symbol) + shard.strings.capacity() * sizeof(std::string_view) +
+             shard.hashes.capacity() * sizeof(std::uint32_t);
+    total += shard.chunk_bytes;
+  }
+  return total;
+}
+
+}  // namespace istudio::support
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string_view>
+#include <vector>
+
+namespace istudio::support {
+
+// Interned string id. Ids are only meaningful together with the interner that issued them.
+using Symbol = std::uint32_t;
+// The empty string; also "no symbol" for names that were never interned.
+inline constexpr Symbol kNoSymbol = 0;
+
+// Thread-safe string interner. Each distinct string is stored once and keeps a stable id and a stable
+// text view for the interner's lifetime, so names compare and hash as integers. Sharded by hash so
+// concurrent lexer threads rarely contend.
+class StringInterner {
+ public:
+  StringInterner() = default;
+  StringInterner(const StringInterner&) = delete;
+  StringInterner& operator=(const StringInterner&) = delete;
+
+  Symbol intern(std::string_view text);
+  // Id of `text` if it was interned, kNoSymbol otherwise.
+  [[nodiscard]] Symbol find(std::string_view text) const;
+  // Throws std::out_of_range for ids this interner did not issue.
+  [[nodiscard]] std::string_view text(Symbol symbol) const;
+
+  // Number of distinct non-empty strings.
+  [[nodiscard]] std::size_t size() const;
+  // Approximate heap bytes held for string storage and lookup tables.
+  [[nodiscard]] std::size_t memory_bytes() const;
+
+ private:
+  // Ids are (index within shard + 1) << kShardBits | shard.
+  static constexpr unsigned kShardBits = 4;
+  static constexpr std::size_t kShardCount = std::size_t{1} << kShardBits;
+
+  // Open-addressed table of ids (linear probing, at most half full) over the shard's strings, which keep
+  // their hash for probing and rehashing: about 28 bytes per entry besides the text.
+  struct Shard {
+    mutable std::shared_mutex mutex{};
+    std::vector<Symbol> slots{};
+    std::vector<std::string_view> strings{};
+    std::vector<std::uint32_t> hashes{};
+    std::vector<std::unique_ptr<char[]>> chunks{};
+    std::size_t chunk_used{0};
+    std::size_t chunk_capacity{0};
+    // Total size of `chunks`; texts longer than a chunk get a chunk of their own size.
+    std::size_t chunk_bytes{0};
+  };
+
+  // Slot holding `text`, or the empty slot where it belongs.
+  [[nodiscard]] static std::size_t probe(const Shard& shard, std::string_view text, std::uint32_t hash) noexcept;
+  static void grow(Shard& shard);
+  [[nodiscard]] static std::string_view store(Shard& shard, std::string_view text);
+
+  std::array<Shard, kShardCount> shards_{};
+};
+
+}  // namespace istudio::support
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace istudio::support {
+
+// Fixed-size pool of worker threads draining a FIFO queue. The destructor finishes queued work and joins.
+class ThreadPool {
+ public:
+  // `threads == 0` uses one worker per hardware thread.
+  explicit ThreadPool(std::size_t threads = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  [[nodiscard]] std::size_t size() const noexcept { return workers_.size(); }
+
+  // Queues `task`; exceptions it throws are rethrown from the returned future's get().
+  template <typename Task>
+  [[nodiscard]] std::future<std::invoke_result_t<Task&>> submit(Task task) {
+    auto packaged = std::make_shared<std::packaged_task<std::invoke_result_t<Task&>()>>(std::move(task));
+    auto future = packaged->get_future();
+    enqueue([packaged] { (*packaged)(); });
+    return future;
+  }
+
+ private:
+  void enqueue(std::function<void()> job);
+  void worker_loop();
+
+  std::vector<std::thread> workers_{};
+  std::deque<std::function<void()>> queue_{};
+  std::mutex mutex_{};
+  std::condition_variable ready_{};
+  bool stopping_{false};
+};
+
+}  // namespace istudio::support
@@ -40,16 +40,17 @@ const GeneratedFile* find_file(const std::vector<GeneratedFile>& files, std::str
 
 void test_cpp_backend_emits_structs_and_functions() {
   IRModule module("SampleModule");
+  const IRType parameter{module.types().generic("T")};
   module.add_struct(
       "Pair",
-      {IRField{.name = "first", .type = IRType::Generic("T")},
-       IRField{.name = "second", .type = IRType::Generic("T")}},
+      {IRField{.name = "first", .type = parameter},
+       IRField{.name = "second", .type = parameter}},
       {"T"});
 
   auto& fn =
-      module.add_function("add_values", IRType::Generic("T"),
-                          {IRParameter{.name = "a", .type = IRType::Generic("T")},
-                           IRParameter{.name = "b", .type = IRType::Generic("T")}},
+      module.add_function("add_values", parameter,
+                          {IRParameter{.name = "a", .type = parameter},
+                           IRParameter{.name = "b", .type = parameter}},
                           {"T"});
   fn.add_instruction(IRValue{.result = "sum", .op = "add", .operands = {"a", "b"}});
   fn.add_instruction(IRValue{.op = "ret", .operands = {"sum"}});
@@ -0,0 +1,81 @@
+#include "alloc_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace istudio::bench {
+namespace {
+
+// Every block is prefixed with its size so unsized deletes can still update the live byte count.
+constexpr std::size_t kHeaderSize = alignof(std::max_align_t);
+
+std::atomic<std::size_t> g_allocations{0};
+std::atomic<std::size_t> g_bytes{0};
+std::atomic<std::size_t> g_live_bytes{0};
+std::atomic<std::size_t> g_peak_bytes{0};
+
+void* counted_alloc(std::size_t size) {
+  void* raw = std::malloc(size + kHeaderSize);
+  if (raw == nullptr) {
+    throw std::bad_alloc{};
+  }
+  *static_cast<std::size_t*>(raw) = size;
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  g_bytes.fetch_add(size, std::memory_order_relaxed);
+  const std::size_t live = g_live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+  std::size_t peak = g_peak_bytes.load(std::memory_order_relaxed);
+  while (live > peak && !g_peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+  }
+  return static_cast<char*>(raw) + kHeaderSize;
+}
+
+void counted_free(void* ptr) noexcept {
+  if (ptr == nullptr) {
+    return;
+  }
+  void* raw = static_cast<char*>(ptr) - kHeaderSize;
+  g_live_bytes.fetch_sub(*static_cast<std::size_t*>(raw), std::memory_order_relaxed);
+  std::free(raw);
+}
+
+}  // namespace
+
+AllocationStats allocation_stats() noexcept {
+  return AllocationStats{.allocations = g_allocations.load(std::memory_order_relaxed),
+                         .bytes = g_bytes.load(std::memory_order_relaxed),
+                         .live_bytes = g_live_bytes.load(std::memory_order_relaxed),
+                         .peak_bytes = g_peak_bytes.load(std::memory_order_relaxed)};
+}
+
+void reset_allocation_stats() noexcept {
+  g_allocations.store(0, std::memory_order_relaxed);
+  g_bytes.store(0, std::memory_order_relaxed);
+  g_peak_bytes.store(g_live_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+}  // namespace istudio::bench
+
+void* operator new(std::size_t size) {
+  return istudio::bench::counted_alloc(size);
+}
+
+void* operator new[](std::size_t size) {
+  return istudio::bench::counted_alloc(size);
+}
+
+void operator delete(void* ptr) noexcept {
+  istudio::bench::counted_free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  istudio::bench::counted_free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+  istudio::bench::counted_free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+  istudio::bench::counted_free(ptr);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+
+namespace istudio::bench {
+
+struct AllocationStats {
+  std::size_t allocations{0};
+  std::size_t bytes{0};
+  std::size_t live_bytes{0};
+  std::size_t peak_bytes{0};
+};
+
+// Counters maintained by the replacement global operator new/delete linked into the benchmark binary.
+[[nodiscard]] AllocationStats allocation_stats() noexcept;
+
+// Resets the allocation counters and restarts peak tracking from the current live size.
+void reset_allocation_stats() noexcept;
+
+}  // namespace istudio::bench
@@ -0,0 +1,536 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "alloc_counter.h"
+#include "corpus.h"
+#include "front/ast.h"
+#include "front/ast_binary.h"
+#include "front/lexer.h"
+#include "front/parser.h"
+#include "report.h"
+#include "sem/analyzer.h"
+#include "support/diagnostics.h"
+#include "support/source_manager.h"
+#include "support/string_interner.h"
+#include "support/thread_pool.h"
+
+using istudio::bench::allocation_stats;
+using istudio::bench::BenchReport;
+using istudio::bench::CorpusOptions;
+using istudio::bench::reset_allocation_stats;
+using istudio::front::AstContext;
+using istudio::front::AstKind;
+using istudio::front::Lexer;
+using istudio::front::lex;
+using istudio::front::NodeId;
+using istudio::front::SourceEdit;
+using istudio::front::TokenStream;
+
+namespace {
+
+// Best of this many runs: the minimum is the least noisy estimate of what the code costs.
+constexpr std::size_t kRepetitions = 5;
+
+struct Sample {
+  double seconds{std::numeric_limits<double>::max()};
+  std::size_t allocations{0};
+};
+
+// Times `body` kRepetitions times, keeping the fastest run and the allocations of one run.
+template <typename Body>
+Sample measure(Body&& body) {
+  Sample sample{};
+  for (std::size_t i = 0; i < kRepetitions; ++i) {
+    reset_allocation_stats();
+    const auto begin = std::chrono::steady_clock::now();
+    body();
+    const auto end = std::chrono::steady_clock::now();
+    sample.allocations = allocation_stats().allocations;
+    sample.seconds = std::min(sample.seconds, std::chrono::duration<double>(end - begin).count());
+  }
+  return sample;
+}
+
+struct NamedCorpus {
+  std::string name{};
+  CorpusOptions options{};
+};
+
+std::vector<NamedCorpus> corpora(std::size_t bytes) {
+  CorpusOptions base{};
+  base.target_bytes = bytes;
+  std::vector<NamedCorpus> result{{"default", base}};
+
+  CorpusOptions short_names = base;
+  short_names.min_identifier_length = 1;
+  short_names.mean_identifier_length = 3;
+  short_names.max_identifier_length = 8;
+  result.push_back({"short-names", short_names});
+
+  CorpusOptions long_names = base;
+  long_names.mean_identifier_length = 28;
+  long_names.max_identifier_length = 64;
+  result.push_back({"long-names", long_names});
+
+  CorpusOptions comments = base;
+  comments.comment_density = 0.9;
+  result.push_back({"comment-heavy", comments});
+
+  CorpusOptions deep = base;
+  deep.max_expression_depth = 10;
+  result.push_back({"deep-expressions", deep});
+
+  // Short names, no comments and deep operator chains: the parser's operator dispatch dominates.
+  CorpusOptions operators = deep;
+  operators.comment_density = 0.0;
+  operators.block_density = 0.0;
+  operators.min_identifier_length = 1;
+  operators.mean_identifier_length = 2;
+  operators.max_identifier_length = 4;
+  operators.vocabulary = 64;
+  result.push_back({"expression-heavy", operators});
+  return result;
+}
+
+void print_row(const std::string& name, double mb_per_s, double mtok_per_s, double mnodes_per_s,
+               double allocs_per_token) {
+  std::cout << std::left << std::setw(32) << name << std::right << std::fixed << std::setprecision(2)
+            << std::setw(10) << mb_per_s << " MB/s" << std::setw(10) << mtok_per_s << " Mtok/s";
+  if (mnodes_per_s > 0.0) {
+    std::cout << std::setw(10) << mnodes_per_s << " Mnode/s";
+  } else {
+    std::cout << std::setw(18) << "";
+  }
+  std::cout << std::setw(10) << allocs_per_token << " allocs/token\n";
+}
+
+// lex: source to TokenStream. parse: pre-lexed TokenStream to AST. frontend: streaming lex + parse, as the
+// driver runs them.
+void run_corpus_benchmarks(const NamedCorpus& corpus, BenchReport& report) {
+  const std::string source = istudio::bench::generate_corpus(corpus.options);
+  const auto tokens = lex(source);
+  std::size_t nodes = 0;
+  {
+    AstContext probe{};
+    istudio::front::parse_module(tokens, probe);
+    nodes = probe.size();
+  }
+
+  const double megabytes = static_cast<double>(source.size()) / (1024.0 * 1024.0);
+  const auto token_count = static_cast<double>(tokens.size());
+  const auto node_count = static_cast<double>(nodes);
+
+  const Sample lexing = measure([&] { static_cast<void>(lex(source)); });
+  const Sample parsing = measure([&] {
+    AstContext context{};
+    istudio::front::parse_module(tokens, context);
+  });
+  const Sample frontend = measure([&] {
+    AstContext context{};
+    Lexer lexer{source, {}};
+    istudio::front::parse_module(lexer, context);
+  });
+
+  const auto record = [&](const std::string& phase, const Sample& sample, bool builds_ast) {
+    const std::string name = phase + "/" + corpus.name;
+    const double mb_per_s = megabytes / sample.seconds;
+    const double mtok_per_s = token_count / sample.seconds / 1e6;
+    const double mnodes_per_s = builds_ast ? node_count / sample.seconds / 1e6 : 0.0;
+    const double allocs_per_token = static_cast<double>(sample.allocations) / token_count;
+    print_row(name, mb_per_s, mtok_per_s, mnodes_per_s, allocs_per_token);
+    if (builds_ast) {
+      report.add(name, {{"mb_per_s", mb_per_s},
+                        {"mtokens_per_s", mtok_per_s},
+                        {"mnodes_per_s", mnodes_per_s},
+                        {"allocs_per_token", allocs_per_token},
+                        {"bytes", static_cast<double>(source.size())},
+                        {"tokens", token_count},
+                        {"nodes", node_count}});
+    } else {
+      report.add(name, {{"mb_per_s", mb_per_s},
+                        {"mtokens_per_s", mtok_per_s},
+                        {"allocs_per_token", allocs_per_token},
+                        {"bytes", static_cast<double>(source.size())},
+                        {"tokens", token_count}});
+    }
+  };
+  record("lex", lexing, false);
+  record("parse", parsing, true);
+  record("frontend", frontend, true);
+}
+
+// Parses a corpus with one statement in kBrokenEvery missing its ';': every error is reported in one pass.
+void run_recovery_benchmark(BenchReport& report, std::size_t corpus_bytes) {
+  constexpr std::size_t kBrokenEvery = 64;
+  CorpusOptions options{};
+  options.target_bytes = corpus_bytes;
+  std::string source = istudio::bench::generate_corpus(options);
+  std::size_t statements = 0;
+  for (std::size_t at = source.find(";\n"); at != std::string::npos; at = source.find(";\n", at + 1)) {
+    if (++statements % kBrokenEvery == 0) {
+      source[at] = ' ';
+    }
+  }
+  const auto tokens = lex(source);
+
+  std::size_t errors = 0;
+  const Sample parsing = measure([&] {
+    AstContext context{};
+    istudio::support::DiagnosticReporter reporter{};
+    istudio::front::parse_module(tokens, context, reporter);
+    errors = reporter.diagnostics().size();
+  });
+
+  const double mb_per_s = static_cast<double>(source.size()) / (1024.0 * 1024.0) / parsing.seconds;
+  const double mtok_per_s = static_cast<double>(tokens.size()) / parsing.seconds / 1e6;
+  std::cout << std::left << std::setw(32) << "parse/broken-statements" << std::right << std::fixed
+            << std::setprecision(2) << std::setw(10) << mb_per_s << " MB/s" << std::setw(10) << mtok_per_s
+            << " Mtok/s" << std::setw(10) << errors << " errors\n";
+  report.add("parse/broken-statements", {{"mb_per_s", mb_per_s},
+                                         {"mtokens_per_s", mtok_per_s},
+                                         {"errors", static_cast<double>(errors)},
+                                         {"bytes", static_cast<double>(source.size())}});
+}
+
+// An editor session on a file of about 20k lines: a digit is typed into a number deep in the file and deleted
+// again, at kKeystrokes places, each keystroke relexed and reparsed incrementally. Compared with a full parse.
+void run_reparse_benchmark(BenchReport& report) {
+  constexpr std::size_t kKeystrokes = 256;
+  CorpusOptions options{};
+  options.target_bytes = 960 * 1024;
+  options.block_density = 0.2;
+  const std::string base = istudio::bench::generate_corpus(options);
+  const auto lines = static_cast<double>(std::count(base.begin(), base.end(), '\n'));
+
+  std::vector<std::size_t> positions{};
+  for (std::size_t i = 0; positions.size() < kKeystrokes; ++i) {
+    const std::size_t at = base.find(" = 1", (base.size() / kKeystrokes) * i);
+    positions.push_back(at + 3);
+  }
+
+  const Sample full = measure([&] {
+    AstContext context{};
+    istudio::front::parse_module(lex(base), context);
+  });
+
+  // Both versions of each edit stay alive for the streams viewing them.
+  std::vector<std::string> typed(positions.size());
+  for (std::size_t i = 0; i < positions.size(); ++i) {
+    typed[i] = base.substr(0, positions[i]) + "7" + base.substr(positions[i]);
+  }
+  AstContext context{};
+  istudio::support::DiagnosticReporter reporter{};
+  TokenStream tokens = lex(base);
+  const NodeId module = istudio::front::parse_module(tokens, context, reporter);
+  double relex_seconds = 0.0;
+  double reparse_seconds = 0.0;
+  const auto keystroke = [&](const std::string& source, const SourceEdit& edit) {
+    const auto begin = std::chrono::steady_clock::now();
+    tokens = istudio::front::relex(tokens, source, edit);
+    const auto relexed = std::chrono::steady_clock::now();
+    istudio::support::DiagnosticReporter next{};
+    istudio::front::reparse_module(tokens, context, module, edit, reporter.diagnostics(), next);
+    const auto end = std::chrono::steady_clock::now();
+    reporter = std::move(next);
+    relex_seconds += std::chrono::duration<double>(relexed - begin).count();
+    reparse_seconds += std::chrono::duration<double>(end - relexed).count();
+  };
+  for (std::size_t i = 0; i < positions.size(); ++i) {
+    const auto at = static_cast<std::uint32_t>(positions[i]);
+    keystroke(typed[i], SourceEdit{.range = {at, at}, .text = "7"});
+    keystroke(base, SourceEdit{.range = {at, at + 1}, .text = {}});
+  }
+
+  const auto edits = static_cast<double>(2 * positions.size());
+  const double relex_us = relex_seconds / edits * 1e6;
+  const double reparse_us = reparse_seconds / edits * 1e6;
+  const double full_us = full.seconds * 1e6;
+  std::cout << std::left << std::setw(32) << "reparse/keystroke" << std::right << std::fixed << std::setprecision(2)
+            << std::setw(10) << relex_us << " us relex" << std::setw(10) << reparse_us << " us reparse"
+            << std::setw(12) << full_us << " us full lex+parse (" << static_cast<std::size_t>(lines)
+            << " lines)\n";
+  report.add("reparse/keystroke", {{"relex_us", relex_us},
+                                   {"reparse_us", reparse_us},
+                                   {"full_us", full_us},
+                                   {"lines", lines},
+                                   {"nodes", static_cast<double>(context.size())}});
+}
+
+// A project of kFiles generated files sharing corpus_bytes, lexed and parsed into one forest by parse_files on
+// pools of growing size. Speedups are relative to the single-thread pool, so they only mean something on a
+// machine with that many cores.
+void run_multi_file_benchmark(BenchReport& report, std::size_t corpus_bytes) {
+  constexpr std::size_t kFiles = 800;
+  istudio::support::SourceManager sources{};
+  std::vector<istudio::support::FileId> files{};
+  std::size_t bytes = 0;
+  for (std::size_t i = 0; i < kFiles; ++i) {
+    CorpusOptions options{};
+    options.seed += i;
+    options.target_bytes = std::max<std::size_t>(corpus_bytes / kFiles, 1024);
+    options.vocabulary = 32;
+    std::string text = istudio::bench::generate_corpus(options);
+    bytes += text.size();
+    files.push_back(sources.add_buffer("file" + std::to_string(i) + ".ist", std::move(text)));
+  }
+
+  std::vector<std::size_t> thread_counts{1, 2, 4};
+  const std::size_t cores = std::max(1u, std::thread::hardware_concurrency());
+  if (std::find(thread_counts.begin(), thread_counts.end(), cores) == thread_counts.end()) {
+    thread_counts.push_back(cores);
+  }
+  double single_thread_seconds = 0.0;
+  for (const std::size_t threads : thread_counts) {
+    istudio::support::ThreadPool pool{threads};
+    std::size_t nodes = 0;
+    const Sample parsing = measure([&] {
+      istudio::support::DiagnosticReporter reporter{};
+      nodes = istudio::front::parse_files(sources, files, pool, reporter).size();
+    });
+    if (threads == 1) {
+      single_thread_seconds = parsing.seconds;
+    }
+    const std::string name = "parse-files/" + std::to_string(threads) + "-threads";
+    const double mb_per_s = static_cast<double>(bytes) / (1024.0 * 1024.0) / parsing.seconds;
+    const double speedup = single_thread_seconds / parsing.seconds;
+    std::cout << std::left << std::setw(32) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << mb_per_s << " MB/s" << std::setw(10) << speedup << " x    (" << kFiles
+              << " files, " << cores << " cores)\n";
+    report.add(name, {{"mb_per_s", mb_per_s},
+                      {"speedup", speedup},
+                      {"threads", static_cast<double>(threads)},
+                      {"files", static_cast<double>(kFiles)},
+                      {"bytes", static_cast<double>(bytes)},
+                      {"nodes", static_cast<double>(nodes)}});
+  }
+}
+
+// The default corpus written as an AST image and loaded back, against lexing and parsing it from source.
+void run_ast_image_benchmark(BenchReport& report, std::size_t corpus_bytes) {
+  CorpusOptions options{};
+  options.target_bytes = corpus_bytes;
+  const std::string source = istudio::bench::generate_corpus(options);
+  const auto interner = std::make_shared<istudio::support::StringInterner>();
+  const auto parse = [&](AstContext& context) {
+    istudio::front::LexerConfig config{};
+    config.interner = interner.get();
+    Lexer lexer{source, config};
+    return istudio::front::parse_module(lexer, context);
+  };
+  AstContext parsed{interner};
+  const NodeId root = parse(parsed);
+
+  std::string image{};
+  const Sample writing = measure([&] {
+    std::ostringstream out{};
+    istudio::front::write_ast_binary(parsed, root, out);
+    image = std::move(out).str();
+  });
+  // Loading maps the file, as a cache would; it is in the page cache after the first run.
+  const auto path = std::filesystem::temp_directory_path() / "istudio_bench.ast";
+  {
+    std::ofstream out{path, std::ios::binary};
+    out << image;
+  }
+  const Sample opening = measure([&] { static_cast<void>(istudio::front::AstImage::open(path)); });
+  const Sample loading = measure([&] {
+    AstContext context{interner};
+    istudio::front::load_ast_binary(istudio::front::AstImage::open(path), context);
+  });
+  std::filesystem::remove(path);
+  const Sample parsing = measure([&] {
+    AstContext context{interner};
+    parse(context);
+  });
+
+  const double image_mb = static_cast<double>(image.size()) / (1024.0 * 1024.0);
+  const double nodes = static_cast<double>(parsed.size());
+  const double speedup = parsing.seconds / loading.seconds;
+  std::cout << std::left << std::setw(32) << "ast-image/default" << std::right << std::fixed << std::setprecision(2)
+            << std::setw(10) << nodes / loading.seconds / 1e6 << " Mnode/s load" << std::setw(10)
+            << nodes / writing.seconds / 1e6 << " Mnode/s write" << std::setw(10) << speedup
+            << " x lex+parse (" << image_mb << " MB image, " << opening.seconds * 1e3 << " ms to map and check)\n";
+  report.add("ast-image/default", {{"load_mnodes_per_s", nodes / loading.seconds / 1e6},
+                                   {"write_mnodes_per_s", nodes / writing.seconds / 1e6},
+                                   {"parse_mnodes_per_s", nodes / parsing.seconds / 1e6},
+                                   {"load_speedup", speedup},
+                                   {"open_ms", opening.seconds * 1e3},
+                                   {"image_bytes", static_cast<double>(image.size())},
+                                   {"source_bytes", static_cast<double>(source.size())},
+                                   {"nodes", nodes}});
+}
+
+void run_structural_hash_benchmark(BenchReport& report, std::size_t corpus_bytes) {
+  CorpusOptions options{};
+  options.target_bytes = corpus_bytes;
+  const std::string source = istudio::bench::generate_corpus(options);
+  AstContext context{std::make_shared<istudio::support::StringInterner>()};
+  const NodeId root = istudio::front::parse_module(istudio::front::lex(source), context);
+  const Sample hashing = measure([&] { context.compute_structural_hashes(); });
+
+  // Statements and expressions repeated elsewhere in the module: what memoizing on the hash would save.
+  std::unordered_map<std::uint64_t, std::size_t> seen{};
+  for (NodeId id = 0; id <= root; ++id) {
+    ++seen[context.structural_hash(id)];
+  }
+  const double nodes = static_cast<double>(context.size());
+  const double repeated = nodes - static_cast<double>(seen.size());
+  std::cout << std::left << std::setw(32) << "hash/default" << std::right << std::fixed << std::setprecision(2)
+            << std::setw(10) << nodes / hashing.seconds / 1e6 << " Mnode/s" << std::setw(10)
+            << 100.0 * repeated / nodes << " % of subtrees repeated\n";
+  report.add("hash/default", {{"mnodes_per_s", nodes / hashing.seconds / 1e6},
+                              {"repeated_subtrees", repeated},
+                              {"nodes", nodes}});
+}
+
+// Call graphs built by hand, as the parser does not produce functions yet. As in a parsed tree, names are
+// interned and nodes are created in post-order, so walks over the context are linear scans.
+struct CallGraphBuilder {
+  AstContext context{std::make_shared<istudio::support::StringInterner>()};
+  std::vector<NodeId> functions{};
+  NodeId function_name{0};
+  NodeId parameters{0};
+
+  NodeId node(AstKind kind, const std::string& value = {}, const std::vector<NodeId>& children = {}) {
+    const NodeId id = context.create_node(kind, {}, value).id;
+    if (!children.empty()) {
+      context.set_children(id, children);
+    }
+    return id;
+  }
+  NodeId name(const std::string& text) {
+    return context.create_node(AstKind::IdentifierExpr, {}, text, context.interner()->intern(text)).id;
+  }
+  // A function without parameters: begin_function, then its statements, then end_function.
+  void begin_function(const std::string& text) {
+    function_name = name(text);
+    parameters = node(AstKind::ArgumentList);
+  }
+  void end_function(const std::vector<NodeId>& statements) {
+    const NodeId body = node(AstKind::BlockStmt, {}, statements);
+    functions.push_back(node(AstKind::Function, {}, {function_name, parameters, body}));
+  }
+  NodeId finish() { return node(AstKind::Module, {}, functions); }
+};
+
+// Best runs of analyze() and analyze_parallel() on `root`, each with a fresh analyzer.
+Sample measure_serial_analysis(const AstContext& context, NodeId root) {
+  return measure([&] {
+    istudio::support::DiagnosticReporter reporter{};
+    istudio::sem::SemanticAnalyzer analyzer{context, reporter};
+    analyzer.analyze(root);
+  });
+}
+
+Sample measure_parallel_analysis(const AstContext& context, NodeId root, istudio::support::ThreadPool& pool) {
+  return measure([&] {
+    istudio::support::DiagnosticReporter reporter{};
+    istudio::sem::SemanticAnalyzer analyzer{context, reporter};
+    analyzer.analyze_parallel(root, pool);
+  });
+}
+
+// Function f<i> returns f<i-1>(), for chains of growing depth: every function is its own level of the call
+// graph, which analyze_parallel runs on the calling thread, so its cost shows against analyze's and should
+// stay flat as the chain grows. What remains is the first phase: declaring every function and finding calls.
+void run_call_chain_benchmark(BenchReport& report) {
+  istudio::support::ThreadPool pool{std::max(1u, std::thread::hardware_concurrency())};
+  for (const std::size_t depth : {std::size_t{4096}, std::size_t{65536}}) {
+    CallGraphBuilder graph{};
+    for (std::size_t i = 0; i < depth; ++i) {
+      graph.begin_function("f" + std::to_string(i));
+      const NodeId value = i == 0 ? graph.node(AstKind::LiteralExpr, "1")
+                                  : graph.node(AstKind::CallExpr, {}, {graph.name("f" + std::to_string(i - 1))});
+      graph.end_function({graph.node(AstKind::ReturnStmt, {}, {value})});
+    }
+    const NodeId root = graph.finish();
+
+    const Sample serial = measure_serial_analysis(graph.context, root);
+    const Sample parallel = measure_parallel_analysis(graph.context, root, pool);
+    const std::string name = "analyze-chain/" + std::to_string(depth);
+    const double nodes = static_cast<double>(graph.context.size());
+    const double ratio = parallel.seconds / serial.seconds;
+    std::cout << std::left << std::setw(32) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << nodes / parallel.seconds / 1e6 << " Mnode/s" << std::setw(10) << ratio
+              << " x serial time (" << pool.size() << " threads)\n";
+    report.add(name, {{"mnodes_per_s", nodes / parallel.seconds / 1e6},
+                      {"serial_mnodes_per_s", nodes / serial.seconds / 1e6},
+                      {"parallel_per_serial", ratio},
+                      {"functions", static_cast<double>(depth)},
+                      {"nodes", nodes}});
+  }
+}
+
+// kFunctions functions that call nothing, each a run of lets summing into a return, on pools of growing size:
+// one level of the call graph, spread over the pool. Speedups are relative to analyze(), so they only exceed 1
+// on a machine with that many cores; with one thread analyze_parallel pays for its first phase.
+void run_wide_call_graph_benchmark(BenchReport& report) {
+  constexpr std::size_t kFunctions = 4096;
+  constexpr std::size_t kLets = 32;
+  CallGraphBuilder graph{};
+  for (std::size_t i = 0; i < kFunctions; ++i) {
+    graph.begin_function("g" + std::to_string(i));
+    std::vector<NodeId> statements{};
+    for (std::size_t j = 0; j < kLets; ++j) {
+      const NodeId variable = graph.name("v" + std::to_string(j));
+      const NodeId previous =
+          j == 0 ? graph.node(AstKind::LiteralExpr, "1") : graph.name("v" + std::to_string(j - 1));
+      const NodeId sum = graph.node(AstKind::BinaryExpr, "+", {previous, graph.node(AstKind::LiteralExpr, "2")});
+      statements.push_back(graph.node(AstKind::LetStmt, "let", {variable, sum}));
+    }
+    statements.push_back(graph.node(AstKind::ReturnStmt, {}, {graph.name("v" + std::to_string(kLets - 1))}));
+    graph.end_function(statements);
+  }
+  const NodeId root = graph.finish();
+  const double nodes = static_cast<double>(graph.context.size());
+  const Sample serial = measure_serial_analysis(graph.context, root);
+
+  std::vector<std::size_t> thread_counts{1, 2, 4};
+  const std::size_t cores = std::max(1u, std::thread::hardware_concurrency());
+  if (std::find(thread_counts.begin(), thread_counts.end(), cores) == thread_counts.end()) {
+    thread_counts.push_back(cores);
+  }
+  for (const std::size_t threads : thread_counts) {
+    istudio::support::ThreadPool pool{threads};
+    const Sample parallel = measure_parallel_analysis(graph.context, root, pool);
+    const std::string name = "analyze-wide/" + std::to_string(threads) + "-threads";
+    const double speedup = serial.seconds / parallel.seconds;
+    std::cout << std::left << std::setw(32) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << nodes / parallel.seconds / 1e6 << " Mnode/s" << std::setw(10) << speedup
+              << " x analyze() (" << cores << " cores)\n";
+    report.add(name, {{"mnodes_per_s", nodes / parallel.seconds / 1e6},
+                      {"serial_mnodes_per_s", nodes / serial.seconds / 1e6},
+                      {"speedup", speedup},
+                      {"threads", static_cast<double>(threads)},
+                      {"functions", static_cast<double>(kFunctions)},
+                      {"nodes", nodes}});
+  }
+}
+
+}  // namespace
+
+void run_frontend_benchmarks(BenchReport& report, std::size_t corpus_bytes) {
+  for (const NamedCorpus& corpus : corpora(corpus_bytes)) {
+    run_corpus_benchmarks(corpus, report);
+  }
+  run_recovery_benchmark(report, corpus_bytes);
+  run_reparse_benchmark(report);
+  run_multi_file_benchmark(report, corpus_bytes);
+  run_ast_image_benchmark(report, corpus_bytes);
+  run_structural_hash_benchmark(report, corpus_bytes);
+  run_call_chain_benchmark(report);
+  run_wide_call_graph_benchmark(report);
+}
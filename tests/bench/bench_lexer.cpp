@@ -0,0 +1,409 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "alloc_counter.h"
+#include "front/ast.h"
+#include "front/lexer.h"
+#include "front/lexer_tables.h"
+#include "front/parser.h"
+#include "front/scan.h"
+#include "report.h"
+#include "sem/analyzer.h"
+#include "support/diagnostics.h"
+#include "support/string_interner.h"
+#include "support/thread_pool.h"
+
+using istudio::bench::allocation_stats;
+using istudio::bench::BenchReport;
+using istudio::bench::reset_allocation_stats;
+using istudio::front::AstContext;
+using istudio::front::Lexer;
+using istudio::front::LexerConfig;
+using istudio::front::ScanIsa;
+using istudio::front::ScanKernels;
+using istudio::front::lex;
+using istudio::front::lex_parallel;
+using istudio::front::relex;
+using istudio::front::SourceEdit;
+
+namespace {
+
+// Emits `lines` statements shaped like our machine-generated modules: long identifiers, indentation,
+// arithmetic, and a comment every few lines.
+std::string make_lexer_corpus(std::size_t lines) {
+  std::string source{};
+  source.reserve(lines * 72);
+  for (std::size_t i = 0; i < lines; ++i) {
+    if (i % 4 == 0) {
+      source += "  // generated binding ";
+      source += std::to_string(i);
+      source += '\n';
+    }
+    source += "  let generated_value_";
+    source += std::to_string(i);
+    source += " = input_parameter_";
+    source += std::to_string(i % 97);
+    source += " + ";
+    source += std::to_string(i * 31 % 1000);
+    source += " * (offset_table_entry - 1);\n";
+  }
+  return source;
+}
+
+void run_lex_benchmark(BenchReport& report, const std::string& name, const std::string& source, const LexerConfig& config,
+                       std::size_t iterations) {
+  std::size_t tokens = 0;
+  reset_allocation_stats();
+  const auto begin = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < iterations; ++i) {
+    const auto stream = lex(source, config);
+    tokens += stream.size();
+  }
+  const auto end = std::chrono::steady_clock::now();
+  const auto stats = allocation_stats();
+
+  const double seconds = std::chrono::duration<double>(end - begin).count();
+  const double megabytes = static_cast<double>(source.size() * iterations) / (1024.0 * 1024.0);
+  std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(2)
+            << std::setw(10) << megabytes / seconds << " MB/s" << std::setw(14)
+            << static_cast<double>(tokens) / seconds / 1e6 << " Mtok/s" << std::setw(10)
+            << static_cast<double>(stats.allocations) / static_cast<double>(tokens) << " allocs/token\n";
+  report.add(name, {{"mb_per_s", megabytes / seconds},
+                    {"mtokens_per_s", static_cast<double>(tokens) / seconds / 1e6},
+                    {"allocs_per_token", static_cast<double>(stats.allocations) / static_cast<double>(tokens)}});
+}
+
+// Walks the corpus the way the lexer's hot loops do (whitespace, identifier and comment runs) using one
+// kernel set, so the instruction sets can be compared without the rest of the lexer in the way.
+void run_scan_benchmark(BenchReport& report, const ScanKernels& kernels, const std::string& source, std::size_t iterations) {
+  const char* data = source.data();
+  const std::size_t size = source.size();
+  std::size_t checksum = 0;
+  const auto begin = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < iterations; ++i) {
+    std::size_t pos = 0;
+    while (pos < size) {
+      pos = kernels.skip_whitespace(data, size, pos);
+      if (pos >= size) {
+        break;
+      }
+      const char ch = data[pos];
+      if (ch == '_' || (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z')) {
+        pos = kernels.skip_identifier(data, size, pos + 1);
+      } else if (ch == '/' && pos + 1 < size && data[pos + 1] == '/') {
+        pos = kernels.find_newline(data, size, pos + 2);
+      } else {
+        ++pos;
+      }
+      ++checksum;
+    }
+  }
+  const auto end = std::chrono::steady_clock::now();
+
+  const double seconds = std::chrono::duration<double>(end - begin).count();
+  const double megabytes = static_cast<double>(size * iterations) / (1024.0 * 1024.0);
+  std::cout << std::left << std::setw(28) << ("scan/" + std::string(to_string(kernels.isa))) << std::right
+            << std::fixed << std::setprecision(2) << std::setw(10) << megabytes / seconds << " MB/s"
+            << std::setw(14) << checksum / iterations << " runs\n";
+  report.add("scan/" + std::string(to_string(kernels.isa)), {{"mb_per_s", megabytes / seconds}});
+}
+
+// Line-table construction as done by SourceManager: count, then collect line starts.
+void run_line_table_benchmark(BenchReport& report, const ScanKernels& kernels, const std::string& source, std::size_t iterations) {
+  std::size_t lines = 0;
+  std::vector<std::uint32_t> starts{};
+  const auto begin = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < iterations; ++i) {
+    starts.resize(kernels.count_newlines(source.data(), source.size()));
+    kernels.collect_line_starts(source.data(), source.size(), starts.data());
+    lines += starts.size();
+  }
+  const auto end = std::chrono::steady_clock::now();
+
+  const double seconds = std::chrono::duration<double>(end - begin).count();
+  const double megabytes = static_cast<double>(source.size() * iterations) / (1024.0 * 1024.0);
+  std::cout << std::left << std::setw(28) << ("lines/" + std::string(to_string(kernels.isa))) << std::right
+            << std::fixed << std::setprecision(2) << std::setw(10) << megabytes / seconds << " MB/s"
+            << std::setw(14) << lines / iterations << " lines\n";
+  report.add("lines/" + std::string(to_string(kernels.isa)), {{"mb_per_s", megabytes / seconds}});
+}
+
+// The pre-table implementations, kept as the baseline for the keyword/operator microbenchmarks.
+bool linear_is_keyword(std::string_view word) {
+  constexpr std::array<std::string_view, 9> keywords{
+      "module", "fn", "pub", "let", "mut", "struct", "enum", "ct", "return"};
+  for (auto kw : keywords) {
+    if (kw == word) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::size_t candidate_operator_length(std::string_view source, std::size_t pos) {
+  constexpr std::array<std::string_view, 20> compound{
+      "==", "!=", "<=", ">=", "&&", "||", "::", "->", "=>", "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=", "<<",
+      ">>", ">>="};
+  std::string lexeme(1, source[pos]);
+  std::size_t end = pos + 1;
+  while (end < source.size()) {
+    std::string candidate = lexeme;
+    candidate.push_back(source[end]);
+    bool found = false;
+    for (auto sym : compound) {
+      found = found || sym == candidate;
+    }
+    if (!found) {
+      break;
+    }
+    lexeme = std::move(candidate);
+    ++end;
+  }
+  return end - pos;
+}
+
+template <typename Fn>
+void run_micro_benchmark(BenchReport& report, const std::string& name, std::size_t operations, Fn&& fn) {
+  const auto begin = std::chrono::steady_clock::now();
+  const std::size_t checksum = fn();
+  const auto end = std::chrono::steady_clock::now();
+  const double nanoseconds = std::chrono::duration<double, std::nano>(end - begin).count();
+  std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(2)
+            << std::setw(10) << nanoseconds / static_cast<double>(operations) << " ns/op" << std::setw(14)
+            << checksum << " hits\n";
+  report.add(name, {{"ns_per_op", nanoseconds / static_cast<double>(operations)}});
+}
+
+void run_table_benchmarks(BenchReport& report, const std::string& source) {
+  constexpr std::size_t rounds = 20;
+  std::vector<std::string_view> words{};
+  std::vector<std::size_t> symbol_positions{};
+  const auto stream = lex(source);
+  for (const auto& token : stream) {
+    if (token.kind == istudio::front::TokenKind::Identifier || token.kind == istudio::front::TokenKind::Keyword) {
+      words.push_back(token.lexeme);
+    } else if (token.kind == istudio::front::TokenKind::Symbol) {
+      symbol_positions.push_back(token.span.start);
+    }
+  }
+
+  run_micro_benchmark(report, "keyword/linear", words.size() * rounds, [&] {
+    std::size_t hits = 0;
+    for (std::size_t r = 0; r < rounds; ++r) {
+      for (auto word : words) {
+        if (linear_is_keyword(word)) {
+          ++hits;
+        }
+      }
+    }
+    return hits;
+  });
+  run_micro_benchmark(report, "keyword/perfect-hash", words.size() * rounds, [&] {
+    std::size_t hits = 0;
+    for (std::size_t r = 0; r < rounds; ++r) {
+      for (auto word : words) {
+        if (istudio::front::classify_keyword(word) != istudio::front::Keyword::None) {
+          ++hits;
+        }
+      }
+    }
+    return hits;
+  });
+  run_micro_benchmark(report, "operator/string-candidates", symbol_positions.size() * rounds, [&] {
+    std::size_t length = 0;
+    for (std::size_t r = 0; r < rounds; ++r) {
+      for (auto pos : symbol_positions) {
+        length += candidate_operator_length(source, pos);
+      }
+    }
+    return length;
+  });
+  run_micro_benchmark(report, "operator/dfa", symbol_positions.size() * rounds, [&] {
+    std::size_t length = 0;
+    for (std::size_t r = 0; r < rounds; ++r) {
+      for (auto pos : symbol_positions) {
+        length += istudio::front::match_operator(source, pos).length;
+      }
+    }
+    return length;
+  });
+}
+
+void run_token_memory_benchmark(BenchReport& report, const std::string& name, const std::string& source, const LexerConfig& config) {
+  reset_allocation_stats();
+  const auto before = allocation_stats();
+  const auto stream = lex(source, config);
+  const auto after = allocation_stats();
+
+  const double tokens = static_cast<double>(stream.size());
+  const double retained = static_cast<double>(after.live_bytes - before.live_bytes);
+  const double peak = static_cast<double>(after.peak_bytes - before.live_bytes);
+  std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(2)
+            << std::setw(10) << tokens / 1e6 << " Mtok" << std::setw(10) << peak / (1024.0 * 1024.0)
+            << " MiB peak" << std::setw(10) << retained / tokens << " B/token retained" << std::setw(10)
+            << peak / tokens << " B/token peak\n";
+  report.add(name, {{"retained_bytes_per_token", retained / tokens}, {"peak_bytes_per_token", peak / tokens}});
+}
+
+// Peak heap while parsing, less what the finished AST retains: i.e. the transient cost of holding tokens.
+void run_parse_memory_benchmark(BenchReport& report, const std::string& source, bool streaming) {
+  reset_allocation_stats();
+  const auto before = allocation_stats();
+  AstContext context{};
+  if (streaming) {
+    Lexer lexer{source, LexerConfig{}};
+    istudio::front::parse_module(lexer, context);
+  } else {
+    const auto stream = lex(source);
+    istudio::front::parse_module(stream, context);
+  }
+  const auto after = allocation_stats();
+
+  const double retained = static_cast<double>(after.live_bytes - before.live_bytes);
+  const double peak = static_cast<double>(after.peak_bytes - before.live_bytes);
+  std::cout << std::left << std::setw(28) << (streaming ? "parse/1M/streaming" : "parse/1M/materialized")
+            << std::right << std::fixed << std::setprecision(2) << std::setw(10) << peak / (1024.0 * 1024.0)
+            << " MiB peak" << std::setw(10) << (peak - retained) / (1024.0 * 1024.0) << " MiB over AST\n";
+  report.add(streaming ? "parse/1M/streaming" : "parse/1M/materialized",
+             {{"peak_mib", peak / (1024.0 * 1024.0)}, {"over_ast_mib", (peak - retained) / (1024.0 * 1024.0)}});
+}
+
+// Heap retained by the front end after lex + parse + analysis of a corpus whose names all resolve: the AST,
+// the semantic tables and, when interning, the interner. Tokens are streamed so they do not count.
+void run_name_memory_benchmark(BenchReport& report, const std::string& body, bool interned) {
+  std::string source{};
+  for (std::size_t i = 0; i < 97; ++i) {
+    source += "let input_parameter_" + std::to_string(i) + " = " + std::to_string(i) + ";\n";
+  }
+  source += "let offset_table_entry = 1;\n";
+  source += body;
+
+  reset_allocation_stats();
+  const auto before = allocation_stats();
+  {
+    const auto interner = interned ? std::make_shared<istudio::support::StringInterner>() : nullptr;
+    AstContext context{interner};
+    LexerConfig config{};
+    config.interner = interner.get();
+    Lexer lexer{source, config};
+    const auto root = istudio::front::parse_module(lexer, context);
+    istudio::support::DiagnosticReporter reporter{};
+    istudio::sem::SemanticAnalyzer analyzer{context, reporter};
+    analyzer.analyze(root);
+    if (!reporter.diagnostics().empty()) {
+      throw std::runtime_error("name memory corpus should analyze cleanly");
+    }
+    const auto after = allocation_stats();
+    const double retained = static_cast<double>(after.live_bytes - before.live_bytes);
+    std::cout << std::left << std::setw(28) << (interned ? "names/1M/interned" : "names/1M/uninterned")
+              << std::right << std::fixed << std::setprecision(2) << std::setw(10) << retained / (1024.0 * 1024.0)
+              << " MiB retained after analysis\n";
+    report.add(interned ? "names/1M/interned" : "names/1M/uninterned",
+               {{"retained_mib", retained / (1024.0 * 1024.0)}});
+  }
+}
+
+// One-byte insertion in the middle of the file, as on a keystroke: full lex vs incremental relex.
+void run_relex_benchmark(BenchReport& report, const std::string& source, std::size_t iterations) {
+  const std::size_t offset = source.find("input_parameter_", source.size() / 2) + 5;
+  const std::string edited = source.substr(0, offset) + "x" + source.substr(offset);
+  const SourceEdit edit{.range = istudio::support::make_span(offset, offset), .text = "x"};
+  const auto previous = lex(source);
+
+  const auto time_per_op = [iterations](auto&& body) {
+    std::size_t tokens = 0;
+    const auto begin = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+      tokens += body().size();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    const double micros = std::chrono::duration<double, std::micro>(end - begin).count();
+    return std::pair{micros / static_cast<double>(iterations), tokens / iterations};
+  };
+  const auto [full, full_tokens] = time_per_op([&] { return lex(edited); });
+  const auto [incremental, incremental_tokens] = time_per_op([&] { return relex(previous, edited, edit); });
+  if (full_tokens != incremental_tokens) {
+    throw std::runtime_error("relex produced a different token count than lex");
+  }
+  std::cout << std::left << std::setw(28) << "relex/keystroke" << std::right << std::fixed << std::setprecision(1)
+            << std::setw(10) << full << " us full" << std::setw(10) << incremental << " us incremental ("
+            << static_cast<double>(source.size()) / (1024.0 * 1024.0) << " MiB source)\n";
+  report.add("relex/keystroke", {{"full_us", full}, {"incremental_us", incremental}});
+}
+
+// Parallel lexing throughput for 1, 2, 4, ... workers up to the hardware thread count.
+void run_parallel_lex_benchmark(BenchReport& report, const std::string& source, std::size_t iterations) {
+  const std::size_t expected = lex(source).size();
+  const std::size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+  for (std::size_t threads = 1;; threads = std::min(threads * 2, max_threads)) {
+    istudio::support::ThreadPool pool{threads};
+    std::size_t tokens = 0;
+    const auto begin = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+      tokens += lex_parallel(source, pool).size();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    if (tokens != expected * iterations) {
+      throw std::runtime_error("parallel lex produced a different token count");
+    }
+
+    const double seconds = std::chrono::duration<double>(end - begin).count();
+    const double megabytes = static_cast<double>(source.size() * iterations) / (1024.0 * 1024.0);
+    std::cout << std::left << std::setw(28) << ("lex/parallel/" + std::to_string(threads)) << std::right
+              << std::fixed << std::setprecision(2) << std::setw(10) << megabytes / seconds << " MB/s\n";
+    report.add("lex/parallel/" + std::to_string(threads), {{"mb_per_s", megabytes / seconds}});
+    if (threads == max_threads) {
+      break;
+    }
+  }
+}
+
+}  // namespace
+
+void run_lexer_benchmarks(BenchReport& report) {
+  const std::string source = make_lexer_corpus(50000);
+  constexpr std::size_t iterations = 10;
+
+  LexerConfig comments_only{};
+  run_lex_benchmark(report, "lex/comments", source, comments_only, iterations);
+
+  LexerConfig no_trivia{};
+  no_trivia.capture_comments = false;
+  run_lex_benchmark(report, "lex/no-trivia", source, no_trivia, iterations);
+
+  LexerConfig full_trivia{};
+  full_trivia.capture_whitespace = true;
+  run_lex_benchmark(report, "lex/full-trivia", source, full_trivia, iterations);
+
+  for (ScanIsa isa : {ScanIsa::Scalar, ScanIsa::Sse2, ScanIsa::Avx2}) {
+    if (const ScanKernels* kernels = istudio::front::scan_kernels_for(isa)) {
+      run_scan_benchmark(report, *kernels, source, iterations);
+      run_line_table_benchmark(report, *kernels, source, iterations);
+    }
+  }
+
+  run_table_benchmarks(report, source);
+  run_relex_benchmark(report, source, iterations);
+  run_parallel_lex_benchmark(report, source, iterations);
+
+  // ~1M tokens.
+  const std::string large = make_lexer_corpus(70000);
+  run_token_memory_benchmark(report, "memory/1M/comments", large, comments_only);
+  run_token_memory_benchmark(report, "memory/1M/full-trivia", large, full_trivia);
+  run_parse_memory_benchmark(report, large, false);
+  run_parse_memory_benchmark(report, large, true);
+  run_name_memory_benchmark(report, large, false);
+  run_name_memory_benchmark(report, large, true);
+}
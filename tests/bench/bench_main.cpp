@@ -0,0 +1,86 @@
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "front/scan.h"
+#include "report.h"
+
+void run_lexer_benchmarks(istudio::bench::BenchReport& report);
+void run_frontend_benchmarks(istudio::bench::BenchReport& report, std::size_t corpus_bytes);
+
+namespace {
+
+constexpr std::string_view kUsage =
+    "usage: istudio_bench [--suite all|lexer|frontend] [--corpus-bytes N] [--json PATH]\n"
+    "  --suite         benchmarks to run (default: all)\n"
+    "  --corpus-bytes  size of each generated corpus for the frontend suite (default: 4194304)\n"
+    "  --json          also write results as JSON to PATH\n";
+
+struct Options {
+  std::string suite{"all"};
+  std::size_t corpus_bytes{4 * 1024 * 1024};
+  std::string json_path{};
+};
+
+Options parse_options(int argc, char** argv) {
+  Options options{};
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg = argv[i];
+    if (i + 1 >= argc) {
+      throw std::invalid_argument("missing value for '" + std::string(arg) + "'");
+    }
+    const std::string value = argv[++i];
+    if (arg == "--suite" && (value == "all" || value == "lexer" || value == "frontend")) {
+      options.suite = value;
+    } else if (arg == "--corpus-bytes") {
+      options.corpus_bytes = std::stoull(value);
+    } else if (arg == "--json") {
+      options.json_path = value;
+    } else {
+      throw std::invalid_argument("unknown option '" + std::string(arg) + " " + value + "'");
+    }
+  }
+  return options;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  try {
+    const Options options = parse_options(argc, argv);
+    istudio::bench::BenchReport report{};
+#if defined(NDEBUG)
+    report.set_context("build", "release");
+#else
+    report.set_context("build", "debug");
+#endif
+    report.set_context("scan_isa", std::string(to_string(istudio::front::scan_kernels().isa)));
+
+    if (options.suite != "frontend") {
+      run_lexer_benchmarks(report);
+    }
+    if (options.suite != "lexer") {
+      run_frontend_benchmarks(report, options.corpus_bytes);
+    }
+
+    if (!options.json_path.empty()) {
+      std::ofstream out{options.json_path};
+      report.write_json(out);
+      if (!out) {
+        throw std::runtime_error("cannot write '" + options.json_path + "'");
+      }
+    }
+  } catch (const std::invalid_argument& ex) {
+    std::cerr << "[bench] " << ex.what() << '\n' << kUsage;
+    return EXIT_FAILURE;
+  } catch (const std::exception& ex) {
+    std::cerr << "[bench] " << ex.what() << '\n';
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,211 @@
+#include "corpus.h"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "front/lexer_tables.h"
+
+namespace istudio::bench {
+namespace {
+
+constexpr std::size_t kMaxBlockDepth = 4;
+constexpr std::string_view kLeadChars = "abcdefghijklmnopqrstuvwxyz_ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+constexpr std::string_view kTailChars = "abcdefghijklmnopqrstuvwxyz_0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+constexpr std::array<std::string_view, 13> kBinaryOperators = {"+",  "-",  "*",  "/", "%",  "<",  "<=",
+                                                                ">",  ">=", "==", "!=", "&&", "||"};
+constexpr std::array<std::string_view, 6> kAssignmentOperators = {" = ", " += ", " -= ", " *= ", " /= ", " %= "};
+constexpr std::array<std::string_view, 10> kCommentWords = {"compute", "the",   "next", "value", "for",
+                                                             "cached",  "entry", "see",  "spec",  "note"};
+
+// SplitMix64: tiny, fast and fully specified, unlike the std distributions.
+class Random {
+ public:
+  explicit Random(std::uint64_t seed) : state_(seed) {}
+
+  std::uint64_t next() noexcept {
+    std::uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+  std::size_t below(std::size_t bound) noexcept { return static_cast<std::size_t>(next() % bound); }
+
+  bool chance(double probability) noexcept {
+    return static_cast<double>(next() >> 11) * 0x1.0p-53 < probability;
+  }
+
+ private:
+  std::uint64_t state_;
+};
+
+class Generator {
+ public:
+  explicit Generator(const CorpusOptions& options) : options_(options), random_(options.seed) {}
+
+  std::string run() {
+    out_.reserve(options_.target_bytes + 256);
+    for (std::size_t i = 0; i < std::max<std::size_t>(options_.vocabulary, 1); ++i) {
+      names_.push_back(fresh_name());
+      out_ += "let " + names_.back() + " = " + std::to_string(i) + ";\n";
+    }
+    while (out_.size() < options_.target_bytes) {
+      statement();
+    }
+    while (depth_ > 0) {
+      close_block();
+    }
+    return std::move(out_);
+  }
+
+ private:
+  std::size_t identifier_length() {
+    const std::size_t extra_mean = options_.mean_identifier_length - options_.min_identifier_length;
+    const double stop = 1.0 / static_cast<double>(extra_mean + 1);
+    std::size_t length = options_.min_identifier_length;
+    while (length < options_.max_identifier_length && !random_.chance(stop)) {
+      ++length;
+    }
+    return length;
+  }
+
+  // A name no earlier binding used; collisions are retried, then the name is lengthened.
+  std::string fresh_name() {
+    std::size_t length = identifier_length();
+    for (std::size_t attempt = 1;; ++attempt) {
+      std::string name(1, kLeadChars[random_.below(kLeadChars.size())]);
+      while (name.size() < length) {
+        name += kTailChars[random_.below(kTailChars.size())];
+      }
+      if (front::classify_keyword(name) == front::Keyword::None && used_.insert(name).second) {
+        return name;
+      }
+      if (attempt % 8 == 0) {
+        ++length;
+      }
+    }
+  }
+
+  void indent() { out_.append(2 * depth_, ' '); }
+
+  void statement() {
+    if (random_.chance(options_.comment_density)) {
+      indent();
+      out_ += "//";
+      for (std::size_t words = 1 + random_.below(8); words > 0; --words) {
+        out_ += ' ';
+        out_ += kCommentWords[random_.below(kCommentWords.size())];
+      }
+      out_ += '\n';
+    }
+    if (depth_ > 0 && random_.chance(0.15)) {
+      close_block();
+      return;
+    }
+    if (depth_ < kMaxBlockDepth && random_.chance(options_.block_density)) {
+      indent();
+      out_ += "{\n";
+      ++depth_;
+      return;
+    }
+
+    indent();
+    const std::size_t kind = random_.below(20);
+    if (kind < 8) {
+      // Fresh bindings are never referenced, so every name an expression uses is declared up front.
+      out_ += "let ";
+      out_ += fresh_name();
+      out_ += " = ";
+    } else if (kind < 11) {
+      out_ += names_[random_.below(names_.size())];
+      out_ += " = ";
+    } else if (kind < 13) {
+      out_ += names_[random_.below(names_.size())];
+      out_ += kAssignmentOperators[random_.below(kAssignmentOperators.size())];
+    } else if (kind < 15) {
+      out_ += "return ";
+    }
+    expression(options_.max_expression_depth);
+    out_ += ";\n";
+  }
+
+  void close_block() {
+    --depth_;
+    indent();
+    out_ += "}\n";
+  }
+
+  void expression(std::size_t depth) {
+    if (depth == 0 || random_.chance(0.25)) {
+      operand();
+      return;
+    }
+    const std::size_t form = random_.below(20);
+    if (form < 12) {
+      expression(depth - 1);
+      out_ += ' ';
+      out_ += kBinaryOperators[random_.below(kBinaryOperators.size())];
+      out_ += ' ';
+      expression(depth - 1);
+    } else if (form < 15) {
+      out_ += '(';
+      expression(depth - 1);
+      out_ += ')';
+    } else if (form < 17) {
+      // Prefix operators always take a parenthesized operand, so "-" never meets another "-".
+      out_ += random_.chance(0.5) ? "-(" : "!(";
+      expression(depth - 1);
+      out_ += ')';
+    } else {
+      out_ += names_[random_.below(names_.size())];
+      out_ += '(';
+      for (std::size_t args = random_.below(4), i = 0; i < args; ++i) {
+        if (i > 0) {
+          out_ += ", ";
+        }
+        expression(depth - 1);
+      }
+      out_ += ')';
+    }
+  }
+
+  void operand() {
+    const std::size_t form = random_.below(20);
+    if (form < 10) {
+      out_ += names_[random_.below(names_.size())];
+    } else if (form < 15) {
+      out_ += std::to_string(random_.below(100000));
+    } else if (form < 17) {
+      out_ += std::to_string(random_.below(1000)) + "." + std::to_string(random_.below(100));
+    } else if (form < 19) {
+      out_ += '"';
+      out_ += kCommentWords[random_.below(kCommentWords.size())];
+      out_ += random_.chance(0.2) ? " \\\"quoted\\\"\"" : "\"";
+    } else {
+      out_ += random_.chance(0.5) ? "true" : "false";
+    }
+  }
+
+  const CorpusOptions& options_;
+  Random random_;
+  std::string out_{};
+  std::vector<std::string> names_{};
+  std::unordered_set<std::string> used_{};
+  std::size_t depth_{0};
+};
+
+}  // namespace
+
+std::string generate_corpus(const CorpusOptions& options) {
+  if (options.min_identifier_length == 0 || options.min_identifier_length > options.mean_identifier_length ||
+      options.mean_identifier_length > options.max_identifier_length) {
+    throw std::invalid_argument("corpus identifier lengths must satisfy 0 < min <= mean <= max");
+  }
+  return Generator{options}.run();
+}
+
+}  // namespace istudio::bench
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace istudio::bench {
+
+// Shape of a synthetic .ist corpus. Every statement form the parser accepts appears: let bindings, plain and
+// compound assignments, calls, returns and nested blocks, with expressions built from all binary and prefix
+// operators.
+struct CorpusOptions {
+  std::uint64_t seed{0x15d1};
+  // Generation stops at the first statement boundary past this size.
+  std::size_t target_bytes{1 << 20};
+  // Identifier lengths are geometric with this mean, clamped to [min, max].
+  std::size_t min_identifier_length{2};
+  std::size_t mean_identifier_length{10};
+  std::size_t max_identifier_length{32};
+  // Names declared up front and referenced by expressions.
+  std::size_t vocabulary{256};
+  // Probability that a statement is preceded by a line comment.
+  double comment_density{0.2};
+  // Maximum operator nesting in an expression; 0 yields bare operands.
+  std::size_t max_expression_depth{4};
+  // Probability that a statement opens a nested block (at most four deep).
+  double block_density{0.05};
+};
+
+// Byte-identical output for equal options on every platform and standard library: uses its own PRNG and
+// no <random> distributions.
+[[nodiscard]] std::string generate_corpus(const CorpusOptions& options);
+
+}  // namespace istudio::bench
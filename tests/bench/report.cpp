@@ -0,0 +1,72 @@
+#include "report.h"
+
+#include <cmath>
+#include <cstdio>
+#include <string_view>
+
+namespace istudio::bench {
+namespace {
+
+std::string json_string(std::string_view text) {
+  std::string out{"\""};
+  for (const char ch : text) {
+    if (ch == '"' || ch == '\\') {
+      out += '\\';
+      out += ch;
+    } else if (static_cast<unsigned char>(ch) < 0x20) {
+      char escaped[8];
+      std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(ch));
+      out += escaped;
+    } else {
+      out += ch;
+    }
+  }
+  out += '"';
+  return out;
+}
+
+std::string json_number(double value) {
+  if (!std::isfinite(value)) {
+    return "null";
+  }
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.10g", value);
+  return buffer;
+}
+
+}  // namespace
+
+void BenchReport::set_context(std::string key, std::string value) {
+  for (auto& [existing, current] : context_) {
+    if (existing == key) {
+      current = std::move(value);
+      return;
+    }
+  }
+  context_.emplace_back(std::move(key), std::move(value));
+}
+
+void BenchReport::add(std::string name, std::initializer_list<Metric> metrics) {
+  results_.push_back(BenchResult{.name = std::move(name), .metrics = metrics});
+}
+
+void BenchReport::write_json(std::ostream& out) const {
+  out << "{\n  \"schema\": 1,\n  \"context\": {";
+  for (std::size_t i = 0; i < context_.size(); ++i) {
+    out << (i == 0 ? "\n" : ",\n") << "    " << json_string(context_[i].first) << ": "
+        << json_string(context_[i].second);
+  }
+  out << (context_.empty() ? "},\n" : "\n  },\n") << "  \"results\": [";
+  for (std::size_t i = 0; i < results_.size(); ++i) {
+    const BenchResult& result = results_[i];
+    out << (i == 0 ? "\n" : ",\n") << "    {\"name\": " << json_string(result.name) << ", \"metrics\": {";
+    for (std::size_t m = 0; m < result.metrics.size(); ++m) {
+      out << (m == 0 ? "" : ", ") << json_string(result.metrics[m].name) << ": "
+          << json_number(result.metrics[m].value);
+    }
+    out << "}}";
+  }
+  out << (results_.empty() ? "]\n}\n" : "\n  ]\n}\n");
+}
+
+}  // namespace istudio::bench
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <initializer_list>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace istudio::bench {
+
+// A measured value; the name carries the unit (e.g. "mb_per_s", "allocs_per_token").
+struct Metric {
+  std::string name{};
+  double value{0.0};
+};
+
+struct BenchResult {
+  std::string name{};
+  std::vector<Metric> metrics{};
+};
+
+// Results of one benchmark run, for machine-readable output alongside the human-readable log.
+class BenchReport {
+ public:
+  // Run-wide facts (build type, scan kernels, ...) recorded once at the top of the output.
+  void set_context(std::string key, std::string value);
+  void add(std::string name, std::initializer_list<Metric> metrics);
+
+  [[nodiscard]] const std::vector<BenchResult>& results() const noexcept { return results_; }
+
+  // {"schema": 1, "context": {...}, "results": [{"name": ..., "metrics": {...}}, ...]}
+  void write_json(std::ostream& out) const;
+
+ private:
+  std::vector<std::pair<std::string, std::string>> context_{};
+  std::vector<BenchResult> results_{};
+};
+
+}  // namespace istudio::bench
@@ -0,0 +1,97 @@
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "corpus.h"
+#include "front/ast.h"
+#include "front/lexer.h"
+#include "front/parser.h"
+
+using istudio::bench::CorpusOptions;
+using istudio::bench::generate_corpus;
+using istudio::front::AstContext;
+using istudio::front::lex;
+using istudio::front::TokenKind;
+
+namespace {
+
+[[noreturn]] void fail(const std::string& message) {
+  throw std::runtime_error(message);
+}
+
+void expect(bool condition, const std::string& message) {
+  if (!condition) {
+    fail(message);
+  }
+}
+
+void test_corpus_is_deterministic() {
+  CorpusOptions options{};
+  options.target_bytes = 32 * 1024;
+  const std::string first = generate_corpus(options);
+  expect(first == generate_corpus(options), "equal options should generate identical corpora");
+  expect(first.size() >= options.target_bytes && first.size() < options.target_bytes + 4096,
+         "corpus should stop just past the target size");
+
+  CorpusOptions reseeded = options;
+  reseeded.seed = options.seed + 1;
+  expect(generate_corpus(reseeded) != first, "a different seed should generate a different corpus");
+}
+
+void test_corpus_parses_for_every_shape() {
+  CorpusOptions options{};
+  options.target_bytes = 16 * 1024;
+  for (std::size_t depth : {0u, 1u, 4u, 9u}) {
+    for (double blocks : {0.0, 0.3}) {
+      options.max_expression_depth = depth;
+      options.block_density = blocks;
+      const std::string source = generate_corpus(options);
+      AstContext context{};
+      try {
+        istudio::front::parse_module(lex(source), context);
+      } catch (const std::exception& ex) {
+        fail("generated corpus (depth " + std::to_string(depth) + ") should parse: " + ex.what());
+      }
+      expect(context.size() > options.vocabulary, "generated corpus should produce a non-trivial AST");
+    }
+  }
+}
+
+void test_corpus_honours_shape_options() {
+  CorpusOptions options{};
+  options.target_bytes = 16 * 1024;
+  options.comment_density = 0.0;
+  options.min_identifier_length = 5;
+  options.mean_identifier_length = 6;
+  options.max_identifier_length = 7;
+  // Lexemes view the source, so it has to outlive the tokens.
+  const std::string source = generate_corpus(options);
+  const auto tokens = lex(source);
+  for (std::size_t i = 0; i < tokens.size(); ++i) {
+    const auto token = tokens[i];
+    expect(tokens.leading_trivia(i).empty(), "a corpus without comment density should have no comments");
+    // Boolean literals lex as identifiers.
+    if (token.kind == TokenKind::Identifier && token.lexeme != "true" && token.lexeme != "false") {
+      expect(token.lexeme.size() >= 5 && token.lexeme.size() <= 8,
+             "identifier lengths should stay within bounds (one over max only on collisions)");
+    }
+  }
+
+  bool threw = false;
+  try {
+    options.mean_identifier_length = 9;
+    static_cast<void>(generate_corpus(options));
+  } catch (const std::invalid_argument&) {
+    threw = true;
+  }
+  expect(threw, "a mean identifier length above the maximum should be rejected");
+}
+
+}  // namespace
+
+void run_corpus_tests() {
+  test_corpus_is_deterministic();
+  test_corpus_parses_for_every_shape();
+  test_corpus_honours_shape_options();
+  std::cout << "All corpus generator tests passed\n";
+}
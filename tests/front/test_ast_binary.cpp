@@ -0,0 +1,200 @@
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "front/ast_binary.h"
+#include "front/ast_dump.h"
+#include "front/lexer.h"
+#include "front/parser.h"
+#include "support/diagnostics.h"
+
+using istudio::front::AstContext;
+using istudio::front::AstDumpOptions;
+using istudio::front::AstImage;
+using istudio::front::dump_ast_text;
+using istudio::front::lex;
+using istudio::front::LexerConfig;
+using istudio::front::load_ast_binary;
+using istudio::front::NodeId;
+using istudio::front::parse_module;
+using istudio::front::save_ast_binary;
+using istudio::front::write_ast_binary;
+using istudio::support::DiagnosticReporter;
+using istudio::support::StringInterner;
+
+namespace {
+
+[[noreturn]] void fail(const std::string& message) {
+  throw std::runtime_error(message);
+}
+
+void expect(bool condition, const std::string& message) {
+  if (!condition) {
+    fail(message);
+  }
+}
+
+const std::string kSource =
+    "let total = a + 2.5;\n{ let x = f(total, \"text\"); { x += -(x) * 3; } return x; }\n"
+    "let b = !(total) && x;\nreturn ;\n";
+
+NodeId parse_with(const std::string& source, AstContext& context) {
+  LexerConfig config{};
+  config.interner = context.interner().get();
+  DiagnosticReporter reporter{};
+  return parse_module(lex(source, config), context, reporter);
+}
+
+std::string image_of(const AstContext& context, NodeId root) {
+  std::ostringstream out{};
+  write_ast_binary(context, root, out);
+  return out.str();
+}
+
+void test_loaded_ast_equals_fresh_parse() {
+  const auto interner = std::make_shared<StringInterner>();
+  AstContext parsed{interner};
+  const NodeId root = parse_with(kSource, parsed);
+  const auto path = std::filesystem::temp_directory_path() / "istudio_ast_binary_test.ast";
+  save_ast_binary(parsed, root, path);
+
+  AstContext loaded{interner};
+  {
+    const AstImage image = AstImage::open(path);
+    expect(image.node_count() == parsed.size(), "the image should hold every node");
+    expect(load_ast_binary(image, loaded) == root, "the root should keep its id");
+  }
+  std::filesystem::remove(path);
+
+  expect(loaded.size() == parsed.size(), "loading should recreate every node");
+  expect(dump_ast_text(loaded, root) == dump_ast_text(parsed, root), "a loaded AST should equal the parsed one");
+  for (NodeId id = 0; id < parsed.size(); ++id) {
+    expect(loaded.node(id).symbol == parsed.node(id).symbol, "names should resolve to the same symbols");
+  }
+
+  // Another interner issues other symbols for the same names.
+  AstContext elsewhere{std::make_shared<StringInterner>()};
+  load_ast_binary(AstImage::from_bytes(image_of(parsed, root)), elsewhere);
+  expect(dump_ast_text(elsewhere, root) == dump_ast_text(parsed, root), "images should not depend on the interner");
+  const auto& name = elsewhere.node(elsewhere.node(elsewhere.node(root).children[0]).children[0]);
+  expect(name.value == "total" && name.symbol == elsewhere.interner()->find("total"),
+         "names should be interned in the loading context's interner");
+}
+
+void test_load_rebases_ids_onto_the_shard() {
+  AstContext parsed{};
+  const NodeId root = parse_with(kSource, parsed);
+  AstContext shard{std::make_shared<StringInterner>(), 5};
+  const NodeId loaded_root = load_ast_binary(AstImage::from_bytes(image_of(parsed, root)), shard);
+  expect(istudio::front::shard_of(loaded_root) == 5, "the root should live in the loading shard");
+
+  AstDumpOptions options{};
+  options.include_ids = false;
+  expect(dump_ast_text(shard, loaded_root, options) == dump_ast_text(parsed, root, options),
+         "a rebased AST should equal the parsed one");
+
+  // A shard's image is stored relative to it, so it reloads anywhere.
+  AstContext plain{};
+  expect(load_ast_binary(AstImage::from_bytes(image_of(shard, loaded_root)), plain) == root,
+         "ids should be stored relative to their shard");
+  expect(dump_ast_text(plain, root) == dump_ast_text(parsed, root), "a shard's image should reload unchanged");
+}
+
+void test_rejects_malformed_images() {
+  AstContext parsed{};
+  const NodeId root = parse_with(kSource, parsed);
+  const std::string image = image_of(parsed, root);
+
+  const auto rejected = [](const std::string& bytes) {
+    try {
+      static_cast<void>(AstImage::from_bytes(bytes));
+    } catch (const std::runtime_error&) {
+      return true;
+    }
+    return false;
+  };
+  expect(rejected(""), "an empty image should be rejected");
+  expect(rejected("not an AST image, just some text that is long enough for a header"), "bad magic");
+  expect(rejected(image.substr(0, image.size() - 1)), "a truncated image should be rejected");
+  expect(rejected(image + "x"), "trailing bytes should be rejected");
+
+  std::string future = image;
+  const std::uint32_t version = istudio::front::kAstImageVersion + 1;
+  std::memcpy(future.data() + 8, &version, sizeof(version));
+  expect(rejected(future), "images of another version should be rejected");
+
+  // The first child list entry sits right after the 56-byte header; it belongs to the first node with children.
+  std::string dangling = image;
+  const auto child = static_cast<std::uint32_t>(parsed.size());
+  std::memcpy(dangling.data() + 56, &child, sizeof(child));
+  expect(rejected(dangling), "children out of range should be rejected");
+
+  NodeId parent = 0;
+  while (parsed.node(parent).children.empty()) {
+    ++parent;
+  }
+  std::string cyclic = image;
+  const auto self = static_cast<std::uint32_t>(parent);
+  std::memcpy(cyclic.data() + 56, &self, sizeof(self));
+  expect(rejected(cyclic), "a node listed as its own child should be rejected");
+
+  // Node records follow the 32-bit child lists; each starts with its span.
+  std::uint64_t child_count = 0;
+  std::memcpy(&child_count, image.data() + 24, sizeof(child_count));
+  std::string inverted = image;
+  const std::uint32_t late_start = std::numeric_limits<std::uint32_t>::max();
+  std::memcpy(inverted.data() + 56 + child_count * sizeof(std::uint32_t), &late_start, sizeof(late_start));
+  expect(rejected(inverted), "inverted spans should be rejected");
+
+  AstContext busy{};
+  parse_with("let a = 1;", busy);
+  bool threw = false;
+  try {
+    load_ast_binary(AstImage::from_bytes(image), busy);
+  } catch (const std::invalid_argument&) {
+    threw = true;
+  }
+  expect(threw, "images should only load into an empty context");
+}
+
+void test_loaded_ast_reparses_incrementally() {
+  AstContext parsed{};
+  const NodeId root = parse_with(kSource, parsed);
+  AstContext loaded{};
+  const NodeId module = load_ast_binary(AstImage::from_bytes(image_of(parsed, root)), loaded);
+
+  const std::size_t at = kSource.find("* 3");
+  const std::string edited = kSource.substr(0, at) + "+ 1 " + kSource.substr(at);
+  const istudio::front::SourceEdit edit{.range = istudio::support::make_span(at, at), .text = "+ 1 "};
+  const auto tokens = istudio::front::relex(lex(kSource), edited, edit);
+  DiagnosticReporter reporter{};
+  istudio::front::reparse_module(tokens, loaded, module, edit, {}, reporter);
+
+  AstContext fresh{};
+  AstDumpOptions options{};
+  options.include_ids = false;
+  expect(dump_ast_text(loaded, module, options) == dump_ast_text(fresh, parse_with(edited, fresh), options),
+         "a loaded AST should reparse like a parsed one");
+
+  // The reparsed module has children newer than itself: not post-order, but still a tree.
+  AstContext reloaded{};
+  expect(load_ast_binary(AstImage::from_bytes(image_of(loaded, module)), reloaded) == module,
+         "an incrementally reparsed AST should round-trip");
+  expect(dump_ast_text(reloaded, module) == dump_ast_text(loaded, module), "the reloaded AST should be unchanged");
+}
+
+}  // namespace
+
+void run_ast_binary_tests() {
+  test_loaded_ast_equals_fresh_parse();
+  test_load_rebases_ids_onto_the_shard();
+  test_rejects_malformed_images();
+  test_loaded_ast_reparses_incrementally();
+  std::cout << "All AST binary tests passed\n";
+}
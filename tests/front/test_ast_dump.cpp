@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <ostream>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 
@@ -65,26 +68,26 @@ void test_json_dump_simple_module() {
   AstContext context = parse_source("let x = 1;", root);
   const std::string dump = dump_ast_json(context, root, AstDumpOptions{});
   const std::string expected = R"({
-  "id": 0,
+  "id": 3,
   "kind": "Module",
   "span": {"start": 0, "end": 10},
   "value": "",
   "children": [
     {
-      "id": 3,
+      "id": 2,
       "kind": "LetStmt",
       "span": {"start": 0, "end": 10},
       "value": "let",
       "children": [
         {
-          "id": 1,
+          "id": 0,
           "kind": "IdentifierExpr",
           "span": {"start": 4, "end": 5},
           "value": "x",
           "children": []
         },
         {
-          "id": 2,
+          "id": 1,
           "kind": "LiteralExpr",
           "span": {"start": 8, "end": 9},
           "value": "1",
@@ -99,9 +102,114 @@ void test_json_dump_simple_module() {
   expect_equal(normalize_newlines(dump), expected, "AST JSON dump did not match expected output");
 }
 
+void test_dump_with_source_positions() {
+  istudio::support::SourceManager sources{};
+  const auto file = sources.add_buffer("pos.is", "let x = 1;\nx;");
+  istudio::front::NodeId root{};
+  AstContext context = parse_source(std::string(sources.text(file)), root);
+
+  AstDumpOptions options{};
+  options.include_ids = false;
+  options.sources = &sources;
+  options.file = file;
+  const std::string expected = R"(Module span=[0, 13) at 1:1-2:3
+  LetStmt value="let" span=[0, 10) at 1:1-1:11
+    IdentifierExpr value="x" span=[4, 5) at 1:5-1:6
+    LiteralExpr value="1" span=[8, 9) at 1:9-1:10
+  ExpressionStmt span=[11, 13) at 2:1-2:3
+    IdentifierExpr value="x" span=[11, 12) at 2:1-2:2
+)";
+  expect_equal(dump_ast_text(context, root, options), expected, "AST text dump should include line:column");
+
+  const std::string json = dump_ast_json(context, root, options);
+  const std::string field =
+      R"("span": {"start": 11, "end": 13, "start_line": 2, "start_column": 1, "end_line": 2, "end_column": 3})";
+  if (json.find(field) == std::string::npos) {
+    fail("AST JSON dump should include line and column fields\n" + json);
+  }
+}
+
+void test_memory_stats_dumps() {
+  const istudio::front::AstMemoryStats stats{.node_count = 3,
+                                             .node_bytes = 192,
+                                             .node_reserved_bytes = 256,
+                                             .child_bytes = 16,
+                                             .child_reserved_bytes = 64,
+                                             .value_bytes = 5,
+                                             .value_reserved_bytes = 1024};
+  expect_equal(istudio::front::dump_memory_stats_text(stats),
+               "nodes: 3\n"
+               "node bytes: used 192, reserved 256\n"
+               "child bytes: used 16, reserved 64\n"
+               "value bytes: used 5, reserved 1024\n"
+               "total bytes: used 213, reserved 1344\n",
+               "memory stats text dump");
+  expect_equal(istudio::front::dump_memory_stats_json(stats),
+               "{\n"
+               "  \"node_count\": 3,\n"
+               "  \"node_bytes\": {\"used\": 192, \"reserved\": 256},\n"
+               "  \"child_bytes\": {\"used\": 16, \"reserved\": 64},\n"
+               "  \"value_bytes\": {\"used\": 5, \"reserved\": 1024},\n"
+               "  \"total_bytes\": {\"used\": 213, \"reserved\": 1344}\n"
+               "}\n",
+               "memory stats JSON dump");
+}
+
+// Records the largest single write, to check that streaming never hands over the whole dump at once.
+class MeasuringBuffer : public std::stringbuf {
+ public:
+  std::streamsize largest_write{0};
+
+ protected:
+  std::streamsize xsputn(const char* text, std::streamsize count) override {
+    largest_write = std::max(largest_write, count);
+    return std::stringbuf::xsputn(text, count);
+  }
+};
+
+void test_streamed_dumps_match_string_dumps() {
+  std::string source{};
+  for (int i = 0; i < 3000; ++i) {
+    source += "let v" + std::to_string(i) + " = f(\"q\\\"t\\\\\", -(a + " + std::to_string(i) + ") * b);\n";
+  }
+  istudio::support::SourceManager sources{};
+  const auto file = sources.add_buffer("big.is", source);
+  istudio::front::NodeId root{};
+  AstContext context = parse_source(source, root);
+  AstDumpOptions options{};
+  options.sources = &sources;
+  options.file = file;
+
+  const std::string text = dump_ast_text(context, root, options);
+  MeasuringBuffer text_buffer{};
+  std::ostream text_out{&text_buffer};
+  istudio::front::write_ast_text(context, root, text_out, options);
+  expect_equal(text_buffer.str(), text, "a streamed text dump should equal the string dump");
+
+  const std::string json = dump_ast_json(context, root, options);
+  MeasuringBuffer json_buffer{};
+  std::ostream json_out{&json_buffer};
+  istudio::front::write_ast_json(context, root, json_out, options);
+  if (json_buffer.str() != json) {
+    fail("a streamed JSON dump should equal the string dump");
+  }
+
+  const auto largest = static_cast<std::size_t>(std::max(text_buffer.largest_write, json_buffer.largest_write));
+  if (json.size() < 8 * largest || text.size() < 4 * largest) {
+    fail("dumps should be streamed in blocks, not written at once (largest write " + std::to_string(largest) + ")");
+  }
+  const std::string escaped = R"("\"q\\\"t\\\\\"")";
+  if (text.find("value=" + escaped) == std::string::npos || json.find("\"value\": " + escaped) == std::string::npos) {
+    fail("string values should be escaped in place\n" + text.substr(0, 400));
+  }
+}
+
 }  // namespace
 
 void run_ast_dump_tests() {
   test_text_dump_simple_module();
   test_json_dump_simple_module();
+  test_dump_with_source_positions();
+  test_memory_stats_dumps();
+  test_streamed_dumps_match_string_dumps();
 }
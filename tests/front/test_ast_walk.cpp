@@ -0,0 +1,243 @@
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "front/ast_walk.h"
+#include "front/lexer.h"
+#include "front/parser.h"
+#include "support/diagnostics.h"
+
+using istudio::front::AstContext;
+using istudio::front::AstKind;
+using istudio::front::AstNode;
+using istudio::front::lex;
+using istudio::front::NodeId;
+using istudio::front::parse_module;
+using istudio::front::walk_ast;
+using istudio::front::walk_ast_post_order;
+using istudio::front::WalkAction;
+using istudio::support::DiagnosticReporter;
+
+namespace {
+
+[[noreturn]] void fail(const std::string& message) {
+  throw std::runtime_error(message);
+}
+
+void expect(bool condition, const std::string& message) {
+  if (!condition) {
+    fail(message);
+  }
+}
+
+NodeId parse(const std::string& source, AstContext& context) {
+  DiagnosticReporter reporter{};
+  const NodeId root = parse_module(lex(source), context, reporter);
+  expect(reporter.diagnostics().empty(), "unexpected syntax error in \"" + source + "\"");
+  return root;
+}
+
+std::string trace(const AstContext& context, NodeId root, AstKind skipped) {
+  std::string out{};
+  walk_ast(
+      context, root,
+      [&](const AstNode& node) {
+        out += "<" + std::string(node.value.empty() ? to_string(node.kind) : node.value);
+        return node.kind == skipped ? WalkAction::skip_children() : WalkAction::visit_children();
+      },
+      [&](const AstNode&) { out += ">"; });
+  return out;
+}
+
+std::vector<NodeId> post_order(const AstContext& context, NodeId root) {
+  std::vector<NodeId> ids{};
+  walk_ast_post_order(context, root, [&](const AstNode& node) { ids.push_back(node.id); });
+  return ids;
+}
+
+// What the explicit-stack walk visits, leaving each node after its children.
+std::vector<NodeId> walked_post_order(const AstContext& context, NodeId root) {
+  std::vector<NodeId> ids{};
+  walk_ast(
+      context, root, [](const AstNode&) { return WalkAction::visit_children(); },
+      [&](const AstNode& node) { ids.push_back(node.id); });
+  return ids;
+}
+
+void test_walk_enters_and_leaves_in_order() {
+  AstContext context{};
+  const NodeId root = parse("let x = a + f(b);\n{ return -x; }", context);
+  expect(trace(context, root, AstKind::Unknown) ==
+             "<Module<let<x><+<a><CallExpr<f><b>>>><BlockStmt<ReturnStmt<-<x>>>>>",
+         "walk should enter parents before and leave them after their children");
+  expect(trace(context, root, AstKind::CallExpr) == "<Module<let<x><+<a><CallExpr>>><BlockStmt<ReturnStmt<-<x>>>>>",
+         "skipped children should not be visited, but their parent is still left");
+
+  std::string names{};
+  const NodeId let = context.node(root).children[0];
+  walk_ast(
+      context, let,
+      [&](const AstNode& node) {
+        names += std::string(node.value.empty() ? to_string(node.kind) : node.value) + " ";
+        return node.kind == AstKind::LetStmt ? WalkAction::visit_children_from(1) : WalkAction::visit_children();
+      },
+      [](const AstNode&) {});
+  expect(names == "let + a CallExpr f b ", "children before the first one asked for should be skipped");
+}
+
+void test_post_order_scan_matches_walk() {
+  AstContext context{};
+  const NodeId root = parse("let x = (a + b) * -c;\n{ { f(x, y)(z); } x += 1; }\nreturn g(h(1), 2);", context);
+  expect(context.is_post_ordered(), "the parser should create nodes in post-order");
+  expect(post_order(context, root) == walked_post_order(context, root),
+         "a post-ordered context should scan in walk order");
+  const NodeId block = context.node(root).children[1];
+  expect(post_order(context, block) == walked_post_order(context, block), "subtrees should scan in walk order");
+  expect(post_order(context, block).front() == context.first_descendant(block), "a subtree starts at its first leaf");
+
+  // Reparsing gives the module a new child list, so the context is walked from then on.
+  const std::string before = "let a = 1;\nlet b = 2;\n";
+  const std::string after = "let a = 1;\nlet c = 3;\nlet b = 2;\n";
+  AstContext edited{};
+  DiagnosticReporter reporter{};
+  const auto old_tokens = lex(before);
+  const NodeId module = parse_module(old_tokens, edited, reporter);
+  const istudio::front::SourceEdit edit{.range = istudio::support::make_span(11, 11), .text = "let c = 3;\n"};
+  const auto tokens = istudio::front::relex(old_tokens, after, edit);
+  DiagnosticReporter next{};
+  istudio::front::reparse_module(tokens, edited, module, edit, reporter.diagnostics(), next);
+  expect(!edited.is_post_ordered(), "reparsing should clear the post-order guarantee");
+  const auto ids = post_order(edited, module);
+  expect(ids == walked_post_order(edited, module) && ids.size() == 10, "a reparsed context should still be walked");
+}
+
+void test_hand_built_trees_are_checked() {
+  AstContext ordered{};
+  const NodeId a = ordered.create_node(AstKind::IdentifierExpr, {}, "a").id;
+  const NodeId b = ordered.create_node(AstKind::IdentifierExpr, {}, "b").id;
+  const NodeId sum = ordered.create_node(AstKind::BinaryExpr, {}, "+").id;
+  ordered.set_children(sum, {a, b});
+  expect(ordered.is_post_ordered(), "children created right before their parent keep post-order");
+
+  AstContext orphan{};
+  const NodeId x = orphan.create_node(AstKind::IdentifierExpr, {}, "x").id;
+  static_cast<void>(orphan.create_node(AstKind::LiteralExpr, {}, "1"));
+  const NodeId y = orphan.create_node(AstKind::IdentifierExpr, {}, "y").id;
+  const NodeId product = orphan.create_node(AstKind::BinaryExpr, {}, "*").id;
+  orphan.set_children(product, {x, y});
+  expect(!orphan.is_post_ordered(), "a node between siblings breaks post-order");
+  expect(post_order(orphan, product) == std::vector<NodeId>({x, y, product}), "only the subtree should be visited");
+
+  AstContext parent_first{};
+  const NodeId call = parent_first.create_node(AstKind::CallExpr, {}).id;
+  const NodeId callee = parent_first.create_node(AstKind::IdentifierExpr, {}, "f").id;
+  parent_first.set_children(call, {callee});
+  expect(!parent_first.is_post_ordered(), "a parent created before its children breaks post-order");
+}
+
+void test_callbacks_may_create_nodes() {
+  AstContext context{};
+  const NodeId root = parse("let x = a + f(b);\n{ return -x; }", context);
+  const std::string expected = trace(context, root, AstKind::Unknown);
+
+  // Enough new nodes per step to move the node storage many times over.
+  std::string out{};
+  walk_ast(
+      context, root,
+      [&](const AstNode& node) {
+        out += "<" + std::string(node.value.empty() ? to_string(node.kind) : node.value);
+        for (int i = 0; i < 1000; ++i) {
+          static_cast<void>(context.create_node(AstKind::LiteralExpr, {}, "1"));
+        }
+        return WalkAction::visit_children();
+      },
+      [&](const AstNode&) {
+        out += ">";
+        static_cast<void>(context.create_node(AstKind::LiteralExpr, {}, "1"));
+      });
+  expect(out == expected, "nodes created by callbacks should not disturb the walk");
+}
+
+void test_deeply_nested_expressions_parse_without_recursion() {
+  constexpr std::size_t kDepth = 50000;
+  const auto check = [](const std::string& expression, const std::string& what) {
+    AstContext context{};
+    const NodeId root = parse("let v = " + expression + ";", context);
+    std::size_t depth = 0;
+    std::size_t deepest = 0;
+    walk_ast(
+        context, root,
+        [&](const AstNode&) {
+          deepest = std::max(deepest, ++depth);
+          return WalkAction::visit_children();
+        },
+        [&](const AstNode&) { --depth; });
+    expect(deepest > kDepth, what + " should nest " + std::to_string(kDepth) + " deep");
+    expect(post_order(context, root).size() == context.size(), what + " should scan every node");
+  };
+
+  std::string chain = "a";
+  std::string assignments{};
+  std::string groups{};
+  std::string negations{};
+  std::string calls = "f";
+  for (std::size_t i = 0; i < kDepth; ++i) {
+    chain += " + a";
+    assignments += "a = ";
+    groups += "(";
+    negations += "-";
+    calls += "(a)";
+  }
+  check(chain, "a chain of '+'");
+  check(assignments + "1", "a chain of assignments");
+  check(groups + "1" + std::string(kDepth, ')'), "nested parentheses");
+  check(negations + "1", "nested prefix operators");
+  check(calls, "chained calls");
+
+  std::string arguments{};
+  for (std::size_t i = 0; i < kDepth; ++i) {
+    arguments += "g(";
+  }
+  arguments += "1";
+  for (std::size_t i = 0; i < kDepth; ++i) {
+    arguments += ", 2)";
+  }
+  check(arguments, "nested argument lists");
+}
+
+void test_deeply_nested_blocks_parse_without_recursion() {
+  constexpr std::size_t kDepth = 50000;
+  AstContext context{};
+  const NodeId root =
+      parse(std::string(kDepth, '{') + "let v = 1; { }" + std::string(kDepth, '}') + "\nreturn v;", context);
+  expect(context.node(root).children.size() == 2, "the blocks should form one statement before the return");
+  std::size_t blocks = 0;
+  NodeId block = context.node(root).children[0];
+  while (context.node(block).kind == AstKind::BlockStmt && !context.node(block).children.empty()) {
+    ++blocks;
+    block = context.node(block).children.back();
+  }
+  expect(blocks == kDepth && context.node(block).kind == AstKind::BlockStmt,
+         "each block should hold the next, then an empty one");
+  expect(post_order(context, root).size() == context.size(), "nested blocks should scan every node");
+
+  // Every unclosed block is reported, innermost first.
+  AstContext unclosed{};
+  DiagnosticReporter reporter{};
+  parse_module(lex(std::string(kDepth, '{') + "let v = 1;"), unclosed, reporter);
+  expect(reporter.diagnostics().size() == kDepth, "each unclosed block should be reported once");
+}
+
+}  // namespace
+
+void run_ast_walk_tests() {
+  test_walk_enters_and_leaves_in_order();
+  test_post_order_scan_matches_walk();
+  test_hand_built_trees_are_checked();
+  test_callbacks_may_create_nodes();
+  test_deeply_nested_expressions_parse_without_recursion();
+  test_deeply_nested_blocks_parse_without_recursion();
+  std::cout << "All AST walk tests passed\n";
+}
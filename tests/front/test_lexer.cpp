@@ -1,16 +1,31 @@
 #include <algorithm>
+#include <cstdint>
 #include <cstdlib>
 #include <exception>
 #include <iostream>
+#include <list>
 #include <string>
+#include <utility>
 #include <stdexcept>
 #include <vector>
 
 #include "front/lexer.h"
+#include "front/lexer_tables.h"
+#include "support/string_interner.h"
+#include "support/thread_pool.h"
 
+using istudio::front::classify_keyword;
+using istudio::front::Keyword;
 using istudio::front::lex;
+using istudio::front::lex_parallel;
+using istudio::front::Lexer;
 using istudio::front::LexerConfig;
+using istudio::front::match_operator;
+using istudio::front::Punct;
+using istudio::front::relex;
+using istudio::front::SourceEdit;
 using istudio::front::TokenKind;
+using istudio::front::TokenStream;
 using istudio::front::TriviaKind;
 
 namespace {
@@ -29,16 +44,16 @@ void test_tokenizes_keywords_identifiers_and_symbols() {
   config.capture_comments = true;
 
   const auto stream = lex(source, config);
-  expect(!stream.tokens.empty(), "Token stream should not be empty");
+  expect(!stream.empty(), "Token stream should not be empty");
 
   std::vector<TokenKind> kinds{};
   std::vector<std::string> lexemes{};
-  kinds.reserve(stream.tokens.size());
-  lexemes.reserve(stream.tokens.size());
+  kinds.reserve(stream.size());
+  lexemes.reserve(stream.size());
 
-  for (const auto& token : stream.tokens) {
+  for (const auto& token : stream) {
     kinds.push_back(token.kind);
-    lexemes.push_back(token.lexeme);
+    lexemes.emplace_back(token.lexeme);
   }
 
   expect(kinds.front() == TokenKind::Keyword, "First token must be keyword");
@@ -59,28 +74,300 @@ void test_captures_trivia_when_enabled() {
   config.capture_comments = true;
 
   const auto stream = lex(source, config);
-  expect(stream.tokens.size() >= 2, "Token stream should contain at least two tokens");
+  expect(stream.size() >= 2, "Token stream should contain at least two tokens");
 
-  const auto& first = stream.tokens[0];
+  const auto first = stream[0];
+  const auto first_trivia = stream.leading_trivia(0);
   expect(first.kind == TokenKind::Keyword, "First token should be keyword 'let'");
   expect(first.lexeme == "let", "Lexeme should be 'let'");
-  expect(first.leading_trivia.size() == 1, "Leading trivia should contain whitespace");
-  expect(first.leading_trivia[0].kind == TriviaKind::Whitespace, "Trivia should be whitespace");
-  expect(first.leading_trivia[0].text == "  ", "Whitespace trivia should capture indentation");
+  expect(first_trivia.size() == 1, "Leading trivia should contain whitespace");
+  expect(first_trivia[0].kind == TriviaKind::Whitespace, "Trivia should be whitespace");
+  expect(first_trivia[0].text == "  ", "Whitespace trivia should capture indentation");
 
-  const auto& eof = stream.tokens.back();
+  const auto eof = stream.back();
+  const auto eof_trivia = stream.leading_trivia(stream.size() - 1);
   expect(eof.kind == TokenKind::EndOfFile, "Last token should be EOF");
   const bool has_comment = std::any_of(
-      eof.leading_trivia.begin(),
-      eof.leading_trivia.end(),
+      eof_trivia.begin(),
+      eof_trivia.end(),
       [](const auto& trivia) { return trivia.kind == TriviaKind::Comment; });
   expect(has_comment, "EOF leading trivia should include trailing comment");
 }
 
+void test_keyword_classification() {
+  const std::vector<std::pair<std::string, Keyword>> keywords{
+      {"module", Keyword::Module}, {"fn", Keyword::Fn},         {"pub", Keyword::Pub},
+      {"let", Keyword::Let},       {"mut", Keyword::Mut},       {"struct", Keyword::Struct},
+      {"enum", Keyword::Enum},     {"ct", Keyword::Ct},         {"return", Keyword::Return},
+  };
+  for (const auto& [word, keyword] : keywords) {
+    expect(classify_keyword(word) == keyword, "keyword '" + word + "' should classify");
+    expect(istudio::front::to_string(keyword) == word, "keyword '" + word + "' should round-trip");
+  }
+
+  for (const std::string word : {"", "f", "fnn", "lets", "Let", "modules", "retur", "await", "true", "ctx", "mod"}) {
+    expect(classify_keyword(word) == Keyword::None, "'" + word + "' should not be a keyword");
+  }
+}
+
+// Reference maximal munch: grow one byte at a time while the longer spelling is still an operator.
+std::size_t reference_operator_length(const std::string& text) {
+  const std::vector<std::string> compound{"==", "!=", "<=", ">=", "&&", "||", "::", "->", "=>", "+=",
+                                          "-=", "*=", "/=", "%=", "&=", "|=", "^=", "<<", ">>", ">>="};
+  std::size_t length = 1;
+  while (length < text.size() &&
+         std::find(compound.begin(), compound.end(), text.substr(0, length + 1)) != compound.end()) {
+    ++length;
+  }
+  return length;
+}
+
+void test_operator_dfa_matches_maximal_munch() {
+  const std::string alphabet = "=!<>&|:-+*/%^(){}[],;.?@#$~a ";
+  std::string text(3, ' ');
+  for (char a : alphabet) {
+    for (char b : alphabet) {
+      for (char c : alphabet) {
+        text[0] = a;
+        text[1] = b;
+        text[2] = c;
+        if (a == 'a' || a == ' ') {
+          continue;
+        }
+        const auto match = match_operator(text, 0);
+        expect(match.length == reference_operator_length(text), "operator length mismatch for '" + text + "'");
+        expect(match.punct != Punct::None, "operator match must produce a punctuator for '" + text + "'");
+        if (match.punct != Punct::Other) {
+          expect(istudio::front::spelling(match.punct) == text.substr(0, match.length),
+                 "operator spelling mismatch for '" + text + "'");
+        }
+      }
+    }
+  }
+
+  expect(match_operator(">>=", 0).punct == Punct::ShiftRightAssign, "'>>=' should be a single operator");
+  expect(match_operator("<<=", 0).punct == Punct::ShiftLeft, "'<<=' should stop after '<<'");
+  expect(match_operator(">", 0).punct == Punct::Greater, "operator at end of input should match");
+  expect(match_operator("\\x", 0).punct == Punct::Other, "unknown bytes should match as Other");
+
+  const auto stream = lex("a >>= b<<=c");
+  std::vector<std::string> lexemes{};
+  for (const auto& token : stream) {
+    lexemes.emplace_back(token.lexeme);
+  }
+  const std::vector<std::string> expected{"a", ">>=", "b", "<<", "=", "c", ""};
+  expect(lexemes == expected, "compound symbols should lex with maximal munch");
+}
+
+void test_token_stream_side_table_trivia() {
+  const std::string source = "let a = 1; // one\nlet b = 2;";
+
+  LexerConfig bare{};
+  bare.capture_comments = false;
+  const auto plain = lex(source, bare);
+  expect(!plain.has_trivia(), "trivia side table should stay empty when nothing is captured");
+  expect(plain.leading_trivia(5).empty(), "tokens without captured trivia should report none");
+
+  const auto stream = lex(source);
+  expect(stream.has_trivia(), "captured comments should populate the side table");
+  expect(stream.size() == plain.size(), "trivia capture should not change the token sequence");
+  const auto second_let = stream[5];
+  expect(second_let.lexeme == "let" && second_let.span.start == 18, "second 'let' should follow the comment");
+  const auto trivia = stream.leading_trivia(5);
+  expect(trivia.size() == 1 && trivia[0].text == "// one", "comment should lead the second 'let'");
+  expect(stream.leading_trivia(4).empty(), "';' should have no leading trivia");
+  expect(stream.source() == source, "stream should reference the lexed source");
+}
+
+void test_tokens_carry_operator_and_keyword_codes() {
+  const auto stream = lex("let mut x += y >>= 2;");
+  const std::vector<std::pair<Punct, Keyword>> expected{
+      {Punct::None, Keyword::Let},
+      {Punct::None, Keyword::Mut},
+      {Punct::None, Keyword::None},
+      {Punct::PlusAssign, Keyword::None},
+      {Punct::None, Keyword::None},
+      {Punct::ShiftRightAssign, Keyword::None},
+      {Punct::None, Keyword::None},
+      {Punct::Semicolon, Keyword::None},
+      {Punct::None, Keyword::None},
+  };
+  expect(stream.size() == expected.size(), "code test should see every token");
+  for (std::size_t i = 0; i < expected.size(); ++i) {
+    expect(stream.punct(i) == expected[i].first && stream[i].punct == expected[i].first,
+           "token " + std::to_string(i) + " should carry its operator code");
+    expect(stream.keyword(i) == expected[i].second && stream[i].keyword == expected[i].second,
+           "token " + std::to_string(i) + " should carry its keyword code");
+  }
+}
+
+void test_pull_lexer_matches_materialized_stream() {
+  const std::string source = "fn f(a) { // c\n  return a << 2; }\n";
+  const auto stream = lex(source);
+
+  Lexer lexer{source, LexerConfig{}};
+  for (std::size_t i = 0; i < stream.size(); ++i) {
+    const auto token = lexer.next();
+    expect(token.kind == stream[i].kind && token.span.start == stream[i].span.start &&
+               token.lexeme == stream[i].lexeme && token.punct == stream[i].punct,
+           "next() should yield the same tokens as lex()");
+    expect(lexer.leading_trivia().size() == stream.leading_trivia(i).size(),
+           "next() should expose the same leading trivia as lex()");
+  }
+  expect(lexer.next().kind == TokenKind::EndOfFile, "next() should keep returning EndOfFile");
+}
+
+void test_token_estimate_tracks_the_input() {
+  const std::string source = "let a = 1; // one\nreturn a;\n";
+  Lexer short_input{source, LexerConfig{}};
+  expect(short_input.estimate_remaining_tokens() == lex(source).size(), "short input should be counted exactly");
+  static_cast<void>(short_input.next());
+  expect(short_input.estimate_remaining_tokens() == lex(source).size() - 1, "only the remaining input is counted");
+
+  // Comment-heavy and indentation-heavy input has far fewer tokens per byte than plain code.
+  for (const std::string line : {"let value = first + second * 3;\n",
+                                 "// a comment that is much longer than the statement it precedes\nx = 1;\n",
+                                 "                                x;\n"}) {
+    std::string text{};
+    while (text.size() < 512 * 1024) {
+      text += line;
+    }
+    const std::size_t tokens = lex(text).size();
+    const std::size_t estimate = Lexer{text, LexerConfig{}}.estimate_remaining_tokens();
+    expect(estimate >= tokens && estimate <= tokens + tokens / 4, "the estimate should stay close to the count");
+  }
+}
+
+bool same_tokens(const TokenStream& lhs, const TokenStream& rhs) {
+  if (lhs.size() != rhs.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    const auto a = lhs[i];
+    const auto b = rhs[i];
+    if (a.kind != b.kind || a.span.start != b.span.start || a.span.end != b.span.end || a.lexeme != b.lexeme ||
+        a.punct != b.punct || a.keyword != b.keyword || a.symbol != b.symbol) {
+      return false;
+    }
+    const auto trivia_a = lhs.leading_trivia(i);
+    const auto trivia_b = rhs.leading_trivia(i);
+    if (!std::equal(trivia_a.begin(), trivia_a.end(), trivia_b.begin(), trivia_b.end(), [](const auto& x, const auto& y) {
+          return x.kind == y.kind && x.text == y.text && x.span.start == y.span.start;
+        })) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void test_relex_matches_full_lex() {
+  const std::string base = "let total = a1 + 22.5; // sum\n  return \"s\\\"q\" << total;\n{ x <<= 3 }\n";
+  const std::vector<std::string> insertions = {"", "b", "=", " ", "\n", "//", "\"", "9", "<", ".5", "let "};
+
+  LexerConfig full_trivia{};
+  full_trivia.capture_whitespace = true;
+  std::uint32_t seed = 12345;
+  const auto next_random = [&seed](std::size_t bound) {
+    seed = seed * 1664525u + 1013904223u;
+    return static_cast<std::size_t>(seed >> 8) % bound;
+  };
+
+  for (const LexerConfig& config : {LexerConfig{}, full_trivia}) {
+    // Streams view their source, so every version is kept alive; each relex builds on the previous relex.
+    std::list<std::string> versions{base};
+    TokenStream stream = lex(versions.back(), config);
+    for (int step = 0; step < 400; ++step) {
+      const std::string& source = versions.back();
+      const std::size_t start = next_random(source.size() + 1);
+      const std::size_t end = std::min(source.size(), start + next_random(4));
+      const std::string& text = insertions[next_random(insertions.size())];
+
+      const std::string& edited = versions.emplace_back(source.substr(0, start) + text + source.substr(end));
+      stream = relex(stream, edited, SourceEdit{.range = istudio::support::make_span(start, end), .text = text}, config);
+      expect(same_tokens(stream, lex(edited, config)),
+             "relex should match a full lex after edit " + std::to_string(step) + " of \"" + edited + "\"");
+    }
+  }
+
+  bool threw = false;
+  try {
+    static_cast<void>(relex(lex(base), base, SourceEdit{.range = {0, 3}, .text = "x"}));
+  } catch (const std::invalid_argument&) {
+    threw = true;
+  }
+  expect(threw, "relex should reject an edit inconsistent with the new source");
+}
+
+void test_parallel_lex_matches_sequential() {
+  // Multi-line strings (some containing "//" and blank lines), comments holding quotes and long whitespace
+  // runs, so that chunk boundaries land inside every kind of construct.
+  std::string source{};
+  for (int i = 0; i < 200; ++i) {
+    source += "let v" + std::to_string(i) + " = w + " + std::to_string(i) + ";\n";
+    if (i % 7 == 0) {
+      source += "let s = \"line one\n// not a comment\n\n  \\\" still string\n\";\n";
+    }
+    if (i % 5 == 0) {
+      source += "   // comment with \" quote\n\n\n        \n";
+    }
+  }
+  source += "let tail = \"unterminated\n  across lines";
+
+  LexerConfig full_trivia{};
+  full_trivia.capture_whitespace = true;
+  istudio::support::ThreadPool pool{3};
+  for (const LexerConfig& config : {LexerConfig{}, full_trivia}) {
+    const TokenStream expected = lex(source, config);
+    for (std::size_t chunk_bytes : {1u, 2u, 3u, 5u, 16u, 40u, 97u, 400u, 5000u, 1u << 20}) {
+      expect(same_tokens(lex_parallel(source, pool, config, chunk_bytes), expected),
+             "parallel lex should match sequential lex with " + std::to_string(chunk_bytes) + "-byte chunks");
+    }
+    expect(same_tokens(lex_parallel(source, pool, config), expected), "default chunking should match too");
+  }
+  expect(same_tokens(lex_parallel("", pool, {}, 1), lex("")), "empty source should lex to EndOfFile alone");
+}
+
+void test_identifiers_are_interned() {
+  istudio::support::StringInterner interner{};
+  LexerConfig config{};
+  config.interner = &interner;
+  std::string source{};
+  for (int i = 0; i < 300; ++i) {
+    source += "let alpha" + std::to_string(i % 10) + " = beta + alpha" + std::to_string(i % 10) + ";\n";
+  }
+  const TokenStream stream = lex(source, config);
+  for (std::size_t i = 0; i < stream.size(); ++i) {
+    const auto token = stream[i];
+    if (token.kind == TokenKind::Identifier) {
+      expect(token.symbol == interner.find(token.lexeme), "identifiers should carry their interned symbol");
+    } else {
+      expect(token.symbol == istudio::support::kNoSymbol, "only identifiers should be interned");
+    }
+  }
+  expect(stream[1].symbol == stream[5].symbol, "equal identifiers should share a symbol");
+  expect(interner.size() == 11, "each distinct identifier should be interned once");
+
+  istudio::support::ThreadPool pool{2};
+  expect(same_tokens(lex_parallel(source, pool, config, 64), stream), "parallel lex should intern identically");
+  const std::string edited = "let gamma" + source.substr(10);
+  const SourceEdit edit{.range = istudio::support::make_span(4, 10), .text = "gamma"};
+  expect(same_tokens(relex(stream, edited, edit, config), lex(edited, config)),
+         "relex should keep and assign symbols like a full lex");
+}
+
 }  // namespace
 
 void run_lexer_tests() {
   test_tokenizes_keywords_identifiers_and_symbols();
   test_captures_trivia_when_enabled();
+  test_keyword_classification();
+  test_operator_dfa_matches_maximal_munch();
+  test_token_stream_side_table_trivia();
+  test_tokens_carry_operator_and_keyword_codes();
+  test_pull_lexer_matches_materialized_stream();
+  test_token_estimate_tracks_the_input();
+  test_relex_matches_full_lex();
+  test_parallel_lex_matches_sequential();
+  test_identifiers_are_interned();
   std::cout << "All lexer tests passed\n";
 }
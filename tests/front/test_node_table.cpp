@@ -0,0 +1,114 @@
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "front/node_table.h"
+
+using istudio::front::kShardShift;
+using istudio::front::NodeId;
+using istudio::front::NodeTable;
+
+namespace {
+
+[[noreturn]] void fail(const std::string& message) {
+  throw std::runtime_error(message);
+}
+
+void expect(bool condition, const std::string& message) {
+  if (!condition) {
+    fail(message);
+  }
+}
+
+void test_set_find_and_contains() {
+  NodeTable<std::string> table{};
+  table.reserve(0, 10);
+  expect(!table.contains(3) && table.find(3) == nullptr, "reserved nodes should have no fact");
+  table.set(3, "three");
+  table.set(200, "grown");
+  expect(table.contains(3) && *table.find(3) == "three", "a set fact should be found");
+  expect(table.contains(200) && *table.find(200) == "grown", "tables should grow past their reservation");
+  expect(!table.contains(64) && !table.contains(199) && !table.contains(100000), "unset nodes should be absent");
+  table.set(3, "again");
+  expect(*table.find(3) == "again", "setting a fact again should replace it");
+}
+
+void test_shards_are_separate() {
+  NodeTable<int> table{};
+  const NodeId first = 5;
+  const NodeId other = (NodeId{4} << kShardShift) + 5;
+  table.set(other, 2);
+  expect(!table.contains(first) && table.contains(other), "the same index in another shard should be distinct");
+  table.set(first, 1);
+  expect(*table.find(first) == 1 && *table.find(other) == 2, "each shard should keep its own facts");
+  expect(!table.contains((NodeId{2} << kShardShift) + 5), "shards in between should be empty");
+}
+
+void test_clear_forgets_every_fact() {
+  NodeTable<int> table{};
+  for (NodeId id = 0; id < 1000; ++id) {
+    table.set(id, static_cast<int>(id));
+  }
+  table.clear();
+  for (NodeId id = 0; id < 1000; ++id) {
+    expect(!table.contains(id), "cleared tables should be empty");
+  }
+  table.set(999, 7);
+  expect(*table.find(999) == 7 && !table.contains(998), "a cleared table should take new facts");
+}
+
+void test_for_each_visits_facts_in_id_order() {
+  NodeTable<int> table{};
+  const NodeId far = (NodeId{1} << kShardShift) + 130;
+  table.set(far, 3);
+  table.set(64, 2);
+  table.set(0, 1);
+  table.set(70, 0);
+  table.clear();
+  table.set(far, 3);
+  table.set(64, 2);
+  table.set(0, 1);
+  std::vector<std::pair<NodeId, int>> visited{};
+  table.for_each([&](NodeId id, int value) { visited.emplace_back(id, value); });
+  expect(visited == std::vector<std::pair<NodeId, int>>{{0, 1}, {64, 2}, {far, 3}},
+         "for_each should visit every present fact once, in id order");
+}
+
+void test_shared_sets_from_threads() {
+  constexpr NodeId kNodes = 4096;
+  constexpr NodeId kThreads = 4;
+  NodeTable<int> table{};
+  table.reserve(0, kNodes);
+  // Interleaved ids, so every bitmap word is set from every thread.
+  std::vector<std::thread> threads{};
+  for (NodeId thread = 0; thread < kThreads; ++thread) {
+    threads.emplace_back([&table, thread] {
+      for (NodeId id = thread; id < kNodes; id += kThreads) {
+        table.set_shared(id, static_cast<int>(id));
+        static_cast<void>(table.find_shared(id ^ 1));
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  for (NodeId id = 0; id < kNodes; ++id) {
+    expect(table.contains(id) && *table.find(id) == static_cast<int>(id), "every shared set should stick");
+  }
+  expect(table.find_shared(kNodes) == nullptr && table.find_shared(NodeId{1} << kShardShift) == nullptr,
+         "find_shared should miss ids beyond the table");
+}
+
+}  // namespace
+
+void run_node_table_tests() {
+  test_set_find_and_contains();
+  test_shards_are_separate();
+  test_clear_forgets_every_fact();
+  test_for_each_visits_facts_in_id_order();
+  test_shared_sets_from_threads();
+  std::cout << "All node table tests passed\n";
+}
@@ -1,20 +1,42 @@
+#include <algorithm>
 #include <cstdlib>
 #include <exception>
 #include <iostream>
+#include <list>
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
+#include "front/ast_dump.h"
 #include "front/lexer.h"
 #include "front/parser.h"
+#include "support/source_manager.h"
+#include "support/thread_pool.h"
 
 using istudio::front::AstContext;
+using istudio::front::AstDumpOptions;
+using istudio::front::AstForest;
 using istudio::front::AstKind;
+using istudio::front::dump_ast_text;
+using istudio::front::Lexer;
 using istudio::front::LexerConfig;
 using istudio::front::NodeId;
 using istudio::front::TokenKind;
 using istudio::front::lex;
 using istudio::front::parse_expression;
+using istudio::front::parse_files;
 using istudio::front::parse_module;
+using istudio::front::relex;
+using istudio::front::reparse_module;
+using istudio::front::SourceEdit;
+using istudio::front::structurally_equal;
+using istudio::front::TokenStream;
+using istudio::support::DiagCode;
+using istudio::support::DiagnosticReporter;
+using istudio::support::FileId;
+using istudio::support::SourceManager;
+using istudio::support::ThreadPool;
 
 namespace {
 
@@ -28,6 +50,16 @@ void expect(bool condition, const std::string& message) {
   }
 }
 
+template <typename Body>
+void expect_throws(Body&& body, const std::string& message) {
+  try {
+    body();
+  } catch (const std::logic_error&) {
+    return;
+  }
+  fail(message);
+}
+
 NodeId parse_expr(const std::string& source, AstContext& context) {
   LexerConfig config{};
   const auto tokens = lex(source, config);
@@ -112,6 +144,87 @@ void test_unary_expression() {
   expect(operand.kind == AstKind::IdentifierExpr, "operand should be identifier");
 }
 
+void test_ast_context_child_lists() {
+  AstContext context{};
+  const istudio::support::Span span{};
+  const NodeId outer = context.create_node(AstKind::BlockStmt, span).id;
+  const auto outer_list = context.begin_children();
+  context.add_child(context.create_node(AstKind::LiteralExpr, span, "1").id);
+  const NodeId inner = context.create_node(AstKind::BlockStmt, span).id;
+  const auto inner_list = context.begin_children();
+  for (int i = 0; i < 20000; ++i) {
+    context.add_child(context.create_node(AstKind::LiteralExpr, span, "2").id);
+  }
+  context.finish_children(inner, inner_list);
+  context.add_child(inner);
+  context.finish_children(outer, outer_list);
+
+  expect(context.node(inner).children.size() == 20000, "nested list should keep its own children");
+  expect(context.node(outer).children.size() == 2, "outer list should resume after the nested one");
+  expect(context.node(outer).children[1] == inner, "outer list should end with the nested block");
+
+  // Spans view chunked storage, so they survive later growth.
+  const auto kept = context.node(outer).children;
+  for (int i = 0; i < 20000; ++i) {
+    const NodeId leaf = context.create_node(AstKind::LiteralExpr, span, "3").id;
+    context.set_children(leaf, {inner, outer});
+  }
+  expect(kept.data() == context.node(outer).children.data() && kept[1] == inner,
+         "child ranges should not move as the context grows");
+
+  context.set_children(outer, {inner});
+  expect(context.node(outer).children.size() == 1, "set_children should replace existing children");
+
+  bool threw = false;
+  const auto first = context.begin_children();
+  context.add_child(inner);
+  const auto second = context.begin_children();
+  context.finish_children(outer, first);
+  try {
+    context.finish_children(outer, second);
+  } catch (const std::logic_error&) {
+    threw = true;
+  }
+  expect(threw, "finishing child lists out of order should be rejected");
+}
+
+void test_prefix_operators_bind_tighter_than_binary() {
+  AstContext context{};
+  const auto& sum = context.node(parse_expr("-a + b", context));
+  expect(sum.kind == AstKind::BinaryExpr && sum.value == "+", "-a + b should be a sum");
+  expect(context.node(sum.children[0]).kind == AstKind::UnaryExpr, "the sum's left operand should be -a");
+
+  const auto& product = context.node(parse_expr("-a * b", context));
+  expect(product.kind == AstKind::BinaryExpr && product.value == "*", "-a * b should be a product");
+  expect(context.node(product.children[0]).kind == AstKind::UnaryExpr &&
+             context.node(product.children[1]).kind == AstKind::IdentifierExpr,
+         "the product should multiply -a by b");
+
+  const auto& comparison = context.node(parse_expr("!a == b", context));
+  expect(comparison.kind == AstKind::BinaryExpr && comparison.value == "==", "!a == b should be a comparison");
+  const auto& not_a = context.node(comparison.children[0]);
+  expect(not_a.kind == AstKind::UnaryExpr && not_a.value == "!" &&
+             context.node(not_a.children[0]).kind == AstKind::IdentifierExpr,
+         "'!' should apply to a alone");
+
+  const auto& negated = context.node(parse_expr("!(ready) && done", context));
+  expect(negated.kind == AstKind::BinaryExpr && negated.value == "&&", "!(ready) && done should be a conjunction");
+  const auto& operand = context.node(context.node(negated.children[0]).children[0]);
+  expect(operand.kind == AstKind::GroupExpr, "'!' should take the parenthesized operand only");
+}
+
+void test_compound_assignment_is_right_associative() {
+  AstContext context{};
+  const auto& outer = context.node(parse_expr("a += b = c * 2", context));
+  expect(outer.kind == AstKind::AssignmentExpr && outer.value == "+=", "'+=' should parse as an assignment");
+  const auto& inner = context.node(outer.children[1]);
+  expect(inner.kind == AstKind::AssignmentExpr && inner.value == "=", "assignments should associate to the right");
+  expect(context.node(inner.children[1]).value == "*", "'*' should bind tighter than '='");
+
+  const NodeId module = parse_mod("total -= 1; total %= 7;", context);
+  expect(context.node(module).children.size() == 2, "compound assignments should parse as statements");
+}
+
 void test_let_and_return_statements() {
   AstContext context{};
   const NodeId module = parse_mod("let mut value = 1 + 2;\nreturn value;", context);
@@ -148,6 +261,362 @@ void test_block_statement_structure() {
   expect(nested_stmt.kind == AstKind::ReturnStmt, "nested statement should be return");
 }
 
+void test_streaming_parse_matches_materialized() {
+  const std::string source = "let mut x = (1 + 2) * f(3, 4); { x = -x; } return x;";
+
+  AstContext materialized{};
+  const NodeId expected = parse_mod(source, materialized);
+
+  AstContext streamed{};
+  Lexer lexer{source, LexerConfig{}};
+  const NodeId actual = parse_module(lexer, streamed);
+
+  expect(dump_ast_text(streamed, actual) == dump_ast_text(materialized, expected),
+         "streaming parse should build the same tree as parsing a materialized stream");
+  expect(streamed.node(actual).span.end == source.size(), "module span should end at end of file");
+}
+
+std::vector<DiagCode> codes_of(const DiagnosticReporter& reporter) {
+  std::vector<DiagCode> codes{};
+  for (const auto& diagnostic : reporter.diagnostics()) {
+    codes.push_back(diagnostic.code);
+  }
+  return codes;
+}
+
+void test_reports_every_syntax_error_in_one_pass() {
+  const std::string source =
+      "let a = 1;\n"
+      "let = 2;\n"
+      "let b = (a + ;\n"
+      "b = a * 2\n"
+      "let c = a;\n"
+      "f(a, { x; } b);\n"
+      "return c;\n";
+  AstContext context{};
+  DiagnosticReporter reporter{};
+  const NodeId module = parse_module(lex(source), context, reporter);
+
+  const std::vector<DiagCode> expected_codes{DiagCode::ParseExpectedToken, DiagCode::ParseExpectedExpression,
+                                             DiagCode::ParseExpectedToken, DiagCode::ParseExpectedExpression};
+  expect(codes_of(reporter) == expected_codes, "each broken statement should report exactly one error");
+  expect(reporter.diagnostics()[0].span.start == source.find("= 2"), "missing name should point at '='");
+  expect(reporter.diagnostics()[2].message == "expected ';' after expression",
+         "a missing ';' should be reported as such");
+
+  const std::vector<AstKind> expected_kinds{AstKind::LetStmt, AstKind::Error,   AstKind::Error,     AstKind::Error,
+                                            AstKind::LetStmt, AstKind::Error,   AstKind::ReturnStmt};
+  const auto& statements = context.node(module).children;
+  expect(statements.size() == expected_kinds.size(), "parsing should resume after every broken statement");
+  for (std::size_t i = 0; i < statements.size(); ++i) {
+    expect(context.node(statements[i]).kind == expected_kinds[i],
+           "statement " + std::to_string(i) + " should have kind " + std::string(to_string(expected_kinds[i])));
+  }
+  const auto& broken_let = context.node(statements[2]);
+  expect(broken_let.children.size() == 1 && context.node(broken_let.children[0]).kind == AstKind::LetStmt,
+         "an Error node should keep the partially parsed statement");
+  expect(broken_let.span.end == source.find("\nb = a"), "an Error node should cover the skipped tokens");
+}
+
+void test_recovers_from_unbalanced_braces_and_unknown_characters() {
+  AstContext context{};
+  DiagnosticReporter reporter{};
+  const NodeId module = parse_module(lex("} let a = 1 ` 2; { let b = a;"), context, reporter);
+  const std::vector<DiagCode> expected_codes{DiagCode::ParseUnexpectedToken, DiagCode::ParseExpectedToken,
+                                             DiagCode::ParseExpectedToken};
+  expect(codes_of(reporter) == expected_codes, "stray '}', a stray character and a missing '}' should be reported");
+  expect(context.node(module).children.size() == 2, "both statements should be kept");
+
+  DiagnosticReporter unknown{};
+  parse_module(lex("let a = `;"), context, unknown);
+  expect(codes_of(unknown) == std::vector<DiagCode>{DiagCode::LexUnknownToken},
+         "a character outside the language should be reported as an unknown token");
+
+  bool threw = false;
+  try {
+    parse_mod("let a = ;", context);
+  } catch (const std::runtime_error& ex) {
+    threw = std::string(ex.what()) == "expected expression";
+  }
+  expect(threw, "parsing without a reporter should throw the first error");
+}
+
+void test_streaming_parse_recovers_like_materialized() {
+  const std::string source = "let x = ;\n{ f(1 2); }\nreturn x";
+  AstContext materialized{};
+  DiagnosticReporter materialized_reporter{};
+  const NodeId expected = parse_module(lex(source), materialized, materialized_reporter);
+
+  AstContext streamed{};
+  DiagnosticReporter streamed_reporter{};
+  Lexer lexer{source, LexerConfig{}};
+  const NodeId actual = parse_module(lexer, streamed, streamed_reporter);
+
+  expect(dump_ast_text(streamed, actual) == dump_ast_text(materialized, expected),
+         "streaming recovery should build the same tree as recovery on a materialized stream");
+  expect(codes_of(streamed_reporter) == codes_of(materialized_reporter) && streamed_reporter.diagnostics().size() == 3,
+         "streaming recovery should report the same errors");
+}
+
+std::string describe(const DiagnosticReporter& reporter) {
+  std::string out{};
+  for (const auto& diagnostic : reporter.diagnostics()) {
+    out += std::string(istudio::support::to_string(diagnostic.code)) + "@" + std::to_string(diagnostic.span.start) +
+           "-" + std::to_string(diagnostic.span.end) + ": " + diagnostic.message + "\n";
+  }
+  return out;
+}
+
+void test_reparse_reuses_untouched_statements() {
+  const std::string before = "let a = 1;\n{ let b = a; { b = b + 1; } return b; }\nlet c = 2;\n";
+  const std::string after = "let a = 1;\n{ let b = a; { b = b * 10 + 1; } return b; }\nlet c = 2;\n";
+  const std::size_t at = before.find("+ 1");
+
+  AstContext context{};
+  DiagnosticReporter reporter{};
+  const TokenStream old_tokens = lex(before);
+  const NodeId module = parse_module(old_tokens, context, reporter);
+  const auto& old_statements = context.node(module).children;
+  const NodeId outer = old_statements[1];
+  const NodeId last = old_statements[2];
+  const NodeId inner = context.node(outer).children[1];
+  const NodeId declared = context.node(outer).children[0];
+  const NodeId returned = context.node(outer).children[2];
+  const NodeId edited_statement = context.node(inner).children[0];
+
+  const SourceEdit edit{.range = istudio::support::make_span(at, at), .text = "* 10 "};
+  const TokenStream tokens = relex(old_tokens, after, edit);
+  DiagnosticReporter next{};
+  expect(reparse_module(tokens, context, module, edit, reporter.diagnostics(), next) == module,
+         "reparsing should keep the module node");
+
+  const auto& statements = context.node(module).children;
+  expect(statements.size() == 3 && statements[1] == outer && statements[2] == last,
+         "statements around the edit should keep their ids");
+  expect(context.node(outer).children[0] == declared && context.node(outer).children[1] == inner &&
+             context.node(outer).children[2] == returned,
+         "the edited block's siblings should keep their ids");
+  expect(context.node(inner).children[0] != edited_statement, "only the edited statement should be parsed again");
+  expect(context.node(last).span.start == after.find("let c"), "statements after the edit should be shifted");
+  expect(context.node(returned).span.start == after.find("return"), "reused siblings should be shifted");
+
+  AstContext fresh{};
+  AstDumpOptions options{};
+  options.include_ids = false;
+  expect(dump_ast_text(context, module, options) == dump_ast_text(fresh, parse_mod(after, fresh), options),
+         "an incremental reparse should build the tree a full parse builds");
+}
+
+void test_reparse_matches_full_parse_under_random_edits() {
+  const std::string base =
+      "let total = a + 2;\n{ let x = f(total, 3); { x = x * (2 + y); } return x; }\n"
+      "let b = !(total) && x;\n{ { } b += 1; }\nreturn b;\n";
+  const std::vector<std::string> insertions = {"", "b", ";", "{", "}", " ", "(", ")", "let ", "+ 1", "return",
+                                               "\"", "//"};
+  std::uint32_t seed = 4242;
+  const auto next_random = [&seed](std::size_t bound) {
+    seed = seed * 1664525u + 1013904223u;
+    return static_cast<std::size_t>(seed >> 8) % bound;
+  };
+
+  AstDumpOptions options{};
+  options.include_ids = false;
+  // Token streams view their source, so every version is kept alive.
+  std::list<std::string> versions{base};
+  TokenStream tokens = lex(versions.back());
+  AstContext context{};
+  auto reporter = std::make_unique<DiagnosticReporter>();
+  const NodeId module = parse_module(tokens, context, *reporter);
+  for (int step = 0; step < 600; ++step) {
+    const std::string& source = versions.back();
+    const std::size_t start = next_random(source.size() + 1);
+    const std::size_t end = std::min(source.size(), start + next_random(6));
+    const std::string& text = insertions[next_random(insertions.size())];
+    const std::string& edited = versions.emplace_back(source.substr(0, start) + text + source.substr(end));
+    const SourceEdit edit{.range = istudio::support::make_span(start, end), .text = text};
+
+    tokens = relex(tokens, edited, edit);
+    auto next = std::make_unique<DiagnosticReporter>();
+    reparse_module(tokens, context, module, edit, reporter->diagnostics(), *next);
+    reporter = std::move(next);
+
+    AstContext full{};
+    DiagnosticReporter full_reporter{};
+    const NodeId expected = parse_module(lex(edited), full, full_reporter);
+    const std::string where = " after edit " + std::to_string(step) + " of \"" + edited + "\"";
+    expect(dump_ast_text(context, module, options) == dump_ast_text(full, expected, options),
+           "incremental reparse should match a full parse" + where);
+    expect(describe(*reporter) == describe(full_reporter),
+           "incremental reparse should report what a full parse reports" + where);
+  }
+}
+
+void test_sharded_contexts_hand_out_distinct_ids() {
+  auto interner = std::make_shared<istudio::support::StringInterner>();
+  AstContext first{interner, 0};
+  AstContext second{interner, 3};
+  const NodeId a = first.create_node(AstKind::IdentifierExpr, {}, "a").id;
+  const NodeId b = second.create_node(AstKind::IdentifierExpr, {}, "b").id;
+  expect(a != b, "nodes of different shards should have different ids");
+  expect(istudio::front::shard_of(a) == 0 && istudio::front::shard_of(b) == 3, "ids should carry their shard");
+  expect(first.node(a).value == "a" && second.node(b).value == "b", "each shard should resolve its own ids");
+
+  bool threw = false;
+  try {
+    static_cast<void>(first.node(b));
+  } catch (const std::out_of_range&) {
+    threw = true;
+  }
+  expect(threw, "a context should reject ids of another shard");
+}
+
+void test_parse_files_matches_sequential_parse() {
+  const std::vector<std::string> texts = {"let a = 1;\n{ let b = a + 2; }\n", "let c = a * (b - 1);\nreturn c;\n",
+                                          "let d = ;\nreturn a;\n", "", "let e = f(a, c);\nlet g = e +;\n"};
+  SourceManager sources{};
+  std::vector<FileId> files{};
+  for (std::size_t i = 0; i < texts.size(); ++i) {
+    files.push_back(sources.add_buffer("file" + std::to_string(i) + ".ist", texts[i]));
+  }
+
+  ThreadPool pool{4};
+  DiagnosticReporter reporter{};
+  const AstForest forest = parse_files(sources, files, pool, reporter);
+  expect(forest.shard_count() == texts.size(), "every file should get its own shard");
+
+  AstDumpOptions options{};
+  options.include_ids = false;
+  DiagnosticReporter sequential{};
+  std::size_t nodes = 0;
+  for (std::uint32_t shard = 0; shard < forest.shard_count(); ++shard) {
+    expect(forest.file(shard) == files[shard], "shards should be in file order");
+    const NodeId root = forest.root(shard);
+    expect(istudio::front::shard_of(root) == shard, "a root should live in its file's shard");
+    expect(forest.node(root).kind == AstKind::Module, "the forest should resolve ids of every shard");
+
+    AstContext context{};
+    DiagnosticReporter file_reporter{files[shard]};
+    const NodeId expected = parse_module(lex(texts[shard]), context, file_reporter);
+    for (const auto& diagnostic : file_reporter.diagnostics()) {
+      sequential.add(diagnostic);
+    }
+    expect(dump_ast_text(forest.shard(shard), root, options) == dump_ast_text(context, expected, options),
+           "a concurrently parsed file should match a sequential parse of file " + std::to_string(shard));
+    nodes += context.size();
+  }
+  expect(forest.size() == nodes, "the forest should count the nodes of all shards");
+
+  expect(describe(reporter) == describe(sequential), "diagnostics should arrive in file order");
+  expect(reporter.diagnostics().size() == 2 && reporter.diagnostics()[0].file == files[2] &&
+             reporter.diagnostics()[1].file == files[4],
+         "diagnostics should be attributed to their file");
+
+  const auto& a_in_first = forest.node(forest.node(forest.node(forest.root(0)).children[0]).children[0]);
+  const auto& a_in_last = forest.node(forest.node(forest.node(forest.root(4)).children[0]).children[1]);
+  expect(a_in_first.value == "a" && a_in_last.kind == AstKind::CallExpr, "unexpected tree shape");
+  expect(a_in_first.symbol == forest.node(a_in_last.children[1]).symbol,
+         "the same name should have the same symbol in every shard");
+}
+
+void test_memory_stats_account_for_storage() {
+  std::string source{};
+  for (int i = 0; i < 2000; ++i) {
+    source += "let a" + std::to_string(i) + " = b + c * 42;\n";
+  }
+  const auto interner = std::make_shared<istudio::support::StringInterner>();
+  LexerConfig config{};
+  config.interner = interner.get();
+  const TokenStream tokens = lex(source, config);
+  AstContext context{interner};
+  const NodeId root = parse_module(tokens, context);
+
+  const auto stats = context.memory_stats();
+  expect(stats.node_count == context.size() && stats.node_bytes == context.size() * sizeof(istudio::front::AstNode),
+         "node bytes should cover every node");
+  expect(stats.node_reserved_bytes == (tokens.size() - tokens.size() / 5 + 1) * sizeof(istudio::front::AstNode),
+         "nodes should fit in the room reserved from the token count");
+  std::size_t children = 0;
+  std::size_t stored_values = 0;
+  for (NodeId id = 0; id <= root; ++id) {
+    const auto& node = context.node(id);
+    children += node.children.size();
+    stored_values += node.symbol == istudio::support::kNoSymbol ? node.value.size() : 0;
+  }
+  expect(stats.child_bytes == children * sizeof(NodeId), "child bytes should cover every child list");
+  expect(stats.value_bytes == stored_values && stored_values < source.size() / 2,
+         "only values the interner does not hold should be counted");
+  expect(stats.node_reserved_bytes >= stats.node_bytes && stats.child_reserved_bytes >= stats.child_bytes &&
+             stats.value_reserved_bytes >= stats.value_bytes,
+         "used bytes should fit in reserved bytes");
+  expect(stats.used_bytes() == stats.node_bytes + stats.child_bytes + stats.value_bytes, "totals should add up");
+
+  AstContext streamed{interner};
+  Lexer lexer{source, config};
+  static_cast<void>(parse_module(lexer, streamed));
+  const auto streamed_stats = streamed.memory_stats();
+  expect(streamed_stats.used_bytes() == stats.used_bytes(), "a streaming parse should use as much memory");
+  expect(streamed_stats.node_reserved_bytes >= streamed_stats.node_bytes &&
+             streamed_stats.node_reserved_bytes < 2 * streamed_stats.node_bytes,
+         "the reservation from source size should be close to what is used");
+}
+
+void test_structural_hashes_identify_equal_subtrees() {
+  const std::string helper = "{ let t = a * (b + 1); return f(t, \"s\"); }\n";
+  const std::string source = helper + "let a = 1;\n" + helper + "{ let t = a * (b + 2); return f(t, \"s\"); }\n";
+  AstContext context{std::make_shared<istudio::support::StringInterner>()};
+  const NodeId root = parse_mod(source, context);
+  context.compute_structural_hashes();
+  const auto& statements = context.node(root).children;
+  expect(context.structural_hash(statements[0]) == context.structural_hash(statements[2]),
+         "identical blocks should hash equally");
+  expect(context.structural_hash(statements[0]) != context.structural_hash(statements[3]),
+         "blocks differing in one literal should hash differently");
+  expect(structurally_equal(context, statements[0], context, statements[2]) &&
+             !structurally_equal(context, statements[0], context, statements[3]),
+         "structural equality should confirm hash matches");
+
+  // Hashes ignore ids, spans, shards and interners, and are pinned so caches keyed on them stay valid.
+  AstContext elsewhere{std::make_shared<istudio::support::StringInterner>(), 7};
+  const NodeId other = parse_mod("\n\n" + helper, elsewhere);
+  elsewhere.compute_structural_hashes();
+  const NodeId block = elsewhere.node(other).children[0];
+  expect(elsewhere.structural_hash(block) == context.structural_hash(statements[0]),
+         "equal subtrees should hash equally in any context");
+  expect(structurally_equal(elsewhere, block, context, statements[2]), "equality should hold across contexts");
+  AstContext literal{};
+  const NodeId one = parse_expr("1", literal);
+  literal.compute_structural_hashes();
+  expect(literal.structural_hash(one) == 0x2D0EE6FCA1EA4199, "hashes should not change between builds");
+
+  // Subtrees with distinct shapes should not collide.
+  std::vector<std::uint64_t> hashes{};
+  for (NodeId id = 0; id <= root; ++id) {
+    hashes.push_back(context.structural_hash(id));
+  }
+  std::sort(hashes.begin(), hashes.end());
+  const auto distinct = static_cast<std::size_t>(std::unique(hashes.begin(), hashes.end()) - hashes.begin());
+  std::size_t duplicates = 0;
+  for (NodeId id = 0; id <= root; ++id) {
+    for (NodeId other_id = 0; other_id < id; ++other_id) {
+      if (structurally_equal(context, id, context, other_id)) {
+        ++duplicates;
+        break;
+      }
+    }
+  }
+  expect(distinct == context.size() - duplicates, "only equal subtrees should share a hash");
+
+  // Replacing a child list puts the hashes out of date; new nodes have none until the next sweep.
+  const NodeId extra = context.create_node(AstKind::LiteralExpr, {}, "3").id;
+  expect_throws([&] { static_cast<void>(context.structural_hash(extra)); }, "new nodes should have no hash");
+  context.set_children(statements[3], std::vector<NodeId>(context.node(statements[0]).children.begin(),
+                                                          context.node(statements[0]).children.end()));
+  expect_throws([&] { static_cast<void>(context.structural_hash(root)); }, "stale hashes should be dropped");
+  context.compute_structural_hashes();
+  expect(!context.is_post_ordered() && context.structural_hash(statements[3]) == context.structural_hash(statements[0]),
+         "rehashing should cover contexts that are not post-ordered");
+}
+
 }  // namespace
 
 void run_parser_tests() {
@@ -155,7 +624,20 @@ void run_parser_tests() {
   test_grouping_and_multiplication();
   test_call_expression();
   test_unary_expression();
+  test_ast_context_child_lists();
+  test_prefix_operators_bind_tighter_than_binary();
+  test_compound_assignment_is_right_associative();
   test_let_and_return_statements();
   test_block_statement_structure();
+  test_streaming_parse_matches_materialized();
+  test_reports_every_syntax_error_in_one_pass();
+  test_recovers_from_unbalanced_braces_and_unknown_characters();
+  test_streaming_parse_recovers_like_materialized();
+  test_reparse_reuses_untouched_statements();
+  test_reparse_matches_full_parse_under_random_edits();
+  test_sharded_contexts_hand_out_distinct_ids();
+  test_parse_files_matches_sequential_parse();
+  test_memory_stats_account_for_storage();
+  test_structural_hashes_identify_equal_subtrees();
   std::cout << "All parser tests passed\n";
 }
@@ -0,0 +1,104 @@
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "front/scan.h"
+
+using istudio::front::ScanIsa;
+using istudio::front::ScanKernels;
+using istudio::front::scan_kernels;
+using istudio::front::scan_kernels_for;
+
+namespace {
+
+[[noreturn]] void fail(const std::string& message) {
+  throw std::runtime_error(message);
+}
+
+void expect(bool condition, const std::string& message) {
+  if (!condition) {
+    fail(message);
+  }
+}
+
+// Mixes every byte class the kernels distinguish, including bytes >= 0x80 and the characters just outside
+// the ASCII letter and whitespace ranges, with runs long enough to cross several vector widths.
+std::string make_scan_corpus() {
+  std::string text{};
+  const std::string pieces[] = {
+      "                                        ", "\t\t\v\f\r\n", "very_long_generated_identifier_0123456789_ABCxyz",
+      "@[`{/:", "// comment text that runs for a while before the newline\n", "\x80\xC3\xA9\xFF\x08\x0E\x1F",
+      "_", "z", "Z", "9", " ",
+  };
+  std::uint32_t state = 12345;
+  for (int i = 0; i < 400; ++i) {
+    state = state * 1103515245u + 12345u;
+    text += pieces[(state >> 16) % std::size(pieces)];
+  }
+  return text;
+}
+
+void check_kernels_match_scalar(const ScanKernels& kernels, const std::string& text) {
+  const ScanKernels* scalar = scan_kernels_for(ScanIsa::Scalar);
+  expect(scalar != nullptr, "scalar kernels must always be available");
+  const std::string isa{to_string(kernels.isa)};
+  for (std::size_t pos = 0; pos <= text.size(); ++pos) {
+    expect(kernels.skip_whitespace(text.data(), text.size(), pos) ==
+               scalar->skip_whitespace(text.data(), text.size(), pos),
+           isa + " skip_whitespace diverged at " + std::to_string(pos));
+    expect(kernels.skip_identifier(text.data(), text.size(), pos) ==
+               scalar->skip_identifier(text.data(), text.size(), pos),
+           isa + " skip_identifier diverged at " + std::to_string(pos));
+    expect(kernels.find_newline(text.data(), text.size(), pos) ==
+               scalar->find_newline(text.data(), text.size(), pos),
+           isa + " find_newline diverged at " + std::to_string(pos));
+  }
+
+  // Line-start collection over every prefix length, so each tail size is exercised.
+  for (std::size_t size = 0; size <= text.size(); size += 7) {
+    const std::size_t count = kernels.count_newlines(text.data(), size);
+    expect(count == scalar->count_newlines(text.data(), size),
+           isa + " count_newlines diverged at " + std::to_string(size));
+    std::vector<std::uint32_t> starts(count);
+    std::vector<std::uint32_t> expected(count);
+    kernels.collect_line_starts(text.data(), size, starts.data());
+    scalar->collect_line_starts(text.data(), size, expected.data());
+    expect(starts == expected, isa + " collect_line_starts diverged at " + std::to_string(size));
+  }
+}
+
+void test_scalar_kernels_classify_ascii() {
+  const ScanKernels* scalar = scan_kernels_for(ScanIsa::Scalar);
+  const std::string text = " \t\v\f\r\nfoo_Bar9 +\xC3\xA9";
+  expect(scalar->skip_whitespace(text.data(), text.size(), 0) == 6, "whitespace run should cover C-locale spaces");
+  expect(scalar->skip_identifier(text.data(), text.size(), 6) == 14, "identifier run should stop at ' '");
+  expect(scalar->skip_identifier(text.data(), text.size(), 16) == 16, "non-ASCII bytes are not identifiers");
+  expect(scalar->find_newline(text.data(), text.size(), 0) == 5, "newline should be found");
+  expect(scalar->find_newline(text.data(), text.size(), 6) == text.size(), "missing newline should return size");
+  expect(scalar->count_newlines(text.data(), text.size()) == 1, "one newline should be counted");
+  std::uint32_t line_start = 0;
+  scalar->collect_line_starts(text.data(), text.size(), &line_start);
+  expect(line_start == 6, "line start should follow the newline");
+}
+
+void test_vector_kernels_match_scalar() {
+  const std::string text = make_scan_corpus();
+  for (ScanIsa isa : {ScanIsa::Scalar, ScanIsa::Sse2, ScanIsa::Avx2}) {
+    if (const ScanKernels* kernels = scan_kernels_for(isa)) {
+      check_kernels_match_scalar(*kernels, text);
+    }
+  }
+  check_kernels_match_scalar(scan_kernels(), text);
+}
+
+}  // namespace
+
+void run_scan_tests() {
+  test_scalar_kernels_classify_ascii();
+  test_vector_kernels_match_scalar();
+  std::cout << "All scan tests passed (" << to_string(scan_kernels().isa) << ")\n";
+}
@@ -1,13 +1,16 @@
 #include <algorithm>
+#include <cstddef>
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "front/ast.h"
 #include "ir/lowering.h"
 #include "sem/analyzer.h"
 #include "support/diagnostics.h"
 #include "support/span.h"
+#include "support/string_interner.h"
 
 using istudio::front::AstContext;
 using istudio::front::AstKind;
@@ -44,35 +47,34 @@ NodeId make_literal(AstContext& ast, Span span, const std::string& value) {
 NodeId make_call(AstContext& ast, Span span, const std::string& callee_name,
                  const std::vector<NodeId>& args) {
   const NodeId callee_id = make_identifier(ast, span, callee_name);
-  auto& call = ast.create_node(AstKind::CallExpr, span);
-  call.children.push_back(callee_id);
-  for (auto arg : args) {
-    call.children.push_back(arg);
-  }
-  return call.id;
+  const NodeId call_id = ast.create_node(AstKind::CallExpr, span).id;
+  std::vector<NodeId> operands{callee_id};
+  operands.insert(operands.end(), args.begin(), args.end());
+  ast.set_children(call_id, operands);
+  return call_id;
 }
 
 NodeId make_return_literal_function(AstContext& ast, Span span, const std::string& name,
                                     const std::vector<std::string>& params,
                                     const std::string& literal_value) {
   const NodeId name_id = make_identifier(ast, span, name);
-  auto& param_list = ast.create_node(AstKind::ArgumentList, span);
+  const NodeId param_list_id = ast.create_node(AstKind::ArgumentList, span).id;
+  std::vector<NodeId> param_ids{};
   for (const auto& param : params) {
-    param_list.children.push_back(make_identifier(ast, span, param));
+    param_ids.push_back(make_identifier(ast, span, param));
   }
+  ast.set_children(param_list_id, param_ids);
 
   const NodeId literal_id = make_literal(ast, span, literal_value);
-  auto& return_stmt = ast.create_node(AstKind::ReturnStmt, span);
-  return_stmt.children.push_back(literal_id);
+  const NodeId return_id = ast.create_node(AstKind::ReturnStmt, span).id;
+  ast.set_children(return_id, {literal_id});
 
-  auto& body = ast.create_node(AstKind::BlockStmt, span);
-  body.children.push_back(return_stmt.id);
+  const NodeId body_id = ast.create_node(AstKind::BlockStmt, span).id;
+  ast.set_children(body_id, {return_id});
 
-  auto& function = ast.create_node(AstKind::Function, span);
-  function.children.push_back(name_id);
-  function.children.push_back(param_list.id);
-  function.children.push_back(body.id);
-  return function.id;
+  const NodeId function_id = ast.create_node(AstKind::Function, span).id;
+  ast.set_children(function_id, {name_id, param_list_id, body_id});
+  return function_id;
 }
 
 struct ModuleFixture {
@@ -91,28 +93,28 @@ void build_module(ModuleFixture& fixture, bool include_mismatch_call) {
 
   const NodeId function_id =
       make_return_literal_function(fixture.ast, span, "add", {"x", "y"}, "1");
-  fixture.ast.node(fixture.module_id).children.push_back(function_id);
+  std::vector<NodeId> statements{function_id};
 
   const NodeId call_expr_id =
       make_call(fixture.ast, span, "add",
                 {make_literal(fixture.ast, span, "1"), make_literal(fixture.ast, span, "2")});
   fixture.primary_call_id = call_expr_id;
 
-  auto& let_stmt = fixture.ast.create_node(AstKind::LetStmt, span, "let");
   const NodeId result_id = make_identifier(fixture.ast, span, "result");
-  let_stmt.children.push_back(result_id);
-  let_stmt.children.push_back(call_expr_id);
-  fixture.ast.node(fixture.module_id).children.push_back(let_stmt.id);
+  const NodeId let_id = fixture.ast.create_node(AstKind::LetStmt, span, "let").id;
+  fixture.ast.set_children(let_id, {result_id, call_expr_id});
+  statements.push_back(let_id);
 
   if (include_mismatch_call) {
     const NodeId bad_call_id = make_call(
         fixture.ast, span, "add",
         {make_literal(fixture.ast, span, "\"oops\""), make_literal(fixture.ast, span, "3")});
     fixture.mismatch_call_id = bad_call_id;
-    auto& expr_stmt = fixture.ast.create_node(AstKind::ExpressionStmt, span);
-    expr_stmt.children.push_back(bad_call_id);
-    fixture.ast.node(fixture.module_id).children.push_back(expr_stmt.id);
+    const NodeId expr_stmt_id = fixture.ast.create_node(AstKind::ExpressionStmt, span).id;
+    fixture.ast.set_children(expr_stmt_id, {bad_call_id});
+    statements.push_back(expr_stmt_id);
   }
+  fixture.ast.set_children(fixture.module_id, statements);
 
   fixture.analyzer = std::make_unique<SemanticAnalyzer>(fixture.ast, fixture.reporter);
   fixture.analyzer->analyze(fixture.module_id);
@@ -142,16 +144,18 @@ void test_lowering_produces_typed_function() {
   IRModule module =
       lower_module(fixture.ast, *fixture.analyzer, fixture.module_id, "example");
 
+  expect(&module.types() == &fixture.analyzer->context().types(), "lowered IR should share the analyzer's types");
+
   const auto& functions = module.functions();
   auto it = std::find_if(functions.begin(), functions.end(),
                          [](const auto& fn) { return fn.name == "add"; });
   expect(it != functions.end(), "lowered module should contain add function");
-  expect(it->return_type.kind == IRTypeKind::I64,
+  expect(module.types().form(it->return_type.id) == IRTypeKind::I64,
          "add should lower to 64-bit integer return type");
   expect(it->parameters.size() == 2, "lowered function should have two parameters");
-  expect(it->parameters[0].type.kind == IRTypeKind::I64,
+  expect(module.types().form(it->parameters[0].type.id) == IRTypeKind::I64,
          "first parameter should lower to 64-bit integer");
-  expect(it->parameters[1].type.kind == IRTypeKind::I64,
+  expect(module.types().form(it->parameters[1].type.id) == IRTypeKind::I64,
          "second parameter should lower to 64-bit integer");
 }
 
@@ -166,9 +170,37 @@ void test_call_type_mismatch_reports_diagnostic() {
   expect(has_type_mismatch, "expected SemTypeMismatch for argument mismatch");
 }
 
+void test_lowering_emits_functions_in_declaration_order() {
+  // Names interned in the reverse of declaration order, as a parallel lexer may happen to.
+  constexpr std::size_t kFunctions = 32;
+  auto names = std::make_shared<istudio::support::StringInterner>();
+  for (std::size_t i = kFunctions; i-- > 0;) {
+    static_cast<void>(names->intern("f" + std::to_string(i)));
+  }
+  AstContext ast{names};
+  const Span span{};
+  std::vector<NodeId> statements{};
+  for (std::size_t i = 0; i < kFunctions; ++i) {
+    statements.push_back(make_return_literal_function(ast, span, "f" + std::to_string(i), {}, "1"));
+  }
+  const NodeId module_id = ast.create_node(AstKind::Module, span).id;
+  ast.set_children(module_id, statements);
+  DiagnosticReporter reporter{};
+  SemanticAnalyzer analyzer{ast, reporter};
+  analyzer.analyze(module_id);
+
+  const IRModule module = lower_module(ast, analyzer, module_id, "ordered");
+  const auto& functions = module.functions();
+  expect(functions.size() == kFunctions, "every function should be lowered");
+  for (std::size_t i = 0; i < kFunctions; ++i) {
+    expect(functions[i].name == "f" + std::to_string(i), "functions should be lowered in declaration order");
+  }
+}
+
 }  // namespace
 
 void run_ir_lowering_tests() {
   test_lowering_produces_typed_function();
   test_call_type_mismatch_reports_diagnostic();
+  test_lowering_emits_functions_in_declaration_order();
 }
@@ -6,6 +6,7 @@
 #include <string>
 
 #include "lsp/message_io.h"
+#include "lsp/position.h"
 #include "lsp/server.h"
 
 namespace {
@@ -75,10 +76,26 @@ void test_server_handles_initialize_shutdown() {
   expect(!reader.read_message(response_stream, payload), "No further responses should be emitted");
 }
 
+void test_position_mapping_counts_utf16_units() {
+  istudio::support::SourceManager sources{};
+  // "é" is two UTF-8 bytes and one UTF-16 unit; U+1F600 is four bytes and a surrogate pair.
+  const auto file = sources.add_buffer("doc.is", "let a = 1;\nlet \xC3\xA9 = \"\xF0\x9F\x98\x80\" + b;\n");
+  const std::size_t b_offset = sources.text(file).find('b');
+
+  const auto position = istudio::lsp::to_position(sources, file, b_offset);
+  expect(position.line == 1 && position.character == 15, "position should count UTF-16 code units");
+  expect(istudio::lsp::to_offset(sources, file, position) == b_offset, "to_offset should invert to_position");
+  expect(istudio::lsp::to_offset(sources, file, {.line = 0, .character = 99}) == 10,
+         "characters past the line end clamp to it");
+  expect(istudio::lsp::to_offset(sources, file, {.line = 9, .character = 0}) == sources.text(file).size(),
+         "lines past the end map to the end of the document");
+}
+
 }  // namespace
 
 void run_lsp_tests() {
   test_reader_extracts_payload();
   test_server_handles_initialize_shutdown();
+  test_position_mapping_counts_utf16_units();
   std::cout << "All LSP tests passed\n";
 }
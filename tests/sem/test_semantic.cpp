@@ -1,19 +1,27 @@
 #include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "front/lexer.h"
 #include "front/parser.h"
 #include "sem/analyzer.h"
 #include "support/diagnostics.h"
+#include "support/source_manager.h"
+#include "support/thread_pool.h"
 #include "support/span.h"
 
 using istudio::front::AstContext;
+using istudio::front::AstForest;
 using istudio::front::AstKind;
 using istudio::front::LexerConfig;
 using istudio::front::NodeId;
 using istudio::front::lex;
+using istudio::front::parse_files;
 using istudio::front::parse_module;
 using istudio::sem::SemanticAnalyzer;
 using istudio::sem::TypeKind;
@@ -21,6 +29,8 @@ using istudio::sem::Type;
 using istudio::sem::TypeTable;
 using istudio::support::DiagCode;
 using istudio::support::DiagnosticReporter;
+using istudio::support::FileId;
+using istudio::support::SourceManager;
 using istudio::support::Span;
 
 namespace {
@@ -98,21 +108,18 @@ void test_function_signature_recording() {
   const NodeId param_list_id = ctx.ast.create_node(AstKind::ArgumentList, span).id;
   const NodeId param_x_id = ctx.ast.create_node(AstKind::IdentifierExpr, span, "x").id;
   const NodeId param_y_id = ctx.ast.create_node(AstKind::IdentifierExpr, span, "y").id;
-  ctx.ast.node(param_list_id).children.push_back(param_x_id);
-  ctx.ast.node(param_list_id).children.push_back(param_y_id);
+  ctx.ast.set_children(param_list_id, {param_x_id, param_y_id});
 
   const NodeId literal_id = ctx.ast.create_node(AstKind::LiteralExpr, span, "1").id;
   const NodeId return_id = ctx.ast.create_node(AstKind::ReturnStmt, span).id;
-  ctx.ast.node(return_id).children.push_back(literal_id);
+  ctx.ast.set_children(return_id, {literal_id});
 
   const NodeId body_id = ctx.ast.create_node(AstKind::BlockStmt, span).id;
-  ctx.ast.node(body_id).children.push_back(return_id);
+  ctx.ast.set_children(body_id, {return_id});
 
   const NodeId function_id = ctx.ast.create_node(AstKind::Function, span).id;
-  auto& function = ctx.ast.node(function_id);
-  function.children.push_back(func_name_id);
-  function.children.push_back(param_list_id);
-  function.children.push_back(body_id);
+  ctx.ast.set_children(function_id, {func_name_id, param_list_id, body_id});
+  const auto& function = ctx.ast.node(function_id);
 
   expect(function.children.size() == 3, "function should reference name, params, and body");
   expect(function.children[0] == func_name_id, "function child[0] should be name identifier");
@@ -133,7 +140,7 @@ void test_function_signature_recording() {
   expect(signature->parameters[1].name == "y", "expected second parameter to be y");
   expect(signature->return_type.kind == TypeKind::Integer, "expected integer return type inference");
 
-  const auto* signature_by_id = ctx.analyzer->context().functions().lookup(function_id);
+  const auto* signature_by_id = ctx.analyzer->context().functions().lookup_by_node(function_id);
   expect(signature_by_id == signature, "lookup by node id should match signature by name");
 
   const NodeId symbol_id = ctx.analyzer->context().symbols().lookup("add");
@@ -148,32 +155,26 @@ void test_call_expression_infers_return_type() {
   const NodeId param_list_id = ctx.ast.create_node(AstKind::ArgumentList, span).id;
   const NodeId param_x_id = ctx.ast.create_node(AstKind::IdentifierExpr, span, "x").id;
   const NodeId param_y_id = ctx.ast.create_node(AstKind::IdentifierExpr, span, "y").id;
-  ctx.ast.node(param_list_id).children.push_back(param_x_id);
-  ctx.ast.node(param_list_id).children.push_back(param_y_id);
+  ctx.ast.set_children(param_list_id, {param_x_id, param_y_id});
 
   const NodeId literal_id = ctx.ast.create_node(AstKind::LiteralExpr, span, "1").id;
   const NodeId return_id = ctx.ast.create_node(AstKind::ReturnStmt, span).id;
-  ctx.ast.node(return_id).children.push_back(literal_id);
+  ctx.ast.set_children(return_id, {literal_id});
 
   const NodeId body_id = ctx.ast.create_node(AstKind::BlockStmt, span).id;
-  ctx.ast.node(body_id).children.push_back(return_id);
+  ctx.ast.set_children(body_id, {return_id});
 
   const NodeId function_id = ctx.ast.create_node(AstKind::Function, span).id;
-  auto& function_node = ctx.ast.node(function_id);
-  function_node.children.push_back(func_name_id);
-  function_node.children.push_back(param_list_id);
-  function_node.children.push_back(body_id);
+  ctx.ast.set_children(function_id, {func_name_id, param_list_id, body_id});
 
   const NodeId call_callee_id = ctx.ast.create_node(AstKind::IdentifierExpr, span, "add").id;
   const NodeId call_expr_id = ctx.ast.create_node(AstKind::CallExpr, span).id;
-  ctx.ast.node(call_expr_id).children.push_back(call_callee_id);
+  ctx.ast.set_children(call_expr_id, {call_callee_id});
   const NodeId call_stmt_id = ctx.ast.create_node(AstKind::ExpressionStmt, span).id;
-  ctx.ast.node(call_stmt_id).children.push_back(call_expr_id);
+  ctx.ast.set_children(call_stmt_id, {call_expr_id});
 
   const NodeId block_id = ctx.ast.create_node(AstKind::BlockStmt, span).id;
-  auto& block = ctx.ast.node(block_id);
-  block.children.push_back(function_id);
-  block.children.push_back(call_stmt_id);
+  ctx.ast.set_children(block_id, {function_id, call_stmt_id});
 
   ctx.root = block_id;
 
@@ -199,20 +200,16 @@ void test_conflicting_return_types_report_error() {
 
   const NodeId int_literal_id = ctx.ast.create_node(AstKind::LiteralExpr, span, "1").id;
   const NodeId first_return_id = ctx.ast.create_node(AstKind::ReturnStmt, span).id;
-  ctx.ast.node(first_return_id).children.push_back(int_literal_id);
+  ctx.ast.set_children(first_return_id, {int_literal_id});
 
   const NodeId str_literal_id = ctx.ast.create_node(AstKind::LiteralExpr, span, "\"two\"").id;
   const NodeId second_return_id = ctx.ast.create_node(AstKind::ReturnStmt, span).id;
-  ctx.ast.node(second_return_id).children.push_back(str_literal_id);
+  ctx.ast.set_children(second_return_id, {str_literal_id});
 
-  auto& body = ctx.ast.node(body_id);
-  body.children.push_back(first_return_id);
-  body.children.push_back(second_return_id);
+  ctx.ast.set_children(body_id, {first_return_id, second_return_id});
 
   const NodeId function_id = ctx.ast.create_node(AstKind::Function, span).id;
-  auto& function = ctx.ast.node(function_id);
-  function.children.push_back(func_name_id);
-  function.children.push_back(body_id);
+  ctx.ast.set_children(function_id, {func_name_id, body_id});
 
   ctx.root = function_id;
   ctx.analyzer = std::make_unique<SemanticAnalyzer>(ctx.ast, ctx.reporter);
@@ -230,6 +227,359 @@ void test_conflicting_return_types_report_error() {
              std::to_string(static_cast<int>(actual_kind)) + ")");
 }
 
+void test_shared_interner_resolves_lexer_symbols() {
+  const auto interner = std::make_shared<istudio::support::StringInterner>();
+  AstContext ast{interner};
+  LexerConfig config{};
+  config.interner = interner.get();
+  const auto tokens = lex("let x = 1;\nlet y = x + 2;\ny = x;", config);
+  const NodeId root = parse_module(tokens, ast);
+  DiagnosticReporter reporter{};
+  SemanticAnalyzer analyzer{ast, reporter};
+  analyzer.analyze(root);
+  expect(reporter.diagnostics().empty(), "names interned by the lexer should resolve");
+
+  const auto& second_let = ast.node(ast.node(root).children[1]);
+  const auto& name = ast.node(second_let.children.front());
+  expect(name.symbol == interner->find("y"), "identifier nodes should keep the lexer's symbol");
+  expect(name.value.data() == interner->text(name.symbol).data(), "identifier text should view the interner");
+  expect(analyzer.context().symbols().lookup("y") == name.id, "string lookups should go through the interner");
+  expect(analyzer.types().get(name.id).kind == TypeKind::Integer, "y should infer integer type");
+}
+
+void test_forest_analysis_spans_files() {
+  SourceManager sources{};
+  const std::vector<FileId> files = {sources.add_buffer("a.ist", "let x = 1;\n"),
+                                     sources.add_buffer("b.ist", "let y = x + 2;\nreturn z;\n")};
+  istudio::support::ThreadPool pool{2};
+  DiagnosticReporter reporter{};
+  const AstForest forest = parse_files(sources, files, pool, reporter);
+  SemanticAnalyzer analyzer{forest, reporter};
+  analyzer.analyze();
+
+  const auto& diagnostics = reporter.diagnostics();
+  expect(diagnostics.size() == 1 && diagnostics.front().code == DiagCode::SemUnknownIdentifier,
+         "only z should be unknown: x is declared by the other file");
+  expect(diagnostics.front().file == files[1], "the diagnostic should name the file that uses z");
+
+  const auto& let_y = forest.node(forest.node(forest.root(1)).children[0]);
+  expect(analyzer.types().get(let_y.children[0]).kind == TypeKind::Integer,
+         "y should infer its type from x in another shard");
+}
+
+void test_deep_expressions_are_analyzed_without_recursion() {
+  std::string source = "let x = 1;\nlet y = x";
+  for (int i = 0; i < 50000; ++i) {
+    source += " + x";
+  }
+  source += " + 1.5;\n";
+  const auto ctx = analyze_source(source);
+  const auto& diagnostics = ctx.reporter.diagnostics();
+  expect(diagnostics.size() == 1 && diagnostics.front().code == DiagCode::SemTypeMismatch,
+         "only the float at the end of the chain should mismatch");
+  const NodeId let_y = ctx.ast.node(ctx.root).children[1];
+  expect(ctx.analyzer->types().get(ctx.ast.node(let_y).children[1]).kind == TypeKind::Unknown,
+         "the mismatched chain should have no type");
+
+  DiagnosticReporter reporter{};
+  SemanticAnalyzer inferred{ctx.ast, reporter};
+  inferred.infer(ctx.root);
+  expect(reporter.diagnostics().size() == 1 && reporter.diagnostics().front().code == DiagCode::SemTypeMismatch,
+         "inference should report the same single mismatch");
+  expect(inferred.types().get(ctx.ast.node(let_y).children[1]).kind == TypeKind::Unknown,
+         "inference should leave the mismatched chain untyped too");
+}
+
+// Hand-built function syntax, which the parser does not produce yet.
+struct ModuleBuilder {
+  AstContext ast{};
+  std::vector<NodeId> statements{};
+
+  NodeId node(AstKind kind, const std::string& value = {}, std::vector<NodeId> children = {},
+              Span span = Span{}) {
+    const NodeId id = ast.create_node(kind, span, value).id;
+    if (!children.empty()) {
+      ast.set_children(id, children);
+    }
+    return id;
+  }
+  NodeId call(const std::string& callee, std::vector<NodeId> arguments = {}) {
+    arguments.insert(arguments.begin(), node(AstKind::IdentifierExpr, callee));
+    return node(AstKind::CallExpr, {}, std::move(arguments));
+  }
+  NodeId returns(NodeId value) { return node(AstKind::ReturnStmt, {}, {value}); }
+  NodeId function(const std::string& name, const std::vector<std::string>& parameters, std::vector<NodeId> body) {
+    std::vector<NodeId> children = {node(AstKind::IdentifierExpr, name)};
+    std::vector<NodeId> parameter_ids{};
+    for (const std::string& parameter : parameters) {
+      parameter_ids.push_back(node(AstKind::IdentifierExpr, parameter));
+    }
+    children.push_back(node(AstKind::ArgumentList, {}, std::move(parameter_ids)));
+    children.push_back(node(AstKind::BlockStmt, {}, std::move(body)));
+    statements.push_back(node(AstKind::Function, {}, std::move(children)));
+    return statements.back();
+  }
+  NodeId finish() { return node(AstKind::Module, {}, statements); }
+};
+
+std::vector<std::pair<NodeId, Type>> recorded_types(const TypeTable& types) {
+  std::vector<std::pair<NodeId, Type>> recorded{};
+  types.for_each([&](NodeId id, Type type) { recorded.emplace_back(id, type); });
+  return recorded;
+}
+
+void test_parallel_analysis_orders_bodies_by_call_graph() {
+  constexpr std::size_t kChain = 200;
+  ModuleBuilder module{};
+  // Uses the end of the chain before any of it is declared.
+  const NodeId first_call = module.call("chain" + std::to_string(kChain - 1));
+  module.statements.push_back(
+      module.node(AstKind::LetStmt, {}, {module.node(AstKind::IdentifierExpr, "first"), first_call}));
+  // Each link calls the one declared after it.
+  for (std::size_t i = kChain; i-- > 1;) {
+    module.function("chain" + std::to_string(i), {}, {module.returns(module.call("chain" + std::to_string(i - 1)))});
+  }
+  module.function("chain0", {}, {module.returns(module.call("leaf"))});
+  module.function("leaf", {}, {module.returns(module.node(AstKind::LiteralExpr, "1"))});
+  // Mutually recursive, so analyzed together: odd types its parameter from even's call.
+  module.function("even", {"n"}, {module.returns(module.call("odd", {module.node(AstKind::LiteralExpr, "2")}))});
+  const NodeId recurse = module.call("even", {module.node(AstKind::IdentifierExpr, "m")});
+  const NodeId odd = module.function("odd", {"m"}, {module.node(AstKind::ExpressionStmt, {}, {recurse}),
+                                                    module.returns(module.node(AstKind::LiteralExpr, "1"))});
+  // One mismatch per body, at increasing offsets.
+  for (std::size_t i = 0; i < 8; ++i) {
+    const NodeId sum = module.node(AstKind::BinaryExpr, "+",
+                                   {module.node(AstKind::LiteralExpr, "1"), module.node(AstKind::LiteralExpr, "\"s\"")},
+                                   istudio::support::make_span(i, i + 1));
+    module.function("mismatch" + std::to_string(i), {}, {module.returns(sum)});
+  }
+  const NodeId root = module.finish();
+
+  DiagnosticReporter serial_reporter{};
+  SemanticAnalyzer serial{module.ast, serial_reporter};
+  serial.analyze(root);
+  expect(std::any_of(serial_reporter.diagnostics().begin(), serial_reporter.diagnostics().end(),
+                     [](const auto& diagnostic) { return diagnostic.code == DiagCode::SemUnknownIdentifier; }),
+         "the serial analysis should not see functions declared later");
+
+  std::vector<std::pair<NodeId, Type>> reference{};
+  std::vector<istudio::support::Diagnostic> reference_diagnostics{};
+  for (const std::size_t threads : {std::size_t{1}, std::size_t{2}, std::size_t{4}}) {
+    istudio::support::ThreadPool pool{threads};
+    DiagnosticReporter reporter{};
+    SemanticAnalyzer analyzer{module.ast, reporter};
+    analyzer.analyze_parallel(root, pool);
+
+    const auto& diagnostics = reporter.diagnostics();
+    expect(diagnostics.size() == 8, "only the mismatches should be reported");
+    for (std::size_t i = 0; i < diagnostics.size(); ++i) {
+      expect(diagnostics[i].code == DiagCode::SemTypeMismatch && diagnostics[i].span.start == i,
+             "body diagnostics should come in declaration order");
+    }
+    expect(analyzer.types().get(first_call).kind == TypeKind::Integer,
+           "top-level statements should see the return types of every body");
+    const auto* chain = analyzer.context().functions().lookup("chain" + std::to_string(kChain - 1));
+    expect(chain != nullptr && chain->return_type.kind == TypeKind::Integer, "callees should be analyzed first");
+    const auto* odd_signature = analyzer.context().functions().lookup_by_node(odd);
+    expect(odd_signature != nullptr && odd_signature->parameters[0].type.kind == TypeKind::Integer,
+           "a component should refine the parameters of its own functions");
+
+    if (reference.empty()) {
+      reference = recorded_types(analyzer.types());
+      reference_diagnostics = diagnostics;
+      continue;
+    }
+    const auto types = recorded_types(analyzer.types());
+    expect(types.size() == reference.size() &&
+               std::equal(types.begin(), types.end(), reference.begin(),
+                          [](const auto& a, const auto& b) {
+                            return a.first == b.first && a.second.kind == b.second.kind &&
+                                   a.second.reference == b.second.reference;
+                          }),
+           "types should not depend on the number of threads");
+    expect(std::equal(diagnostics.begin(), diagnostics.end(), reference_diagnostics.begin(),
+                      [](const auto& a, const auto& b) {
+                        return a.message == b.message && a.span.start == b.span.start;
+                      }),
+           "diagnostics should not depend on the number of threads");
+  }
+}
+
+void test_parallel_forest_analysis_declares_across_files() {
+  SourceManager sources{};
+  const std::vector<FileId> files = {sources.add_buffer("a.ist", "let y = x + 1;\nreturn w;\n"),
+                                     sources.add_buffer("b.ist", "let x = 1;\n")};
+  istudio::support::ThreadPool pool{2};
+  DiagnosticReporter reporter{};
+  const AstForest forest = parse_files(sources, files, pool, reporter);
+  SemanticAnalyzer analyzer{forest, reporter};
+  analyzer.analyze_parallel(pool);
+
+  const auto& diagnostics = reporter.diagnostics();
+  expect(diagnostics.size() == 1 && diagnostics.front().code == DiagCode::SemUnknownIdentifier &&
+             diagnostics.front().file == files[0],
+         "only w should be unknown: top-level names are declared before any statement is analyzed");
+}
+
+void test_inference_does_not_depend_on_declaration_order() {
+  // The same program with its statements in both orders: uses before and after every declaration.
+  for (const bool reversed : {false, true}) {
+    ModuleBuilder module{};
+    const NodeId early_call = module.call("later");
+    module.statements.push_back(
+        module.node(AstKind::LetStmt, {}, {module.node(AstKind::IdentifierExpr, "early"), early_call}));
+    module.function("later", {}, {module.returns(module.call("identity", {module.node(AstKind::LiteralExpr, "2")}))});
+    const NodeId identity =
+        module.function("identity", {"p"}, {module.returns(module.node(AstKind::IdentifierExpr, "p"))});
+    // A call through a variable, resolved once the variable is known to hold a function.
+    module.statements.push_back(module.node(AstKind::LetStmt, {},
+                                            {module.node(AstKind::IdentifierExpr, "alias"),
+                                             module.node(AstKind::IdentifierExpr, "later")}));
+    const NodeId alias_call = module.call("alias");
+    module.statements.push_back(module.node(AstKind::ExpressionStmt, {}, {alias_call}));
+    module.function("silent", {}, {});
+    if (reversed) {
+      std::reverse(module.statements.begin(), module.statements.end());
+    }
+    const NodeId root = module.finish();
+
+    DiagnosticReporter reporter{};
+    SemanticAnalyzer analyzer{module.ast, reporter};
+    analyzer.infer(root);
+    expect(reporter.diagnostics().empty(), "every name should resolve whatever the order");
+    expect(analyzer.types().get(early_call).kind == TypeKind::Integer,
+           "a call should get its callee's return type wherever the callee is declared");
+    expect(analyzer.types().get(alias_call).kind == TypeKind::Integer, "calls through variables should resolve");
+    const auto* signature = analyzer.context().functions().lookup_by_node(identity);
+    expect(signature != nullptr && signature->parameters[0].type.kind == TypeKind::Integer &&
+               signature->return_type.kind == TypeKind::Integer,
+           "a parameter should be typed by its calls and flow to the return type");
+    expect(analyzer.types().get(signature->parameters[0].node_id).kind == TypeKind::Integer,
+           "parameter nodes should carry their solved type");
+    const auto* silent = analyzer.context().functions().lookup("silent");
+    expect(silent != nullptr && silent->return_type.kind == TypeKind::Void, "functions without returns return void");
+  }
+}
+
+void test_inference_reports_both_sides_of_a_mismatch() {
+  // x is used before it is declared, so the use is blamed rather than the declaration.
+  const std::string source = "let y = x + \"s\";\nlet x = 1;\nlet z = x + 2;\n";
+  AnalysisContext ctx{};
+  ctx.root = parse_module(lex(source, LexerConfig{}), ctx.ast);
+  ctx.analyzer = std::make_unique<SemanticAnalyzer>(ctx.ast, ctx.reporter);
+  ctx.analyzer->infer(ctx.root);
+
+  const auto& diagnostics = ctx.reporter.diagnostics();
+  expect(diagnostics.size() == 1 && diagnostics.front().code == DiagCode::SemTypeMismatch,
+         "only the use of x with a string should mismatch");
+  const auto& module = ctx.ast.node(ctx.root);
+  const NodeId sum = ctx.ast.node(module.children[0]).children[1];
+  const auto& diagnostic = diagnostics.front();
+  expect(diagnostic.span.start == ctx.ast.node(sum).span.start, "the mismatch should be reported at the use");
+  expect(diagnostic.notes.size() == 2 && diagnostic.notes[0].message == "integer inferred here" &&
+             diagnostic.notes[0].span.start == source.find('1') &&
+             diagnostic.notes[1].message == "string inferred here" &&
+             diagnostic.notes[1].span.start == source.find('"'),
+         "the notes should point at where each side's type came from");
+  expect(ctx.analyzer->types().get(sum).kind == TypeKind::Unknown, "the mismatched expression should have no type");
+  const NodeId z = ctx.ast.node(module.children[2]).children[0];
+  expect(ctx.analyzer->types().get(z).kind == TypeKind::Integer, "x should keep the type of its declaration");
+
+  // Conflicting returns leave the signature untyped, as in analyze().
+  ModuleBuilder mix{};
+  mix.function("mix", {}, {mix.returns(mix.node(AstKind::LiteralExpr, "1")),
+                           mix.returns(mix.node(AstKind::LiteralExpr, "\"two\""))});
+  const NodeId root = mix.finish();
+  DiagnosticReporter reporter{};
+  SemanticAnalyzer analyzer{mix.ast, reporter};
+  analyzer.infer(root);
+  const auto* signature = analyzer.context().functions().lookup("mix");
+  expect(reporter.diagnostics().size() == 1 && signature != nullptr &&
+             signature->return_type.kind == TypeKind::Unknown,
+         "conflicting returns should be reported once and leave the return type unknown");
+}
+
+void test_forest_inference_spans_files() {
+  SourceManager sources{};
+  const std::vector<FileId> files = {sources.add_buffer("a.ist", "let y = x + 1.5;\nreturn w;\n"),
+                                     sources.add_buffer("b.ist", "let x = 1;\n")};
+  istudio::support::ThreadPool pool{2};
+  DiagnosticReporter reporter{};
+  const AstForest forest = parse_files(sources, files, pool, reporter);
+  SemanticAnalyzer analyzer{forest, reporter};
+  analyzer.infer();
+
+  const auto& diagnostics = reporter.diagnostics();
+  expect(diagnostics.size() == 2 && diagnostics[0].code == DiagCode::SemUnknownIdentifier &&
+             diagnostics[1].code == DiagCode::SemTypeMismatch,
+         "w should be unknown and x + 1.5 mismatch");
+  expect(diagnostics[1].file == files[0] && diagnostics[1].notes[0].file == files[1] &&
+             diagnostics[1].notes[1].file == files[0],
+         "each note should name the file its type came from");
+}
+
+void test_symbol_table_scopes() {
+  const auto interner = std::make_shared<istudio::support::StringInterner>();
+  istudio::sem::SymbolTable table{interner};
+  const auto x = interner->intern("x");
+  const auto y = interner->intern("y");
+  constexpr NodeId kMissing = std::numeric_limits<NodeId>::max();
+
+  expect(table.insert(x, 1) && !table.insert(x, 2), "a name should be declared once per scope");
+  table.push_scope();
+  expect(table.insert(x, 3) && table.lookup(x) == 3, "inner declarations should shadow outer ones");
+  expect(!table.insert(x, 4) && table.lookup(x) == 3, "a rejected duplicate should leave the binding alone");
+  expect(table.insert(y, 5) && table.depth() == 2, "y should be declared in the inner scope");
+  table.pop_scope();
+  expect(table.lookup(x) == 1 && table.lookup(y) == kMissing, "popping should restore shadowed bindings");
+  expect(table.lookup("x") == 1 && table.lookup("never interned") == kMissing, "strings should resolve too");
+  table.pop_scope();
+  expect(table.depth() == 1 && table.lookup(x) == 1, "the outermost scope should never be popped");
+
+  // Random declarations across nested scopes, checked against a stack of per-scope maps.
+  std::vector<std::vector<std::pair<istudio::support::Symbol, NodeId>>> model{{{x, 1}}};
+  const auto model_lookup = [&](istudio::support::Symbol name) {
+    for (auto scope = model.rbegin(); scope != model.rend(); ++scope) {
+      for (const auto& [declared, id] : *scope) {
+        if (declared == name) {
+          return id;
+        }
+      }
+    }
+    return kMissing;
+  };
+  std::uint32_t seed = 7;
+  const auto next = [&](std::uint32_t bound) {
+    seed = seed * 1664525u + 1013904223u;
+    return (seed >> 8) % bound;
+  };
+  for (NodeId id = 10; id < 20000; ++id) {
+    const auto name = interner->intern("n" + std::to_string(next(300)));
+    switch (next(8)) {
+      case 0:
+        table.push_scope();
+        model.emplace_back();
+        break;
+      case 1:
+        table.pop_scope();
+        if (model.size() > 1) {
+          model.pop_back();
+        }
+        break;
+      default: {
+        const bool fresh = std::none_of(model.back().begin(), model.back().end(),
+                                        [&](const auto& binding) { return binding.first == name; });
+        expect(table.insert(name, id) == fresh, "duplicates should be detected in the innermost scope only");
+        if (fresh) {
+          model.back().emplace_back(name, id);
+        }
+      }
+    }
+    expect(table.depth() == model.size() && table.lookup(name) == model_lookup(name),
+           "lookups should see the innermost binding");
+  }
+}
+
 }  // namespace
 
 void run_semantic_tests() {
@@ -240,4 +590,13 @@ void run_semantic_tests() {
   test_function_signature_recording();
   test_call_expression_infers_return_type();
   test_conflicting_return_types_report_error();
+  test_shared_interner_resolves_lexer_symbols();
+  test_symbol_table_scopes();
+  test_forest_analysis_spans_files();
+  test_deep_expressions_are_analyzed_without_recursion();
+  test_inference_does_not_depend_on_declaration_order();
+  test_inference_reports_both_sides_of_a_mismatch();
+  test_forest_inference_spans_files();
+  test_parallel_analysis_orders_bodies_by_call_graph();
+  test_parallel_forest_analysis_declares_across_files();
 }
@@ -0,0 +1,127 @@
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "sem/type_arena.h"
+
+using istudio::sem::builtin_type;
+using istudio::sem::is_builtin_type;
+using istudio::sem::TypeArena;
+using istudio::sem::TypeForm;
+using istudio::sem::TypeId;
+
+namespace {
+
+[[noreturn]] void fail(const std::string& message) {
+  throw std::runtime_error(message);
+}
+
+void expect(bool condition, const std::string& message) {
+  if (!condition) {
+    fail(message);
+  }
+}
+
+void test_equal_types_share_an_id() {
+  TypeArena types{};
+  const TypeId i64 = builtin_type(TypeForm::I64);
+  expect(types.form(i64) == TypeForm::I64 && is_builtin_type(i64), "builtins should be interned up front");
+  expect(types.to_string(builtin_type(TypeForm::String)) == "string", "builtins should spell their name");
+
+  const TypeId t = types.generic("T");
+  const TypeId pair = types.structure("Pair", {t, t});
+  expect(types.structure("Pair", {types.generic("T"), types.generic("T")}) == pair,
+         "structurally equal types should intern to one id");
+  expect(types.structure("Pair", {t, i64}) != pair, "different arguments should give different types");
+  expect(types.structure("Pair") != pair, "a struct without arguments should differ from its instances");
+  expect(types.generic("Pair") != types.structure("Pair"), "forms should be part of a type's identity");
+  expect(types.to_string(pair) == "Pair<T, T>", "structs should spell their arguments");
+
+  const TypeId callback = types.function(builtin_type(TypeForm::Void), {pair, builtin_type(TypeForm::Bool)});
+  expect(types.function(builtin_type(TypeForm::Void), {pair, builtin_type(TypeForm::Bool)}) == callback,
+         "function types should intern like structs");
+  expect(types.to_string(callback) == "fn(Pair<T, T>, bool) -> void", "functions should spell their signature");
+  expect(types.arguments(callback).size() == 3 && types.arguments(callback).front() == builtin_type(TypeForm::Void),
+         "a function's arguments should be its result, then its parameters");
+
+  // Argument lists may come from the arena itself, whose storage interning can reallocate.
+  const TypeId box = types.structure("Box", {callback, pair});
+  for (int copy = 0; copy < 100; ++copy) {
+    const TypeId wrap = types.structure("Wrap" + std::to_string(copy), types.arguments(box));
+    expect(types.to_string(wrap) == "Wrap" + std::to_string(copy) + "<fn(Pair<T, T>, bool) -> void, Pair<T, T>>",
+           "arguments of the arena's own types should be copied intact");
+  }
+
+  // Enough nesting to rehash the table several times.
+  TypeId list = i64;
+  std::vector<TypeId> lists{};
+  for (int depth = 0; depth < 1000; ++depth) {
+    list = types.structure("List", {list});
+    lists.push_back(list);
+  }
+  list = i64;
+  for (int depth = 0; depth < 1000; ++depth) {
+    list = types.structure("List", {list});
+    expect(list == lists[static_cast<std::size_t>(depth)], "types should keep their id as the arena grows");
+  }
+  expect(!types.has_parameters(list), "a type without parameters should say so");
+
+  bool threw = false;
+  try {
+    static_cast<void>(types.form(static_cast<TypeId>(types.size())));
+  } catch (const std::out_of_range&) {
+    threw = true;
+  }
+  expect(threw, "ids the arena did not issue should be rejected");
+}
+
+void test_substitution_is_structural_and_memoized() {
+  TypeArena types{};
+  const TypeId i64 = builtin_type(TypeForm::I64);
+  const TypeId boolean = builtin_type(TypeForm::Bool);
+  const TypeId t = types.generic("T");
+  const TypeId u = types.generic("U");
+  const TypeId pair = types.structure("Pair", {t, u});
+  expect(types.has_parameters(pair), "a struct over parameters should have parameters");
+
+  const TypeId instance = types.substitute(pair, {{t, i64}, {u, boolean}});
+  expect(instance == types.structure("Pair", {i64, boolean}), "Pair<T, U> with T := i64, U := bool is Pair<i64, bool>");
+  expect(!types.has_parameters(instance), "a fully substituted type should have no parameters");
+  expect(types.substitute(pair, {{u, boolean}, {t, i64}}) == instance, "binding order should not matter");
+  expect(types.substitute(pair, {{t, i64}, {t, boolean}, {u, boolean}}) == instance,
+         "the first binding of a parameter should win");
+
+  const std::size_t size = types.size();
+  expect(types.substitute(pair, {{t, i64}, {u, boolean}}) == instance && types.size() == size,
+         "repeating a substitution should intern nothing");
+
+  const TypeId partial = types.substitute(pair, {{t, i64}});
+  expect(partial == types.structure("Pair", {i64, u}), "unbound parameters should be kept");
+  expect(types.substitute(i64, {{t, boolean}}) == i64, "concrete types should be returned as they are");
+
+  const TypeId mapper = types.function(u, {types.function(u, {t}), types.structure("List", {t})});
+  expect(types.substitute(mapper, {{t, i64}, {u, pair}}) ==
+             types.function(pair, {types.function(pair, {i64}), types.structure("List", {i64})}),
+         "substitution should reach nested types but not rewrite replacements");
+}
+
+void test_arenas_share_an_interner() {
+  const auto names = std::make_shared<istudio::support::StringInterner>();
+  TypeArena types{names};
+  const TypeId pair = types.structure("Pair", {types.generic("T")});
+  expect(names->find("Pair") != istudio::support::kNoSymbol && names->find("T") != istudio::support::kNoSymbol,
+         "type names should be interned in the given interner");
+  expect(types.name(pair) == "Pair" && types.name(builtin_type(TypeForm::I32)).empty(),
+         "names should be readable back");
+}
+
+}  // namespace
+
+void run_type_arena_tests() {
+  test_equal_types_share_an_id();
+  test_substitution_is_structural_and_memoized();
+  test_arenas_share_an_interner();
+  std::cout << "All type arena tests passed\n";
+}
@@ -0,0 +1,121 @@
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sem/type_solver.h"
+
+using istudio::sem::ConstraintReason;
+using istudio::sem::Type;
+using istudio::sem::TypeKind;
+using istudio::sem::TypeSite;
+using istudio::sem::TypeSolver;
+using istudio::sem::TypeVariable;
+using istudio::support::make_span;
+
+namespace {
+
+[[noreturn]] void fail(const std::string& message) {
+  throw std::runtime_error(message);
+}
+
+void expect(bool condition, const std::string& message) {
+  if (!condition) {
+    fail(message);
+  }
+}
+
+TypeSite at(std::size_t offset) {
+  return TypeSite{.span = make_span(offset, offset + 1), .file = 0};
+}
+
+void test_equalities_propagate_in_any_order() {
+  TypeSolver solver{};
+  // A chain whose only known type is at the far end, linked from both directions.
+  constexpr std::size_t kChain = 100000;
+  std::vector<TypeVariable> chain{};
+  for (std::size_t i = 0; i < kChain; ++i) {
+    chain.push_back(solver.fresh());
+  }
+  for (std::size_t i = 0; i + 1 < kChain; i += 2) {
+    solver.equate(chain[i], chain[i + 1], at(i), ConstraintReason::Operands, 0);
+  }
+  for (std::size_t i = kChain - 1; i >= 2; i -= 2) {
+    solver.equate(chain[i - 1], chain[i - 2], at(i), ConstraintReason::Operands, 0);
+  }
+  const TypeVariable integer = solver.known(Type{TypeKind::Integer}, at(0));
+  solver.equate(chain.back(), integer, at(0), ConstraintReason::Operands, 0);
+  const TypeVariable loose = solver.fresh();
+  solver.solve([](std::uint32_t, Type) { fail("nothing was watched"); });
+
+  expect(solver.mismatches().empty(), "a consistent chain should not mismatch");
+  expect(solver.type_of(chain.front()).kind == TypeKind::Integer, "the known type should reach the whole chain");
+  expect(solver.type_of(loose).kind == TypeKind::Unknown, "unconstrained variables should stay unknown");
+}
+
+void test_mismatches_keep_both_sides() {
+  TypeSolver solver{};
+  const TypeVariable x = solver.fresh();
+  const TypeVariable one = solver.known(Type{TypeKind::Integer}, at(1));
+  const TypeVariable text = solver.known(Type{TypeKind::String}, at(2));
+  // A use recorded before the definition it conflicts with.
+  solver.equate(x, text, at(3), ConstraintReason::Operands, 7);
+  solver.equate(x, one, at(4), ConstraintReason::Declaration, 8);
+  solver.equate(x, text, at(5), ConstraintReason::Operands, 9);
+  solver.solve([](std::uint32_t, Type) {});
+
+  const auto& mismatches = solver.mismatches();
+  expect(mismatches.size() == 2, "each unsatisfiable constraint should be one mismatch");
+  expect(mismatches[0].node == 7 && mismatches[1].node == 9, "definitions should be applied before uses");
+  expect(mismatches[0].expected.kind == TypeKind::Integer && mismatches[0].expected_origin.span.start == 1 &&
+             mismatches[0].found.kind == TypeKind::String && mismatches[0].found_origin.span.start == 2 &&
+             mismatches[0].site.span.start == 3,
+         "a mismatch should locate the constraint and where each side's type came from");
+  expect(solver.type_of(x).kind == TypeKind::Integer && solver.type_of(text).kind == TypeKind::String,
+         "mismatched classes should not merge");
+
+  TypeSolver functions{};
+  const TypeVariable f = functions.known(Type{TypeKind::Function, 1}, at(0));
+  const TypeVariable g = functions.known(Type{TypeKind::Function, 2}, at(0));
+  functions.equate(f, g, at(0), ConstraintReason::Assignment, 0);
+  functions.solve([](std::uint32_t, Type) {});
+  expect(functions.mismatches().size() == 1, "functions should only unify with themselves");
+}
+
+void test_watches_fire_once_types_are_known() {
+  TypeSolver solver{};
+  const TypeVariable callee = solver.fresh();
+  const TypeVariable alias = solver.fresh();
+  const TypeVariable parameter = solver.fresh();
+  const TypeVariable argument = solver.known(Type{TypeKind::Bool}, at(0));
+  const TypeVariable known = solver.known(Type{TypeKind::Function, 4}, at(0));
+  solver.watch(alias, 1);
+  solver.watch(known, 2);
+  solver.watch(solver.fresh(), 3);
+  solver.equate(callee, alias, at(0), ConstraintReason::Operands, 0);
+  solver.equate(callee, known, at(0), ConstraintReason::Declaration, 0);
+
+  std::vector<std::pair<std::uint32_t, Type>> fired{};
+  solver.solve([&](std::uint32_t watch, Type type) {
+    fired.emplace_back(watch, type);
+    // What a watch records is solved too.
+    solver.equate(parameter, argument, at(0), ConstraintReason::Argument, 0);
+  });
+
+  expect(fired.size() == 2 && fired[0].first == 2 && fired[1].first == 1,
+         "watches should fire once each, as their variables become known, and never for unknown ones");
+  expect(fired[1].second.kind == TypeKind::Function && fired[1].second.reference == 4,
+         "a watch should see the type its variable was solved to");
+  expect(solver.type_of(parameter).kind == TypeKind::Bool, "constraints recorded while solving should be solved");
+}
+
+}  // namespace
+
+void run_type_solver_tests() {
+  test_equalities_propagate_in_any_order();
+  test_mismatches_keep_both_sides();
+  test_watches_fire_once_types_are_known();
+  std::cout << "All type solver tests passed\n";
+}
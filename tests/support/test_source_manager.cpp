@@ -0,0 +1,143 @@
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "support/diagnostics.h"
+#include "support/source_manager.h"
+
+using istudio::support::DiagCode;
+using istudio::support::DiagnosticReporter;
+using istudio::support::FileId;
+using istudio::support::LineColumn;
+using istudio::support::SourceManager;
+using istudio::support::format_diagnostic;
+using istudio::support::make_span;
+
+namespace {
+
+[[noreturn]] void fail(const std::string& message) {
+  throw std::runtime_error(message);
+}
+
+void expect(bool condition, const std::string& message) {
+  if (!condition) {
+    fail(message);
+  }
+}
+
+bool same_position(LineColumn actual, std::uint32_t line, std::uint32_t column) {
+  return actual.line == line && actual.column == column;
+}
+
+void test_line_table_lookups() {
+  SourceManager sources{};
+  const FileId file = sources.add_buffer("mem.is", "let a = 1;\r\n\nlet bb = a;");
+  expect(sources.name(file) == "mem.is", "buffer should keep its name");
+  expect(sources.line_count(file) == 3, "three lines expected");
+  expect(same_position(sources.line_column(file, 0), 1, 1), "offset 0 is 1:1");
+  expect(same_position(sources.line_column(file, 11), 1, 12), "'\\n' belongs to the line it ends");
+  expect(same_position(sources.line_column(file, 12), 2, 1), "empty line starts after '\\n'");
+  expect(same_position(sources.line_column(file, 17), 3, 5), "offset 17 is 3:5");
+  expect(same_position(sources.line_column(file, 999), 3, 12), "offsets past the end clamp to the end");
+  expect(sources.line_text(file, 1) == "let a = 1;", "line text should drop CRLF");
+  expect(sources.line_text(file, 2).empty(), "empty line text");
+  expect(sources.offset_of(file, LineColumn{.line = 3, .column = 5}) == 17, "offset_of should invert line_column");
+  expect(sources.offset_of(file, LineColumn{.line = 1, .column = 80}) == 10, "columns clamp to the line end");
+
+  bool threw = false;
+  try {
+    static_cast<void>(sources.text(file + 1));
+  } catch (const std::out_of_range&) {
+    threw = true;
+  }
+  expect(threw, "unknown file ids should be rejected");
+}
+
+void test_line_table_matches_naive_scan() {
+  std::string text{};
+  for (int i = 0; i < 300; ++i) {
+    text += std::string(static_cast<std::size_t>(i % 41), 'x');
+    text += '\n';
+  }
+  SourceManager sources{};
+  const FileId file = sources.add_buffer("long.is", text);
+  std::uint32_t line = 1;
+  std::uint32_t column = 1;
+  for (std::size_t offset = 0; offset < text.size(); ++offset) {
+    expect(same_position(sources.line_column(file, offset), line, column),
+           "line table disagrees with a naive scan at " + std::to_string(offset));
+    if (text[offset] == '\n') {
+      ++line;
+      column = 1;
+    } else {
+      ++column;
+    }
+  }
+}
+
+void test_load_file() {
+  const auto path = std::filesystem::temp_directory_path() / "istudio_source_manager_test.is";
+  const auto empty_path = std::filesystem::temp_directory_path() / "istudio_source_manager_empty.is";
+  {
+    std::ofstream out{path, std::ios::binary};
+    out << "let x = 1;\nreturn x;\n";
+    std::ofstream empty{empty_path, std::ios::binary};
+  }
+
+  SourceManager sources{};
+  const FileId file = sources.load_file(path);
+  const FileId empty = sources.load_file(empty_path);
+  std::filesystem::remove(path);
+  std::filesystem::remove(empty_path);
+
+  expect(sources.text(file) == "let x = 1;\nreturn x;\n", "loaded text should match the file");
+  expect(same_position(sources.line_column(file, 18), 2, 8), "loaded file should have a line table");
+  expect(sources.text(empty).empty() && sources.line_count(empty) == 1, "empty files have one empty line");
+
+  bool threw = false;
+  try {
+    static_cast<void>(sources.load_file(path));
+  } catch (const std::runtime_error&) {
+    threw = true;
+  }
+  expect(threw, "missing files should throw");
+}
+
+void test_format_diagnostic() {
+  SourceManager sources{};
+  const FileId file = sources.add_buffer("main.is", "let x = 1;\nlet y = zed;\n");
+  DiagnosticReporter reporter{file};
+  reporter.report(DiagCode::SemUnknownIdentifier, "unknown identifier 'zed'", make_span(19, 22));
+
+  const std::string expected =
+      "main.is:2:9: SemUnknownIdentifier: unknown identifier 'zed'\n"
+      "  let y = zed;\n"
+      "          ^~~\n";
+  expect(format_diagnostic(reporter.diagnostics().front(), sources) == expected,
+         "diagnostic should render with file, position and caret");
+
+  istudio::support::Diagnostic noted = reporter.diagnostics().front();
+  noted.notes = {{.message = "x declared here", .span = make_span(4, 5), .file = file},
+                 {.message = "no location", .span = {}, .file = istudio::support::kInvalidFileId}};
+  expect(format_diagnostic(noted, sources) ==
+             expected + "  note: main.is:1:5: x declared here\n  note: no location\n",
+         "notes should render after the caret, located when they have a file");
+
+  DiagnosticReporter detached{};
+  detached.report(DiagCode::GenericNote, "no file", make_span(0, 1));
+  expect(format_diagnostic(detached.diagnostics().front(), sources) == "GenericNote: no file\n",
+         "diagnostics without a file render without a location");
+}
+
+}  // namespace
+
+void run_source_manager_tests() {
+  test_line_table_lookups();
+  test_line_table_matches_naive_scan();
+  test_load_file();
+  test_format_diagnostic();
+  std::cout << "All source manager tests passed\n";
+}
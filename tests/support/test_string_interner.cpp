@@ -0,0 +1,121 @@
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "support/string_interner.h"
+#include "support/thread_pool.h"
+
+using istudio::support::kNoSymbol;
+using istudio::support::StringInterner;
+using istudio::support::Symbol;
+using istudio::support::ThreadPool;
+
+namespace {
+
+[[noreturn]] void fail(const std::string& message) {
+  throw std::runtime_error(message);
+}
+
+void expect(bool condition, const std::string& message) {
+  if (!condition) {
+    fail(message);
+  }
+}
+
+void test_interning_deduplicates() {
+  StringInterner interner{};
+  const Symbol alpha = interner.intern("alpha");
+  const Symbol beta = interner.intern("beta");
+  expect(alpha != kNoSymbol && beta != kNoSymbol, "non-empty strings should get real symbols");
+  expect(alpha != beta, "distinct strings should get distinct symbols");
+
+  const std::string copy{"alpha"};
+  expect(interner.intern(copy) == alpha, "equal strings should share a symbol");
+  expect(interner.size() == 2, "duplicates should not be stored twice");
+  expect(interner.text(alpha) == "alpha", "text should round-trip");
+  expect(interner.text(alpha).data() != copy.data(), "interned text should not view the caller's buffer");
+}
+
+void test_find_and_empty_string() {
+  StringInterner interner{};
+  expect(interner.intern("") == kNoSymbol, "the empty string should map to kNoSymbol");
+  expect(interner.text(kNoSymbol).empty(), "kNoSymbol should map back to the empty string");
+  expect(interner.find("missing") == kNoSymbol, "find should not intern");
+  expect(interner.size() == 0, "find should leave the interner empty");
+
+  const Symbol gamma = interner.intern("gamma");
+  expect(interner.find("gamma") == gamma, "find should return the existing symbol");
+
+  bool threw = false;
+  try {
+    static_cast<void>(interner.text(gamma + 0x1000));
+  } catch (const std::out_of_range&) {
+    threw = true;
+  }
+  expect(threw, "text should reject symbols the interner did not issue");
+}
+
+void test_texts_stay_valid_as_the_interner_grows() {
+  StringInterner interner{};
+  const Symbol first = interner.intern("first");
+  const std::string_view view = interner.text(first);
+  for (int i = 0; i < 20000; ++i) {
+    static_cast<void>(interner.intern("name_" + std::to_string(i)));
+  }
+  expect(interner.text(first).data() == view.data(), "interned text should never move");
+  expect(view == "first", "interned text should stay intact");
+  expect(interner.size() == 20001, "every distinct string should be counted");
+}
+
+void test_memory_counts_oversized_texts() {
+  StringInterner interner{};
+  static_cast<void>(interner.intern("short"));
+  const std::size_t before = interner.memory_bytes();
+  const std::string huge(1 << 20, 'x');
+  static_cast<void>(interner.intern(huge));
+  expect(interner.memory_bytes() >= before + huge.size(), "a text larger than a chunk should be counted in full");
+}
+
+void test_concurrent_interning_agrees() {
+  StringInterner interner{};
+  constexpr int kTasks = 8;
+  constexpr int kNames = 2000;
+  std::vector<std::future<std::vector<Symbol>>> results{};
+  {
+    ThreadPool pool{4};
+    for (int task = 0; task < kTasks; ++task) {
+      results.push_back(pool.submit([&interner, task] {
+        std::vector<Symbol> symbols(kNames);
+        // Different tasks walk the names in different orders to race on first insertion.
+        for (int i = 0; i < kNames; ++i) {
+          const int step = task % 2 == 0 ? i : kNames - 1 - i;
+          const int name = (step + task * 257) % kNames;
+          symbols[static_cast<std::size_t>(name)] = interner.intern("id" + std::to_string(name));
+        }
+        return symbols;
+      }));
+    }
+  }
+  const std::vector<Symbol> reference = results.front().get();
+  for (std::size_t task = 1; task < results.size(); ++task) {
+    expect(results[task].get() == reference, "concurrent interning should hand out one symbol per string");
+  }
+  expect(interner.size() == kNames, "concurrent interning should not store duplicates");
+  for (int i = 0; i < kNames; ++i) {
+    expect(interner.text(reference[static_cast<std::size_t>(i)]) == "id" + std::to_string(i),
+           "each symbol should map back to its string");
+  }
+}
+
+}  // namespace
+
+void run_string_interner_tests() {
+  test_interning_deduplicates();
+  test_find_and_empty_string();
+  test_texts_stay_valid_as_the_interner_grows();
+  test_memory_counts_oversized_texts();
+  test_concurrent_interning_agrees();
+  std::cout << "All string interner tests passed\n";
+}
@@ -0,0 +1,60 @@
+#include <atomic>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "support/thread_pool.h"
+
+using istudio::support::ThreadPool;
+
+namespace {
+
+[[noreturn]] void fail(const std::string& message) {
+  throw std::runtime_error(message);
+}
+
+void expect(bool condition, const std::string& message) {
+  if (!condition) {
+    fail(message);
+  }
+}
+
+void test_runs_all_tasks() {
+  std::atomic<int> counter{0};
+  std::vector<std::future<int>> results{};
+  {
+    ThreadPool pool{3};
+    expect(pool.size() == 3, "pool should have the requested number of workers");
+    for (int i = 0; i < 100; ++i) {
+      results.push_back(pool.submit([&counter, i] {
+        counter.fetch_add(1);
+        return i * i;
+      }));
+    }
+    expect(results[9].get() == 81, "task result should reach the future");
+  }
+  expect(counter.load() == 100, "destruction should finish queued tasks");
+}
+
+void test_propagates_exceptions() {
+  ThreadPool pool{1};
+  auto failing = pool.submit([]() -> int { throw std::logic_error("boom"); });
+  bool threw = false;
+  try {
+    static_cast<void>(failing.get());
+  } catch (const std::logic_error&) {
+    threw = true;
+  }
+  expect(threw, "task exceptions should be rethrown by get()");
+  expect(pool.submit([] { return 7; }).get() == 7, "pool should keep working after a task throws");
+}
+
+}  // namespace
+
+void run_thread_pool_tests() {
+  test_runs_all_tasks();
+  test_propagates_exceptions();
+  std::cout << "All thread pool tests passed\n";
+}
@@ -4,24 +4,44 @@
 #include <stdexcept>
 
 void run_lexer_tests();
+void run_scan_tests();
 void run_parser_tests();
 void run_ast_dump_tests();
+void run_ast_binary_tests();
+void run_ast_walk_tests();
+void run_node_table_tests();
 void run_semantic_tests();
+void run_type_arena_tests();
+void run_type_solver_tests();
 void run_ir_tests();
 void run_ir_lowering_tests();
 void run_cpp_backend_tests();
 void run_lsp_tests();
+void run_source_manager_tests();
+void run_string_interner_tests();
+void run_thread_pool_tests();
+void run_corpus_tests();
 
 int main() {
   try {
     run_lexer_tests();
+    run_scan_tests();
     run_parser_tests();
     run_ast_dump_tests();
+    run_ast_binary_tests();
+    run_ast_walk_tests();
+    run_node_table_tests();
     run_semantic_tests();
+    run_type_arena_tests();
+    run_type_solver_tests();
     run_ir_tests();
     run_ir_lowering_tests();
     run_cpp_backend_tests();
     run_lsp_tests();
+    run_source_manager_tests();
+    run_string_interner_tests();
+    run_thread_pool_tests();
+    run_corpus_tests();
   } catch (const std::exception& ex) {
     std::cerr << "[tests] " << ex.what() << '\n';
     return EXIT_FAILURE;